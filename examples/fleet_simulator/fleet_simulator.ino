@@ -0,0 +1,212 @@
+// Fleet load generator, runs FLEET_SIZE simulated devices on one ESP32 against a relay
+// (the cloud relay or examples/local_relay). Every device is its own nikolaindustryrealtime with the id sim-<n>,
+// so the load goes through the same lanes, rate limit and RPC code as a real device.
+//
+// Message mix per device:
+//   - a GPIO command to the next device every COMMAND_MS with call(), answered with reply() / GPIO_OK,
+//     the round trip gives the end to end latency
+//   - telemetry to the next device every TELEMETRY_MS
+// Every STORM_MS all devices are dropped at once and the time until all are connected again is measured.
+// A report is printed every REPORT_MS.
+//
+// examples/local_relay accepts WEBSOCKETS_SERVER_CLIENT_MAX devices (default 5), build the relay with
+// -DWEBSOCKETS_SERVER_CLIENT_MAX=<FLEET_SIZE or more> or lower FLEET_SIZE.
+
+#include <WiFi.h>
+#include <algorithm>
+#include "nikolaindustry-realtime.h"
+
+#define FLEET_SIZE 8
+#define RELAY_HOST "192.168.1.10"
+#define RELAY_PORT 81
+#define RELAY_SSL false
+
+#define COMMAND_MS 1000
+#define TELEMETRY_MS 100
+#define STORM_MS 60000
+#define REPORT_MS 5000
+#define LATENCY_SAMPLES 256
+
+struct SimDevice
+{
+  String id;
+  String next;
+  bool connected = false;
+  uint32_t lastCommand = 0;
+  uint32_t lastTelemetry = 0;
+};
+
+nikolaindustryrealtime fleet[FLEET_SIZE];
+SimDevice sims[FLEET_SIZE];
+
+uint32_t sent = 0;
+uint32_t received = 0;
+uint32_t lost = 0;
+uint32_t latency[LATENCY_SAMPLES];
+uint16_t latencyCount = 0;
+
+uint32_t stormStart = 0;
+uint32_t lastStorm = 0;
+uint32_t lastReport = 0;
+uint8_t connectedCount = 0;
+
+void setupDevice(uint8_t n)
+{
+  SimDevice &sim = sims[n];
+  nikolaindustryrealtime &dev = fleet[n];
+  sim.id = "sim-" + String(n);
+  sim.next = "sim-" + String((n + 1) % FLEET_SIZE);
+
+  dev.setEndpoint(RELAY_HOST, RELAY_PORT, RELAY_SSL);
+
+  dev.setOnConnectionStatusChange([n](bool connected) {
+    SimDevice &sim = sims[n];
+    if (connected == sim.connected)
+    {
+      return;
+    }
+    sim.connected = connected;
+    if (!connected)
+    {
+      connectedCount--;
+      return;
+    }
+    connectedCount++;
+    if (stormStart && connectedCount == FLEET_SIZE)
+    {
+      Serial.printf("storm converged in %lu ms\n", (unsigned long)(millis() - stormStart));
+      stormStart = 0;
+    }
+  });
+
+  // commands are answered like gpio_control.ino, telemetry is only counted
+  dev.setOnMessageCallback([n](JsonObject &msg) {
+    received++;
+    JsonObject payload = msg["payload"];
+    if (payload["command"] == "gpio")
+    {
+      fleet[n].reply(msg, [](JsonObject &resp) {
+        resp["response"] = "GPIO_OK";
+      });
+    }
+  });
+
+  dev.begin(sim.id.c_str());
+}
+
+void sendCommand(uint8_t n)
+{
+  uint32_t start = micros();
+  bool queued = fleet[n].call(sims[n].next, [](JsonObject &cmd) {
+    cmd["command"] = "gpio";
+    cmd["pin"] = 2;
+    cmd["state"] = "ON";
+  }, [start](bool ok, JsonObject &response) {
+    if (!ok || response["response"] != "GPIO_OK")
+    {
+      lost++;
+      return;
+    }
+    received++;
+    latency[latencyCount % LATENCY_SAMPLES] = micros() - start;
+    latencyCount++;
+  });
+  if (queued)
+  {
+    sent++;
+  }
+}
+
+void report()
+{
+  uint32_t elapsed = millis() - lastReport;
+  lastReport = millis();
+
+  uint16_t count = latencyCount < LATENCY_SAMPLES ? latencyCount : LATENCY_SAMPLES;
+  uint32_t p50 = 0;
+  uint32_t p99 = 0;
+  if (count)
+  {
+    std::sort(latency, latency + count);
+    p50 = latency[count / 2];
+    p99 = latency[(count * 99) / 100];
+  }
+
+  Serial.printf("connected %u/%u tx %lu/s rx %lu/s lost %lu rtt p50 %lu us p99 %lu us (%u samples) heap %lu\n",
+                connectedCount, FLEET_SIZE,
+                (unsigned long)((sent * 1000) / elapsed), (unsigned long)((received * 1000) / elapsed), (unsigned long)lost,
+                (unsigned long)p50, (unsigned long)p99, count, (unsigned long)ESP.getFreeHeap());
+
+  sent = 0;
+  received = 0;
+  lost = 0;
+  latencyCount = 0;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  WiFi.begin("SENSORFLOW", "12345678");
+  while (WiFi.status() != WL_CONNECTED)
+  {
+    delay(500);
+    Serial.print(".");
+  }
+  Serial.println("\n✅ WiFi connected");
+
+  stormStart = millis();
+  for (uint8_t n = 0; n < FLEET_SIZE; n++)
+  {
+    setupDevice(n);
+  }
+  lastStorm = millis();
+  lastReport = millis();
+}
+
+void loop()
+{
+  uint32_t now = millis();
+
+  for (uint8_t n = 0; n < FLEET_SIZE; n++)
+  {
+    SimDevice &sim = sims[n];
+    fleet[n].loop();
+    if (!sim.connected)
+    {
+      continue;
+    }
+
+    if (now - sim.lastCommand >= COMMAND_MS)
+    {
+      sim.lastCommand = now;
+      sendCommand(n);
+    }
+
+    if (now - sim.lastTelemetry >= TELEMETRY_MS)
+    {
+      sim.lastTelemetry = now;
+      fleet[n].sendTo(sim.next, [now](JsonObject &telemetry) {
+        telemetry["telemetry"] = now;
+        telemetry["rssi"] = WiFi.RSSI();
+      }, NIKOLAINDUSTRY_PRIORITY_BULK);
+      sent++;
+    }
+  }
+
+  if (now - lastStorm >= STORM_MS)
+  {
+    lastStorm = now;
+    stormStart = now;
+    Serial.println("connect storm");
+    for (uint8_t n = 0; n < FLEET_SIZE; n++)
+    {
+      fleet[n].disconnect();
+    }
+  }
+
+  if (now - lastReport >= REPORT_MS)
+  {
+    report();
+  }
+}
@@ -0,0 +1,169 @@
+// Local stand-in for the nikolaindustry-realtime relay.
+// Devices connect with ws://<relay ip>:81/?id=<deviceId> (see nikolaindustryrealtime::setEndpoint),
+// {"targetId": "...", "payload": {...}} is forwarded to that device as {"from": "<sender>", "payload": {...}}.
+// Every device subscribes to a topic named by its id, so the forwarded frame is encoded once
+// even if the same id is connected more than once.
+// Binary frames (chunks of sendFile()) start with [id length][target id], the relay replaces
+// the target id with the sender id.
+// Gateways register their sub-devices with {"register": ["sensor-1", ...]} ({"unregister": [...]} to remove),
+// the relay subscribes the gateway to those ids. Forwarded messages carry "to": <targetId> so a gateway
+// knows which sub-device a message is for, and "as": <sub-device> on a message from a gateway is
+// used as "from" if the gateway registered that id.
+// At most WEBSOCKETS_SERVER_CLIENT_MAX devices (default 5) are connected at a time, more are closed right away.
+// Raise it as a build flag for the library (-DWEBSOCKETS_SERVER_CLIENT_MAX=16), not with a #define here.
+
+#include <WiFi.h>
+#include <WebSocketsServer.h>
+#include <ArduinoJson.h>
+
+// run several relays on different ports (or boards) to try endpoint failover, see addEndpoint()
+#define RELAY_PORT 81
+
+WebSocketsServer relay(RELAY_PORT);
+String deviceIds[WEBSOCKETS_SERVER_CLIENT_MAX];
+
+String idFromUrl(const char *url)
+{
+  const char *id = strstr(url, "id=");
+  if (!id)
+  {
+    return String();
+  }
+  id += 3;
+  const char *end = strchr(id, '&');
+  String result = String(id);
+  if (end)
+  {
+    result = result.substring(0, end - id);
+  }
+  return result;
+}
+
+void forward(uint8_t num, uint8_t *payload, size_t length)
+{
+  DynamicJsonDocument in(2048);
+  if (deserializeJson(in, payload, length))
+  {
+    return;
+  }
+
+  if (in.containsKey("register") || in.containsKey("unregister"))
+  {
+    for (JsonVariant id : in["register"].as<JsonArray>())
+    {
+      relay.subscribe(num, id.as<const char *>());
+    }
+    for (JsonVariant id : in["unregister"].as<JsonArray>())
+    {
+      // a device can not unregister itself
+      if (deviceIds[num] != id.as<const char *>())
+      {
+        relay.unsubscribe(num, id.as<const char *>());
+      }
+    }
+    return;
+  }
+
+  const char *targetId = in["targetId"];
+  if (!targetId || !*targetId)
+  {
+    return;
+  }
+
+  const char *as = in["as"];
+  DynamicJsonDocument out(2048);
+  out["from"] = (as && relay.isSubscribed(num, as)) ? as : deviceIds[num].c_str();
+  out["to"] = targetId;
+  out["payload"] = in["payload"];
+
+  String message;
+  serializeJson(out, message);
+  if (relay.publish(targetId, message) == 0)
+  {
+    Serial.printf("[%u] %s is not connected\n", num, targetId);
+  }
+}
+
+void forwardBinary(uint8_t num, uint8_t *payload, size_t length)
+{
+  if (length < 1 || length < 1 + (size_t)payload[0])
+  {
+    return;
+  }
+
+  char targetId[256];
+  memcpy(targetId, payload + 1, payload[0]);
+  targetId[payload[0]] = 0;
+
+  const String &from = deviceIds[num];
+  size_t rest = length - 1 - payload[0];
+  size_t outLength = 1 + from.length() + rest;
+  uint8_t *out = (uint8_t *)malloc(outLength);
+  if (!out)
+  {
+    return;
+  }
+  out[0] = from.length();
+  memcpy(out + 1, from.c_str(), from.length());
+  memcpy(out + 1 + from.length(), payload + 1 + payload[0], rest);
+
+  if (relay.publishBIN(targetId, out, outLength) == 0)
+  {
+    Serial.printf("[%u] %s is not connected\n", num, targetId);
+  }
+  free(out);
+}
+
+void onEvent(uint8_t num, WStype_t type, uint8_t *payload, size_t length)
+{
+  switch (type)
+  {
+  case WStype_CONNECTED:
+    deviceIds[num] = idFromUrl((const char *)payload);
+    if (deviceIds[num].length() == 0)
+    {
+      relay.disconnect(num);
+      break;
+    }
+    relay.subscribe(num, deviceIds[num].c_str());
+    Serial.printf("[%u] %s connected\n", num, deviceIds[num].c_str());
+    break;
+  case WStype_DISCONNECTED:
+    Serial.printf("[%u] %s disconnected\n", num, deviceIds[num].c_str());
+    deviceIds[num] = "";
+    break;
+  case WStype_TEXT:
+    forward(num, payload, length);
+    break;
+  case WStype_BIN:
+    forwardBinary(num, payload, length);
+    break;
+  default:
+    break;
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  WiFi.begin("SENSORFLOW", "12345678");
+  while (WiFi.status() != WL_CONNECTED)
+  {
+    delay(500);
+    Serial.print(".");
+  }
+  Serial.print("\n✅ relay on ws://");
+  Serial.print(WiFi.localIP());
+  Serial.printf(":%u/?id=<deviceId>\n", RELAY_PORT);
+  Serial.printf("ℹ️ up to %u devices (WEBSOCKETS_SERVER_CLIENT_MAX)\n", (unsigned)WEBSOCKETS_SERVER_CLIENT_MAX);
+
+  relay.begin();
+  relay.onEvent(onEvent);
+  relay.enableHeartbeat(15000, 3000, 2);
+}
+
+void loop()
+{
+  relay.loop();
+}
@@ -0,0 +1,61 @@
+// Firmware update over nikolaindustry-realtime.
+// Another device (or a host tool speaking the same framing, see nikolaindustry-transfer.h)
+// pushes the image with sendFile(), chunks are written to the OTA partition as they arrive.
+// A dropped connection resumes from the last written offset instead of starting over.
+
+#include <WiFi.h>
+#include "nikolaindustry-realtime.h"
+
+nikolaindustryrealtime realtime;
+
+// restarts shortly after the image is complete, so the "done" ack still goes out
+class OtaSink : public nikolaindustryUpdateSink
+{
+public:
+  uint32_t restartAt = 0;
+
+  bool begin(const char *name, uint32_t size) override
+  {
+    Serial.printf("⬇️ Receiving %s (%u bytes)\n", name, size);
+    return nikolaindustryUpdateSink::begin(name, size);
+  }
+
+  bool end(bool ok) override
+  {
+    bool done = nikolaindustryUpdateSink::end(ok);
+    Serial.println(done ? "✅ Update complete, restarting" : "❌ Update failed");
+    if (done)
+    {
+      restartAt = millis() + 1000;
+    }
+    return done;
+  }
+};
+
+OtaSink ota;
+
+void setup()
+{
+  Serial.begin(115200);
+
+  WiFi.begin("SENSORFLOW", "12345678");
+  while (WiFi.status() != WL_CONNECTED)
+  {
+    delay(500);
+    Serial.print(".");
+  }
+  Serial.println("\n✅ WiFi connected");
+
+  realtime.begin("device-123456");
+  realtime.setTransferSink(&ota);
+}
+
+void loop()
+{
+  realtime.loop();
+
+  if (ota.restartAt && (int32_t)(millis() - ota.restartAt) >= 0)
+  {
+    ESP.restart();
+  }
+}
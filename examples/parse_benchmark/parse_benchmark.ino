@@ -0,0 +1,103 @@
+// Parse time and document memory of a command batch with the parse options of nikolaindustryrealtime:
+//   - full parse (no filter)
+//   - setMessageFilter() with the fields a GPIO handler reads
+//   - setMessageFilter() + setZeroCopyParsing(true), the frame is parsed in place
+// The batch is about 10 KB: BATCH_COMMANDS commands with a label and metadata the handler does not read.
+// Runs without WiFi, the results are printed once.
+
+#include "nikolaindustry-realtime.h"
+
+#define BATCH_COMMANDS 80
+#define RUNS 20
+
+// large enough for the full parse of the batch, NIKOLAINDUSTRY_JSON_CAPACITY is not
+#define FULL_CAPACITY 32768
+
+String batch;
+char *frame = nullptr; // copy of the batch for the in place parse, like the frame buffer of WebSockets
+
+void buildBatch()
+{
+  batch = "{\"from\":\"server\",\"payload\":{\"commands\":[";
+  for (uint16_t i = 0; i < BATCH_COMMANDS; i++)
+  {
+    if (i)
+    {
+      batch += ",";
+    }
+    batch += "{\"command\":\"gpio\",\"pin\":";
+    batch += String(i % 40);
+    batch += ",\"state\":\"";
+    batch += (i & 1) ? "ON" : "OFF";
+    batch += "\",\"label\":\"output channel ";
+    batch += String(i);
+    batch += "\",\"meta\":{\"zone\":\"hall\",\"owner\":\"automation\",\"rev\":";
+    batch += String(i * 7);
+    batch += "}}";
+  }
+  batch += "]}}";
+}
+
+void run(const char *name, size_t capacity, JsonDocument *filter, bool zeroCopy)
+{
+  uint32_t total = 0;
+  size_t used = 0;
+  DeserializationError error;
+  uint32_t heapBefore = ESP.getFreeHeap();
+  uint32_t heapLowest = heapBefore;
+
+  for (uint8_t i = 0; i < RUNS; i++)
+  {
+    memcpy(frame, batch.c_str(), batch.length() + 1);
+    nikolaindustryJsonDocument doc(capacity);
+    heapLowest = min(heapLowest, ESP.getFreeHeap());
+
+    uint32_t start = micros();
+    if (zeroCopy)
+    {
+      if (filter)
+        error = deserializeJson(doc, frame, batch.length(), DeserializationOption::Filter(*filter));
+      else
+        error = deserializeJson(doc, frame, batch.length());
+    }
+    else
+    {
+      if (filter)
+        error = deserializeJson(doc, (const char *)frame, batch.length(), DeserializationOption::Filter(*filter));
+      else
+        error = deserializeJson(doc, (const char *)frame, batch.length());
+    }
+    total += micros() - start;
+    used = doc.memoryUsage();
+  }
+
+  Serial.printf("%-22s %-9s %6lu us  doc %6u bytes  heap -%lu\n", name, error.c_str(),
+                (unsigned long)(total / RUNS), (unsigned)used, (unsigned long)(heapBefore - heapLowest));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  buildBatch();
+  frame = (char *)malloc(batch.length() + 1);
+  Serial.printf("\nbatch %u bytes, %u commands, %u runs each\n", (unsigned)batch.length(), BATCH_COMMANDS, RUNS);
+
+  // what setMessageFilter() keeps for a handler that reads command, pin and state
+  StaticJsonDocument<256> filter;
+  filter["from"] = true;
+  filter["payload"]["commands"][0]["command"] = true;
+  filter["payload"]["commands"][0]["pin"] = true;
+  filter["payload"]["commands"][0]["state"] = true;
+
+  run("full", FULL_CAPACITY, nullptr, false);
+  run("full, 2048 doc", NIKOLAINDUSTRY_JSON_CAPACITY, nullptr, false);
+  run("filter", NIKOLAINDUSTRY_JSON_CAPACITY * 4, &filter, false);
+  run("filter + zero copy", NIKOLAINDUSTRY_JSON_CAPACITY * 4, &filter, true);
+  run("zero copy", FULL_CAPACITY, nullptr, true);
+}
+
+void loop()
+{
+}
@@ -9,6 +9,7 @@
 const char* HttpClient::kUserAgent = "Arduino/2.2.0";
 const char* HttpClient::kContentLengthPrefix = HTTP_HEADER_CONTENT_LENGTH ": ";
 const char* HttpClient::kTransferEncodingChunked = HTTP_HEADER_TRANSFER_ENCODING ": " HTTP_HEADER_VALUE_CHUNKED;
+HttpClient::MemoryHook HttpClient::iMemoryHook = NULL;
 
 HttpClient::HttpClient(Client& aClient, const char* aServerName, uint16_t aServerPort)
  : iClient(&aClient), iServerName(aServerName), iServerAddress(), iServerPort(aServerPort),
@@ -212,11 +213,11 @@ void HttpClient::sendBasicAuth(const char* aUser, const char* aPassword)
     // This seems trickier than it should be but it's mostly to avoid either
     // (a) some arbitrarily sized buffer which hopes to be big enough, or
     // (b) allocating and freeing memory
-    // ...so we'll loop through 3 bytes at a time, outputting the results as we
+    // ...so we'll loop through 48 bytes at a time, outputting the results as we
     // go.
     // In Base64, each 3 bytes of unencoded data become 4 bytes of encoded data
-    unsigned char input[3];
-    unsigned char output[5]; // Leave space for a '\0' terminator so we can easily print
+    unsigned char input[48];
+    unsigned char output[65]; // Leave space for a '\0' terminator so we can easily print
     int userLen = strlen(aUser);
     int passwordLen = strlen(aPassword);
     int inputOffset = 0;
@@ -236,16 +237,15 @@ void HttpClient::sendBasicAuth(const char* aUser, const char* aPassword)
             input[inputOffset++] = aPassword[i-(userLen+1)];
         }
         // See if we've got a chunk to encode
-        if ( (inputOffset == 3) || (i == userLen+passwordLen) )
+        if ( (inputOffset == (int)sizeof(input)) || (i == userLen+passwordLen) )
         {
-            // We've either got to a 3-byte boundary, or we've reached then end
-            b64_encode(input, inputOffset, output, 4);
+            // We've either got to a full chunk (a multiple of 3 bytes), or we've
+            // reached the end, b64_encode pads the final chunk with '='
+            int outputLen = b64_encode(input, inputOffset, output, sizeof(output)-1);
             // NUL-terminate the output string
-            output[4] = '\0';
+            output[outputLen] = '\0';
             // And write it out
             iClient->print((char*)output);
-// FIXME We might want to fill output with '=' characters if b64_encode doesn't
-// FIXME do it for us when we're encoding the final chunk
             inputOffset = 0;
         }
     }
@@ -564,6 +564,9 @@ String HttpClient::responseBody()
         // try to reserve bodyLength bytes
         if (response.reserve(bodyLength) == 0) {
             // String reserve failed
+            if (iMemoryHook) {
+                iMemoryHook(bodyLength, false);
+            }
             return String((const char*)NULL);
         }
     }
@@ -583,10 +586,17 @@ String HttpClient::responseBody()
 
         if (!response.concat((char)c)) {
             // adding char failed
+            if (iMemoryHook) {
+                iMemoryHook(response.length() + 1, false);
+            }
             return String((const char*)NULL);
         }
     }
 
+    if (iMemoryHook) {
+        iMemoryHook(response.length(), true);
+    }
+
     if (bodyLength > 0 && (unsigned int)bodyLength != response.length()) {
         // failure, we did not read in response content length bytes
         return String((const char*)NULL);
@@ -287,6 +287,17 @@ public:
     */
     String responseBody();
 
+    /** Accounting hook for the heap responseBody() takes
+      @param aBytes size of the body String
+      @param aOk false if the String could not get the memory
+    */
+    typedef void (*MemoryHook)(size_t aBytes, bool aOk);
+
+    /** Set a hook that is called for every body read by responseBody(),
+      e.g. to count the largest body and failed allocations, NULL removes it
+    */
+    static void setMemoryHook(MemoryHook aHook) { iMemoryHook = aHook; }
+
     /** Enables connection keep-alive mode
     */
     void connectionKeepAlive();
@@ -350,6 +361,7 @@ protected:
     static const int kHttpResponseTimeout = 30*1000;
     static const char* kContentLengthPrefix;
     static const char* kTransferEncodingChunked;
+    static MemoryHook iMemoryHook;
     typedef enum {
         eIdle,
         eRequestStarted,
@@ -89,6 +89,10 @@ void SocketIOclient::setExtraHeaders(const char * extraHeaders) {
     return WebSocketsClient::setExtraHeaders(extraHeaders);
 }
 
+unsigned long SocketIOclient::getMaxStall(bool reset) {
+    return WebSocketsClient::getMaxStall(reset);
+}
+
 void SocketIOclient::setReconnectInterval(unsigned long time) {
     return WebSocketsClient::setReconnectInterval(time);
 }
@@ -176,7 +180,15 @@ bool SocketIOclient::sendEVENT(String & payload) {
 }
 
 void SocketIOclient::loop(void) {
-    WebSocketsClient::loop();
+    loop(0);
+}
+
+/**
+ * called in arduino loop
+ * @param budgetUs uint32_t  see WebSocketsClient::loop(uint32_t)
+ */
+void SocketIOclient::loop(uint32_t budgetUs) {
+    WebSocketsClient::loop(budgetUs);
     unsigned long t = millis();
     if(!_disableHeartbeat && (t - _lastHeartbeat) > EIO_HEARTBEAT_INTERVAL) {
         _lastHeartbeat = t;
@@ -83,6 +83,8 @@ class SocketIOclient : protected WebSocketsClient {
     void setReconnectInterval(unsigned long time);
 
     void loop(void);
+    void loop(uint32_t budgetUs);
+    unsigned long getMaxStall(bool reset = false);
 
     void configureEIOping(bool disableHeartbeat = false);
 
@@ -28,14 +28,6 @@
 #include <core_esp8266_features.h>
 #endif
 
-extern "C" {
-#ifdef CORE_HAS_LIBB64
-#include <libb64/cencode.h>
-#else
-#include "libb64/cencode_inc.h"
-#endif
-}
-
 #ifdef ESP8266
 #include <Hash.h>
 #elif defined(ESP32)
@@ -59,6 +51,8 @@ extern "C" {
 
 #endif
 
+#include "libbase64/libbase64.h"
+
 /**
  *
  * @param client WSclient_t *  ptr to the client struct
@@ -68,6 +62,8 @@ extern "C" {
  */
 void WebSockets::clientDisconnect(WSclient_t * client, uint16_t code, char * reason, size_t reasonLen) {
     DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] clientDisconnect code: %u\n", client->num, code);
+    TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_CONN, WStrace_disconnect, client->num, code, 0);
+    METRICS_WEBSOCKETS(if(code) WebSocketsMetrics::closeCode(&client->metrics, code));
     if(client->status == WSC_CONNECTED && code) {
         if(reason) {
             sendFrame(client, WSop_close, (uint8_t *)reason, reasonLen);
@@ -208,12 +204,14 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
         return false;
     }
 
-    DEBUG_WEBSOCKETS("[WS][%d][sendFrame] ------- send message frame -------\n", client->num);
-    DEBUG_WEBSOCKETS("[WS][%d][sendFrame] fin: %u opCode: %u mask: %u length: %u headerToPayload: %u\n", client->num, fin, opcode, client->cIsClient, length, headerToPayload);
-
-    if(opcode == WSop_text) {
-        DEBUG_WEBSOCKETS("[WS][%d][sendFrame] text: %s\n", client->num, (payload + (headerToPayload ? 14 : 0)));
+    TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_FRAME, WStrace_frameTx, client->num, WEBSOCKETS_TRACE_FRAME_FLAGS(opcode, fin, client->cIsClient), length);
+    METRICS_WEBSOCKETS(WebSocketsMetrics::frameOut(&client->metrics, opcode, length));
+#ifdef WEBSOCKETS_METRICS
+    if(opcode == WSop_ping) {
+        // 0 is used as "no ping pending"
+        client->metrics.pingSent = millis() | 1;
     }
+#endif
 
     uint8_t maskKey[4]                         = { 0x00, 0x00, 0x00, 0x00 };
     uint8_t buffer[WEBSOCKETS_MAX_HEADER_SIZE] = { 0 };
@@ -241,8 +239,7 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
     // only for ESP since AVR has less HEAP
     // try to send data in one TCP package (only if some free Heap is there)
     if(!headerToPayload && ((length > 0) && (length < 1400)) && (GET_FREE_HEAP > 6000)) {
-        DEBUG_WEBSOCKETS("[WS][%d][sendFrame] pack to one TCP package...\n", client->num);
-        uint8_t * dataPtr = (uint8_t *)malloc(length + WEBSOCKETS_MAX_HEADER_SIZE);
+        uint8_t * dataPtr = (uint8_t *)WEBSOCKETS_MALLOC(length + WEBSOCKETS_MAX_HEADER_SIZE, WSmem_tx);
         if(dataPtr) {
             memcpy((dataPtr + WEBSOCKETS_MAX_HEADER_SIZE), payload, length);
             headerToPayload = true;
@@ -284,7 +281,7 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
         }
     }
 
-#ifndef NODEBUG_WEBSOCKETS
+#ifdef WEBSOCKETS_TRACE
     unsigned long start = micros();
 #endif
 
@@ -309,11 +306,11 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
         }
     }
 
-    DEBUG_WEBSOCKETS("[WS][%d][sendFrame] sending Frame Done (%luus).\n", client->num, (micros() - start));
+    TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_FRAME, WStrace_frameTxDone, client->num, (micros() - start), ret);
 
 #ifdef WEBSOCKETS_USE_BIG_MEM
     if(useInternBuffer && payloadPtr) {
-        free(payloadPtr);
+        WEBSOCKETS_FREE(payloadPtr);
     }
 #endif
 
@@ -325,11 +322,14 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
  * @param client WSclient_t *  ptr to the client struct
  */
 void WebSockets::headerDone(WSclient_t * client) {
-    client->status    = WSC_CONNECTED;
-    client->cWsRXsize = 0;
+    client->status = WSC_CONNECTED;
+    dropFrame(client);
     DEBUG_WEBSOCKETS("[WS][%d][headerDone] Header Handling Done.\n", client->num);
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+    TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_CONN, WStrace_connected, client->num, 0, 0);
+    METRICS_WEBSOCKETS(client->metrics.connects++);
+    resetLink(client);
     client->cHttpLine = "";
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     handleWebsocket(client);
 #endif
 }
@@ -339,9 +339,29 @@ void WebSockets::headerDone(WSclient_t * client) {
  * @param client WSclient_t *  ptr to the client struct
  */
 void WebSockets::handleWebsocket(WSclient_t * client) {
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     if(client->cWsRXsize == 0) {
         handleWebsocketCb(client);
     }
+#else
+    // a partly received frame continues where the last call stopped
+    handleWebsocketCb(client);
+#endif
+}
+
+/**
+ * free the frame being received, on disconnect
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::dropFrame(WSclient_t * client) {
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    if(client->cWsPayload) {
+        WEBSOCKETS_FREE(client->cWsPayload);
+        client->cWsPayload = NULL;
+    }
+    client->cWsPayloadRX = 0;
+#endif
+    client->cWsRXsize = 0;
 }
 
 /**
@@ -363,9 +383,25 @@ bool WebSockets::handleWebsocketWaitFor(WSclient_t * client, size_t size) {
         return true;
     }
 
-    DEBUG_WEBSOCKETS("[WS][%d][handleWebsocketWaitFor] size: %d cWsRXsize: %d\n", client->num, size, client->cWsRXsize);
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    if(client->cWsRXsize == 0) {
+        if(client->tcp->available() <= 0) {
+            return false;
+        }
+        // a new frame starts, the timeout counts from here
+        client->cWsLastRX = millis();
+    }
+
+    int len = readAvailable(client, &client->cWsHeader[client->cWsRXsize], (size - client->cWsRXsize));
+    if(len < 0) {
+        client->cWsRXsize = 0;
+        clientDisconnect(client, 1002);
+        return false;
+    }
+    client->cWsRXsize += len;
+    return (client->cWsRXsize >= size);
+#else
     readCb(client, &client->cWsHeader[client->cWsRXsize], (size - client->cWsRXsize), std::bind([](WebSockets * server, size_t size, WSclient_t * client, bool ok) {
-        DEBUG_WEBSOCKETS("[WS][%d][handleWebsocketWaitFor][readCb] size: %d ok: %d\n", client->num, size, ok);
         if(ok) {
             client->cWsRXsize = size;
             server->handleWebsocketCb(client);
@@ -378,6 +414,7 @@ bool WebSockets::handleWebsocketWaitFor(WSclient_t * client, size_t size) {
     },
                                                                                           this, size, std::placeholders::_1, std::placeholders::_2));
     return false;
+#endif
 }
 
 void WebSockets::handleWebsocketCb(WSclient_t * client) {
@@ -385,6 +422,14 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
         return;
     }
 
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    if(client->cWsPayload) {
+        // the header was handled in an earlier loop
+        readWebsocketPayload(client);
+        return;
+    }
+#endif
+
     uint8_t * buffer = client->cWsHeader;
 
     WSMessageHeader_t * header = &client->cWsHeaderDecode;
@@ -408,20 +453,24 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
     header->payloadLen = (WSopcode_t)(*buffer & 0x7F);
     buffer++;
 
+    // extended length and mask key are waited for in one go
     if(header->payloadLen == 126) {
         headerLen += 2;
-        if(!handleWebsocketWaitFor(client, headerLen)) {
-            return;
-        }
+    } else if(header->payloadLen == 127) {
+        headerLen += 8;
+    }
+    if(header->mask) {
+        headerLen += 4;
+    }
+    if(!handleWebsocketWaitFor(client, headerLen)) {
+        return;
+    }
+
+    if(header->payloadLen == 126) {
         header->payloadLen = buffer[0] << 8 | buffer[1];
         buffer += 2;
     } else if(header->payloadLen == 127) {
-        headerLen += 8;
         // read 64bit integer as length
-        if(!handleWebsocketWaitFor(client, headerLen)) {
-            return;
-        }
-
         if(buffer[0] != 0 || buffer[1] != 0 || buffer[2] != 0 || buffer[3] != 0) {
             // really too big!
             header->payloadLen = 0xFFFFFFFF;
@@ -431,9 +480,8 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
         buffer += 8;
     }
 
-    DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] ------- read massage frame -------\n", client->num);
-    DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] fin: %u rsv1: %u rsv2: %u rsv3 %u  opCode: %u\n", client->num, header->fin, header->rsv1, header->rsv2, header->rsv3, header->opCode);
-    DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] mask: %u payloadLen: %u\n", client->num, header->mask, header->payloadLen);
+    TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_FRAME, WStrace_frameRx, client->num, WEBSOCKETS_TRACE_FRAME_FLAGS(header->opCode, header->fin, header->mask), header->payloadLen);
+    METRICS_WEBSOCKETS(WebSocketsMetrics::frameIn(&client->metrics, header->opCode, header->payloadLen));
 
     if(header->payloadLen > WEBSOCKETS_MAX_DATA_SIZE) {
         DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] payload too big! (%u)\n", client->num, header->payloadLen);
@@ -442,29 +490,58 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
     }
 
     if(header->mask) {
-        headerLen += 4;
-        if(!handleWebsocketWaitFor(client, headerLen)) {
-            return;
-        }
         header->maskKey = buffer;
         buffer += 4;
     }
 
     if(header->payloadLen > 0) {
         // if text data we need one more
-        payload = (uint8_t *)malloc(header->payloadLen + 1);
+        payload = (uint8_t *)WEBSOCKETS_MALLOC(header->payloadLen + 1, WSmem_rx);
 
         if(!payload) {
             DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] to less memory to handle payload %d!\n", client->num, header->payloadLen);
+            TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_ERROR, WStrace_mallocFail, client->num, header->payloadLen + 1, 0);
+            METRICS_WEBSOCKETS(client->metrics.mallocFail++);
             clientDisconnect(client, 1011);
             return;
         }
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+        client->cWsPayload   = payload;
+        client->cWsPayloadRX = 0;
+        readWebsocketPayload(client);
+#else
         readCb(client, payload, header->payloadLen, std::bind(&WebSockets::handleWebsocketPayloadCb, this, std::placeholders::_1, std::placeholders::_2, payload));
+#endif
     } else {
         handleWebsocketPayloadCb(client, true, NULL);
     }
 }
 
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+/**
+ * read what is available of the payload, the frame is handled once it is complete
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::readWebsocketPayload(WSclient_t * client) {
+    WSMessageHeader_t * header = &client->cWsHeaderDecode;
+    uint8_t * payload          = client->cWsPayload;
+
+    int len = readAvailable(client, &payload[client->cWsPayloadRX], (header->payloadLen - client->cWsPayloadRX));
+    if(len < 0) {
+        client->cWsPayload = NULL;
+        handleWebsocketPayloadCb(client, false, payload);
+        return;
+    }
+
+    client->cWsPayloadRX += len;
+    if(client->cWsPayloadRX < header->payloadLen) {
+        return;
+    }
+    client->cWsPayload = NULL;
+    handleWebsocketPayloadCb(client, true, payload);
+}
+#endif
+
 void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t * payload) {
     WSMessageHeader_t * header = &client->cWsHeaderDecode;
     if(ok) {
@@ -481,30 +558,36 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
 
         switch(header->opCode) {
             case WSop_text:
-                DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] text: %s\n", client->num, payload);
-                // fallthrough
             case WSop_binary:
             case WSop_continuation:
                 messageReceived(client, header->opCode, payload, header->payloadLen, header->fin);
                 break;
             case WSop_ping:
                 // send pong back
-                DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] ping received (%s)\n", client->num, payload ? (const char *)payload : "");
+                TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_FRAME, WStrace_ping, client->num, 0, header->payloadLen);
                 sendFrame(client, WSop_pong, payload, header->payloadLen);
                 messageReceived(client, header->opCode, payload, header->payloadLen, header->fin);
                 break;
             case WSop_pong:
-                DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] get pong (%s)\n", client->num, payload ? (const char *)payload : "");
+                TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_FRAME, WStrace_pong, client->num, 0, header->payloadLen);
                 client->pongReceived = true;
+                handleHBPong(client, payload, header->payloadLen);
+#ifdef WEBSOCKETS_METRICS
+                if(client->metrics.pingSent) {
+                    WebSocketsMetrics::count(client->metrics.pingRtt, (millis() - client->metrics.pingSent));
+                    client->metrics.pingSent = 0;
+                }
+#endif
                 messageReceived(client, header->opCode, payload, header->payloadLen, header->fin);
                 break;
             case WSop_close: {
-#ifndef NODEBUG_WEBSOCKETS
+#if !defined(NODEBUG_WEBSOCKETS) || defined(WEBSOCKETS_METRICS)
                 uint16_t reasonCode = 1000;
                 if(header->payloadLen >= 2) {
                     reasonCode = payload[0] << 8 | payload[1];
                 }
 #endif
+                METRICS_WEBSOCKETS(client->metrics.closeRemote++; client->metrics.lastRemoteClose = reasonCode);
                 DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] get ask for close. Code: %d\n", client->num, reasonCode);
                 if(header->payloadLen > 2) {
                     DEBUG_WEBSOCKETS(" (%s)\n", (payload + 2));
@@ -520,7 +603,7 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
         }
 
         if(payload) {
-            free(payload);
+            WEBSOCKETS_FREE(payload);
         }
 
         // reset input
@@ -532,35 +615,60 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
 
     } else {
         DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] missing data!\n", client->num);
-        free(payload);
+        WEBSOCKETS_FREE(payload);
         clientDisconnect(client, 1002);
     }
 }
 
 /**
  * generate the key for Sec-WebSocket-Accept
- * @param clientKey String
- * @return String Accept Key
+ * @param clientKey const char *    Sec-WebSocket-Key
+ * @param length size_t             length of the key
+ * @param acceptKey char *          buffer for the result, WEBSOCKETS_ACCEPT_KEY_SIZE byte
+ * @return true if ok
  */
-String WebSockets::acceptKey(String & clientKey) {
-    uint8_t sha1HashBin[20] = { 0 };
+bool WebSockets::acceptKey(const char * clientKey, size_t length, char * acceptKey) {
+    static const char GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    uint8_t sha1HashBin[20]  = { 0 };
+
+    // rfc6455 keys are 24 byte
+    if(length == 0 || length > WEBSOCKETS_MAX_KEY_SIZE) {
+        return false;
+    }
+
+#if defined(ESP8266) || defined(ESP32)
+    // the core hash functions are one shot, concat key and GUID on the stack
+    uint8_t data[WEBSOCKETS_MAX_KEY_SIZE + sizeof(GUID) - 1];
+    memcpy(&data[0], clientKey, length);
+    memcpy(&data[length], &GUID[0], sizeof(GUID) - 1);
 #ifdef ESP8266
-    sha1(clientKey + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", &sha1HashBin[0]);
-#elif defined(ESP32)
-    String data = clientKey + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
-    esp_sha(SHA1, (unsigned char *)data.c_str(), data.length(), &sha1HashBin[0]);
+    sha1(&data[0], length + sizeof(GUID) - 1, &sha1HashBin[0]);
+#else
+    esp_sha(SHA1, &data[0], length + sizeof(GUID) - 1, &sha1HashBin[0]);
+#endif
 #else
-    clientKey += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
     SHA1_CTX ctx;
     SHA1Init(&ctx);
-    SHA1Update(&ctx, (const unsigned char *)clientKey.c_str(), clientKey.length());
+    SHA1Update(&ctx, (const unsigned char *)clientKey, length);
+    SHA1Update(&ctx, (const unsigned char *)&GUID[0], sizeof(GUID) - 1);
     SHA1Final(&sha1HashBin[0], &ctx);
 #endif
 
-    String key = base64_encode(sha1HashBin, 20);
-    key.trim();
+    base64_encode(&sha1HashBin[0], sizeof(sha1HashBin), acceptKey);
+    return true;
+}
 
-    return key;
+/**
+ * base64_encode into a buffer, see libbase64
+ * @param data const uint8_t *
+ * @param length size_t
+ * @param out char *        buffer with WEBSOCKETS_BASE64_SIZE(length) byte
+ * @return length of the encoded data (without null)
+ */
+size_t WebSockets::base64_encode(const uint8_t * data, size_t length, char * out) {
+    size_t n = base64Encode(data, length, out);
+    out[n]   = 0;
+    return n;
 }
 
 /**
@@ -570,17 +678,12 @@ String WebSockets::acceptKey(String & clientKey) {
  * @return base64 encoded String
  */
 String WebSockets::base64_encode(uint8_t * data, size_t length) {
-    size_t size   = ((length * 1.6f) + 1);
-    size          = std::max(size, (size_t)5);    // minimum buffer size
-    char * buffer = (char *)malloc(size);
+    char * buffer = (char *)WEBSOCKETS_MALLOC(WEBSOCKETS_BASE64_SIZE(length), WSmem_handshake);
     if(buffer) {
-        base64_encodestate _state;
-        base64_init_encodestate(&_state);
-        int len = base64_encode_block((const char *)&data[0], length, &buffer[0], &_state);
-        len     = base64_encode_blockend((buffer + len), &_state);
+        base64_encode(data, length, buffer);
 
         String base64 = String(buffer);
-        free(buffer);
+        WEBSOCKETS_FREE(buffer);
         return base64;
     }
     return String("-FAIL-");
@@ -609,7 +712,10 @@ bool WebSockets::readCb(WSclient_t * client, uint8_t * out, size_t n, WSreadWait
 #else
     unsigned long t = millis();
     ssize_t len;
-    DEBUG_WEBSOCKETS("[readCb] n: %zu t: %lu\n", n, t);
+#ifdef WEBSOCKETS_TRACE
+    unsigned long start = t;
+    size_t total        = n;
+#endif
     while(n > 0) {
         if(client->tcp == NULL) {
             DEBUG_WEBSOCKETS("[readCb] tcp is null!\n");
@@ -629,6 +735,8 @@ bool WebSockets::readCb(WSclient_t * client, uint8_t * out, size_t n, WSreadWait
 
         if((millis() - t) > WEBSOCKETS_TCP_TIMEOUT) {
             DEBUG_WEBSOCKETS("[readCb] receive TIMEOUT! %lu\n", (millis() - t));
+            TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_ERROR, WStrace_readTimeout, client->num, n, (millis() - t));
+            METRICS_WEBSOCKETS(client->metrics.readTimeout++);
             if(cb) {
                 cb(client, false);
             }
@@ -645,6 +753,7 @@ bool WebSockets::readCb(WSclient_t * client, uint8_t * out, size_t n, WSreadWait
             t = millis();
             out += len;
             n -= len;
+            client->rxBytes += len;
             // DEBUG_WEBSOCKETS("Receive %d left %d!\n", len, n);
         } else {
             // DEBUG_WEBSOCKETS("Receive %d left %d!\n", len, n);
@@ -653,6 +762,7 @@ bool WebSockets::readCb(WSclient_t * client, uint8_t * out, size_t n, WSreadWait
             WEBSOCKETS_YIELD();
         }
     }
+    TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_IO, WStrace_read, client->num, total, (millis() - start));
     if(cb) {
         cb(client, true);
     }
@@ -661,6 +771,36 @@ bool WebSockets::readCb(WSclient_t * client, uint8_t * out, size_t n, WSreadWait
     return true;
 }
 
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+/**
+ * read up to n byte of the frame being received, as far as they are available.
+ * never waits for data, unlike readCb
+ * @param client WSclient_t *
+ * @param out  uint8_t * data buffer
+ * @param n size_t byte count
+ * @return bytes read, -1 when the frame got no data for WEBSOCKETS_TCP_TIMEOUT
+ */
+int WebSockets::readAvailable(WSclient_t * client, uint8_t * out, size_t n) {
+    int available = client->tcp->available();
+    if(available > 0) {
+        int len = client->tcp->read(out, std::min((size_t)available, n));
+        if(len > 0) {
+            client->cWsLastRX = millis();
+            client->rxBytes += len;
+            return len;
+        }
+    }
+
+    if((millis() - client->cWsLastRX) > WEBSOCKETS_TCP_TIMEOUT) {
+        DEBUG_WEBSOCKETS("[readAvailable] receive TIMEOUT! %lu\n", (millis() - client->cWsLastRX));
+        TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_ERROR, WStrace_readTimeout, client->num, n, (millis() - client->cWsLastRX));
+        METRICS_WEBSOCKETS(client->metrics.readTimeout++);
+        return -1;
+    }
+    return 0;
+}
+#endif
+
 /**
  * write x byte to tcp or get timeout
  * @param client WSclient_t *
@@ -676,7 +816,12 @@ size_t WebSockets::write(WSclient_t * client, uint8_t * out, size_t n) {
     unsigned long t = millis();
     size_t len      = 0;
     size_t total    = 0;
-    DEBUG_WEBSOCKETS("[write] n: %zu t: %lu\n", n, t);
+#ifdef WEBSOCKETS_TRACE
+    unsigned long start = t;
+#endif
+#ifdef WEBSOCKETS_METRICS
+    unsigned long blockStart = micros();
+#endif
     while(n > 0) {
         if(client->tcp == NULL) {
             DEBUG_WEBSOCKETS("[write] tcp is null!\n");
@@ -690,6 +835,8 @@ size_t WebSockets::write(WSclient_t * client, uint8_t * out, size_t n) {
 
         if((millis() - t) > WEBSOCKETS_TCP_TIMEOUT) {
             DEBUG_WEBSOCKETS("[write] write TIMEOUT! %lu\n", (millis() - t));
+            TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_ERROR, WStrace_writeTimeout, client->num, n, (millis() - t));
+            METRICS_WEBSOCKETS(client->metrics.writeTimeout++);
             break;
         }
 
@@ -701,12 +848,14 @@ size_t WebSockets::write(WSclient_t * client, uint8_t * out, size_t n) {
             total += len;
             // DEBUG_WEBSOCKETS("write %d left %d!\n", len, n);
         } else {
-            DEBUG_WEBSOCKETS("WS write %d failed left %d!\n", len, n);
+            TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_IO, WStrace_writeStall, client->num, n, 0);
         }
         if(n > 0) {
             WEBSOCKETS_YIELD();
         }
     }
+    TRACE_WEBSOCKETS(WEBSOCKETS_TRACE_IO, WStrace_write, client->num, total, (millis() - start));
+    METRICS_WEBSOCKETS(WebSocketsMetrics::count(client->metrics.writeBlock, (micros() - blockStart)));
     WEBSOCKETS_YIELD();
     return total;
 }
@@ -746,9 +895,10 @@ void WebSockets::handleHBTimeout(WSclient_t * client) {
         if(client->pongReceived) {
             client->pongTimeoutCount = 0;
         } else {
-            if(pi > client->pongTimeout) {    // pong not received in time
+            if(pi > heartbeatTimeout(client)) {    // pong not received in time
                 client->pongTimeoutCount++;
-                client->lastPing = millis() - client->pingInterval - 500;    // force ping on the next run
+                handleHBLoss(client);
+                client->lastPing = millis() - heartbeatInterval(client) - 500;    // force ping on the next run
 
                 DEBUG_WEBSOCKETS("[HBtimeout] pong TIMEOUT! lp=%d millis=%lu pi=%d count=%d\n", client->lastPing, millis(), pi, client->pongTimeoutCount);
 
@@ -760,3 +910,300 @@ void WebSockets::handleHBTimeout(WSclient_t * client) {
         }
     }
 }
+
+/**
+ * fill the payload of a heartbeat ping, the pong echos it back
+ * @param client WSclient_t *
+ * @param payload uint8_t *  WEBSOCKETS_HB_PAYLOAD_SIZE byte
+ * @return payload length
+ */
+size_t WebSockets::heartbeatPayload(WSclient_t * client, uint8_t * payload) {
+    if(client->link.pending) {
+        // no pong timeout configured, a new ping replaces the unanswered one
+        handleHBLoss(client);
+    }
+
+    uint32_t now = millis();
+    client->link.seq++;
+    client->link.sent    = now;
+    client->link.pending = true;
+
+    payload[0] = 'H';
+    payload[1] = 'B';
+    payload[2] = (client->link.seq >> 8) & 0xFF;
+    payload[3] = client->link.seq & 0xFF;
+    payload[4] = (now >> 24) & 0xFF;
+    payload[5] = (now >> 16) & 0xFF;
+    payload[6] = (now >> 8) & 0xFF;
+    payload[7] = now & 0xFF;
+    return WEBSOCKETS_HB_PAYLOAD_SIZE;
+}
+
+/**
+ * match a pong against the pending heartbeat ping and update the rtt estimate
+ * pongs of user pings and late pongs (ping already counted as lost) are ignored
+ * @param client WSclient_t *
+ * @param payload uint8_t *
+ * @param length size_t
+ */
+void WebSockets::handleHBPong(WSclient_t * client, uint8_t * payload, size_t length) {
+    WSlinkState_t * link = &client->link;
+    if(!link->pending || length != WEBSOCKETS_HB_PAYLOAD_SIZE || payload[0] != 'H' || payload[1] != 'B') {
+        return;
+    }
+    if((uint16_t)(payload[2] << 8 | payload[3]) != link->seq) {
+        return;
+    }
+
+    uint32_t sent = ((uint32_t)payload[4] << 24) | ((uint32_t)payload[5] << 16) | ((uint32_t)payload[6] << 8) | payload[7];
+    uint32_t rtt  = millis() - sent;
+
+    link->pending = false;
+    link->lastRtt = rtt;
+    link->samples++;
+
+    if(link->samples == 1) {
+        link->srtt   = rtt << 3;
+        link->rttvar = rtt << 1;
+    } else {
+        // srtt = 7/8 srtt + 1/8 rtt, rttvar = 3/4 rttvar + 1/4 |rtt - srtt|
+        int32_t err = (int32_t)rtt - (int32_t)(link->srtt >> 3);
+        link->srtt += err;
+        if(err < 0) {
+            err = -err;
+        }
+        link->rttvar = link->rttvar - (link->rttvar >> 2) + err;
+    }
+
+    link->loss -= (link->loss >> 3);
+
+    DEBUG_WEBSOCKETS("[WS][%d][HB] rtt: %u srtt: %u rttvar: %u\n", client->num, rtt, (link->srtt >> 3), (link->rttvar >> 2));
+}
+
+/**
+ * the pending heartbeat ping got no pong in time
+ * @param client WSclient_t *
+ */
+void WebSockets::handleHBLoss(WSclient_t * client) {
+    WSlinkState_t * link = &client->link;
+    link->pending        = false;
+    link->loss += ((0xFFFF - link->loss) >> 3);
+}
+
+/**
+ * start a new estimate, called for every new connection
+ * @param client WSclient_t *
+ */
+void WebSockets::resetLink(WSclient_t * client) {
+    bool adaptive         = client->link.adaptive;
+    client->link          = WSlinkState_t();
+    client->link.adaptive = adaptive;
+}
+
+/**
+ * pong timeout to use for the next ping
+ * adaptive: twice the tcp style retransmit timeout (srtt + 4 * rttvar),
+ * at least WEBSOCKETS_HB_MIN_PONG_TIMEOUT and at most 4 * the configured timeout
+ * @param client WSclient_t *
+ * @return ms
+ */
+uint32_t WebSockets::heartbeatTimeout(WSclient_t * client) {
+    WSlinkState_t * link = &client->link;
+    if(!link->adaptive || link->samples == 0 || client->pongTimeout == 0) {
+        return client->pongTimeout;
+    }
+
+    uint32_t timeout = ((link->srtt >> 3) + link->rttvar) * 2;
+    if(timeout < WEBSOCKETS_HB_MIN_PONG_TIMEOUT) {
+        timeout = WEBSOCKETS_HB_MIN_PONG_TIMEOUT;
+    }
+    if(timeout > (client->pongTimeout * 4)) {
+        timeout = (client->pongTimeout * 4);
+    }
+    return timeout;
+}
+
+/**
+ * ping interval to use for the next ping
+ * adaptive: lossy links are probed more often (1/2 above 12.5% loss, 1/4 above 25%)
+ * so a dead link is detected before the application runs into timeouts
+ * @param client WSclient_t *
+ * @return ms
+ */
+uint32_t WebSockets::heartbeatInterval(WSclient_t * client) {
+    if(!client->link.adaptive || client->pingInterval == 0) {
+        return client->pingInterval;
+    }
+
+    uint32_t interval = client->pingInterval;
+    if(client->link.loss > 0x4000) {
+        interval >>= 2;
+    } else if(client->link.loss > 0x2000) {
+        interval >>= 1;
+    }
+
+    uint32_t timeout = heartbeatTimeout(client);
+    if(interval < timeout) {
+        interval = (timeout < client->pingInterval) ? timeout : client->pingInterval;
+    }
+    return interval;
+}
+
+/**
+ * snapshot of the link estimate
+ * @param client WSclient_t *
+ * @param quality WSlinkQuality_t *
+ */
+void WebSockets::linkQuality(WSclient_t * client, WSlinkQuality_t * quality) {
+    WSlinkState_t * link  = &client->link;
+    quality->rtt          = (link->srtt >> 3);
+    quality->rttVar       = (link->rttvar >> 2);
+    quality->lastRtt      = link->lastRtt;
+    quality->samples      = link->samples;
+    quality->loss         = ((uint32_t)link->loss * 100 + 0x7FFF) / 0xFFFF;
+    quality->pingInterval = heartbeatInterval(client);
+    quality->pongTimeout  = heartbeatTimeout(client);
+}
+
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+/**
+ * read one http header line into a fixed buffer
+ * only the bytes that are available are read, readBytesUntil() would wait for the rest of the line
+ * for the stream timeout. a partly received line is kept in cHttpLine and continued on the next call.
+ * the '\n' is not stored and the line is null terminated,
+ * the rest of a line longer then the buffer is dropped.
+ * @param client WSclient_t *  ptr to the client struct
+ * @param line char *          buffer
+ * @param size size_t          size of the buffer
+ * @param length size_t *      length of the line
+ * @return true if a whole line was read
+ */
+bool WebSockets::readHeaderLine(WSclient_t * client, char * line, size_t size, size_t * length) {
+    size_t len = std::min((size_t)client->cHttpLine.length(), size - 1);
+    if(len) {
+        memcpy(line, client->cHttpLine.c_str(), len);
+        client->cHttpLine = String();
+    }
+
+    bool truncated = false;
+    int available  = client->tcp->available();
+    while(available-- > 0) {
+        int c = client->tcp->read();
+        if(c < 0) {
+            break;
+        }
+        client->rxBytes++;
+        if(c == '\n') {
+            line[len] = 0;
+            *length   = len;
+            return true;
+        }
+        if(len < size - 1) {
+            line[len++] = c;
+        } else if(!truncated) {
+            truncated = true;
+            DEBUG_WEBSOCKETS("[WS][%d][readHeaderLine] line too long, truncated\n", client->num);
+        }
+    }
+
+    line[len]         = 0;
+    client->cHttpLine = line;
+    return false;
+}
+#endif
+
+/**
+ * remove leading and trailing white space (and the \r) in place
+ * @param line char *        null terminated line
+ * @param length size_t *    length of the line, updated
+ * @return start of the trimmed line
+ */
+char * WebSockets::trimHeaderLine(char * line, size_t * length) {
+    size_t len = *length;
+    while(len > 0 && isspace((uint8_t)line[len - 1])) {
+        len--;
+    }
+    while(len > 0 && isspace((uint8_t)*line)) {
+        line++;
+        len--;
+    }
+    line[len] = 0;
+    *length   = len;
+    return line;
+}
+
+#define WS_KNOWN_HEADER(name, header) \
+    { WSheaderHash(name), sizeof(name) - 1, header, name }
+
+/**
+ * http header names the parser knows, hash and length are compile time constants
+ * a hash and length match is confirmed by comparing the name, the hash folds more than the case
+ */
+static const struct {
+    uint32_t hash;
+    uint8_t length;
+    WSheader_t header;
+    const char * name;
+} knownHeaders[] = {
+    WS_KNOWN_HEADER("connection", WSheader_connection),
+    WS_KNOWN_HEADER("upgrade", WSheader_upgrade),
+    WS_KNOWN_HEADER("sec-websocket-key", WSheader_secWebSocketKey),
+    WS_KNOWN_HEADER("sec-websocket-accept", WSheader_secWebSocketAccept),
+    WS_KNOWN_HEADER("sec-websocket-version", WSheader_secWebSocketVersion),
+    WS_KNOWN_HEADER("sec-websocket-protocol", WSheader_secWebSocketProtocol),
+    WS_KNOWN_HEADER("sec-websocket-extensions", WSheader_secWebSocketExtensions),
+    WS_KNOWN_HEADER("authorization", WSheader_authorization),
+    WS_KNOWN_HEADER("set-cookie", WSheader_setCookie),
+};
+
+/**
+ * split a trimmed "name: value" header line in place
+ * the ':' is replaced by a null so line is the name afterwards
+ * @param line char *       trimmed header line
+ * @param value char **     set to the value (leading white space skipped)
+ * @return WSheader_t       the header, WSheader_invalid if the line has no ':'
+ */
+WSheader_t WebSockets::parseHeaderLine(char * line, char ** value) {
+    uint32_t hash = WSheaderHash("");
+    char * p      = line;
+
+    while(*p && *p != ':') {
+        hash = WSheaderHashStep(hash, *p);
+        p++;
+    }
+
+    if(*p != ':') {
+        return WSheader_invalid;
+    }
+
+    size_t nameLength = p - line;
+    *p++              = 0;
+
+    // remove space in the beginning (RFC2616)
+    while(*p == ' ' || *p == '\t') {
+        p++;
+    }
+    *value = p;
+
+    for(size_t i = 0; i < (sizeof(knownHeaders) / sizeof(knownHeaders[0])); i++) {
+        if(knownHeaders[i].hash == hash && knownHeaders[i].length == nameLength && strncasecmp(line, knownHeaders[i].name, nameLength) == 0) {
+            return knownHeaders[i].header;
+        }
+    }
+    return WSheader_unknown;
+}
+
+/**
+ * case insensitive search for token in a header value
+ * @param value const char *
+ * @param token const char *
+ */
+bool WebSockets::headerValueContains(const char * value, const char * token) {
+    size_t len = strlen(token);
+    for(; *value; value++) {
+        if(strncasecmp(value, token, len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -41,6 +41,7 @@
 #endif
 
 #include "WebSocketsVersion.h"
+#include "WebSocketsTrace.h"
 
 #ifndef NODEBUG_WEBSOCKETS
 #ifdef DEBUG_ESP_PORT
@@ -111,6 +112,15 @@
 #define WEBSOCKETS_YIELD() yield()
 #define WEBSOCKETS_YIELD_MORE() delay(1)
 
+#elif defined(WEBSOCKETS_HOST)
+
+// tests/host, the Arduino api comes from the shim there
+#define WEBSOCKETS_MAX_DATA_SIZE (15 * 1024)
+#define WEBSOCKETS_USE_BIG_MEM
+#define GET_FREE_HEAP (1024 * 1024)
+#define WEBSOCKETS_YIELD() yield()
+#define WEBSOCKETS_YIELD_MORE() delay(1)
+
 #else
 
 // atmega328p has only 2KB ram!
@@ -125,6 +135,31 @@
 #define WEBSOCKETS_TCP_TIMEOUT (5000)
 #endif
 
+#ifndef WEBSOCKETS_HEADER_LINE_MAX
+#define WEBSOCKETS_HEADER_LINE_MAX (384)    ///< longer http header lines are truncated
+#endif
+
+// heartbeat ping payload: "HB", 16 bit sequence, 32 bit millis
+#define WEBSOCKETS_HB_PAYLOAD_SIZE (8)
+
+#ifndef WEBSOCKETS_HB_MIN_PONG_TIMEOUT
+#define WEBSOCKETS_HB_MIN_PONG_TIMEOUT (1000)    ///< adaptive pong timeout never goes below
+#endif
+
+// per connection counters and histograms (~300 Byte per client)
+#if defined(WEBSOCKETS_USE_BIG_MEM) && !defined(NOMETRICS_WEBSOCKETS) && !defined(WEBSOCKETS_METRICS)
+#define WEBSOCKETS_METRICS
+#endif
+
+#include "WebSocketsMetrics.h"
+
+// tagged heap accounting of the library buffers, 8 Byte more per allocation
+#if defined(WEBSOCKETS_USE_BIG_MEM) && !defined(NOMEMORY_WEBSOCKETS) && !defined(WEBSOCKETS_MEMORY)
+#define WEBSOCKETS_MEMORY
+#endif
+
+#include "WebSocketsMemory.h"
+
 #define NETWORK_ESP8266_ASYNC (0)
 #define NETWORK_ESP8266 (1)
 #define NETWORK_W5100 (2)
@@ -135,10 +170,24 @@
 #define NETWORK_UNOWIFIR4 (7)
 #define NETWORK_WIFI_NINA (8)
 #define NETWORK_SAMD_SEED (9)
+#define NETWORK_CUSTOM (10)
 
 // max size of the WS Message Header
 #define WEBSOCKETS_MAX_HEADER_SIZE (14)
 
+// Sec-WebSocket-Key longer then this is rejected (rfc6455 keys are 24 byte)
+#define WEBSOCKETS_MAX_KEY_SIZE (64)
+
+// base64 of 16 byte random key / 20 byte sha1 + null
+#define WEBSOCKETS_BASE64_SIZE(len) ((((len) + 2) / 3) * 4 + 1)
+#define WEBSOCKETS_CLIENT_KEY_SIZE WEBSOCKETS_BASE64_SIZE(16)
+#define WEBSOCKETS_ACCEPT_KEY_SIZE WEBSOCKETS_BASE64_SIZE(20)
+
+#ifndef WEBSOCKETS_HANDSHAKE_SIZE
+// handshakes up to this size are built on the stack, longer ones in a malloc buffer
+#define WEBSOCKETS_HANDSHAKE_SIZE (512)
+#endif
+
 #if !defined(WEBSOCKETS_NETWORK_TYPE)
 // select Network type based
 #if defined(ESP8266) || defined(ESP31B)
@@ -286,6 +335,26 @@
 #define WEBSOCKETS_NETWORK_CLASS WiFiClient
 #define WEBSOCKETS_NETWORK_SERVER_CLASS WiFiServer
 
+#elif(WEBSOCKETS_NETWORK_TYPE == NETWORK_CUSTOM)
+
+// Note:
+//   the header named by WEBSOCKETS_NETWORK_CUSTOM_INCLUDE provides the tcp classes,
+//   it is part of the application, the library ships none.
+//   WEBSOCKETS_NETWORK_CLASS needs the Client / Stream interface (connect, connected, available,
+//   read, write, flush, stop, setTimeout, remoteIP), WEBSOCKETS_NETWORK_SERVER_CLASS a constructor (port),
+//   begin(), close(), hasClient() and accept() returning a WEBSOCKETS_NETWORK_CLASS.
+//   tests/host/net/HostNetwork.h is an example.
+//   WEBSOCKETS_NETWORK_SSL_CLASS is optional.
+
+#ifndef WEBSOCKETS_NETWORK_CUSTOM_INCLUDE
+#error "network type CUSTOM needs WEBSOCKETS_NETWORK_CUSTOM_INCLUDE"
+#endif
+#include WEBSOCKETS_NETWORK_CUSTOM_INCLUDE
+
+#if !defined(WEBSOCKETS_NETWORK_CLASS) || !defined(WEBSOCKETS_NETWORK_SERVER_CLASS)
+#error "WEBSOCKETS_NETWORK_CUSTOM_INCLUDE has to define WEBSOCKETS_NETWORK_CLASS and WEBSOCKETS_NETWORK_SERVER_CLASS"
+#endif
+
 #else
 #error "no network type selected!"
 #endif
@@ -308,6 +377,75 @@ typedef enum {
     WSC_CONNECTED
 } WSclientsStatus_t;
 
+typedef enum {
+    WSheader_invalid,    ///< line is not "name: value"
+    WSheader_unknown,
+    WSheader_connection,
+    WSheader_upgrade,
+    WSheader_secWebSocketKey,
+    WSheader_secWebSocketAccept,
+    WSheader_secWebSocketVersion,
+    WSheader_secWebSocketProtocol,
+    WSheader_secWebSocketExtensions,
+    WSheader_authorization,
+    WSheader_setCookie
+} WSheader_t;
+
+/**
+ * case insensitive FNV-1a hash of http header names,
+ * constexpr so the names the parser knows are hashed at compile time
+ */
+constexpr uint32_t WSheaderHashStep(uint32_t hash, char c) {
+    return (hash ^ (uint8_t)(c | 0x20)) * 16777619UL;
+}
+
+constexpr uint32_t WSheaderHash(const char * name, uint32_t hash = 2166136261UL) {
+    return *name ? WSheaderHash(name + 1, WSheaderHashStep(hash, *name)) : hash;
+}
+
+/**
+ * assembles a http header in one buffer,
+ * a first pass with buffer NULL only sums up the length needed
+ */
+typedef struct WSheaderBuffer {
+    char * buffer = NULL;
+    size_t length = 0;
+    char * heap   = NULL;    ///< buffer if it did not fit on the stack
+
+    /**
+     * start the fill pass, uses stack when the counted length (+ null) fits
+     * @param stack char *
+     * @param size size_t
+     * @return false if the malloc fallback failed
+     */
+    bool begin(char * stack, size_t size) {
+        if(length < size) {
+            buffer = stack;
+        } else {
+            heap = buffer = (char *)WEBSOCKETS_MALLOC(length + 1, WSmem_handshake);
+        }
+        length = 0;
+        return (buffer != NULL);
+    }
+    void end() {
+        WEBSOCKETS_FREE(heap);
+        heap = buffer = NULL;
+    }
+
+    void add(const char * str, size_t len) {
+        if(buffer) {
+            memcpy(buffer + length, str, len);
+        }
+        length += len;
+    }
+    void add(const char * str) {
+        add(str, strlen(str));
+    }
+    void add(const String & str) {
+        add(str.c_str(), str.length());
+    }
+} WSheaderBuffer_t;
+
 typedef enum {
     WStype_ERROR,
     WStype_DISCONNECTED,
@@ -347,6 +485,34 @@ typedef struct {
     uint8_t * maskKey;
 } WSMessageHeader_t;
 
+/**
+ * rtt estimator of the heartbeat, fixed point like the tcp srtt / rttvar (RFC 6298)
+ */
+typedef struct {
+    uint32_t sent    = 0;        ///< millis of the pending heartbeat ping
+    uint32_t srtt    = 0;        ///< smoothed rtt in ms << 3
+    uint32_t rttvar  = 0;        ///< rtt variance in ms << 2
+    uint32_t lastRtt = 0;        ///< ms
+    uint32_t samples = 0;        ///< matched pongs
+    uint16_t loss    = 0;        ///< lost pings, EWMA in 1/65535
+    uint16_t seq     = 0;        ///< sequence of the pending heartbeat ping
+    bool pending     = false;    ///< ping send and no matching pong yet
+    bool adaptive    = false;    ///< derive ping interval and pong timeout from the estimate
+} WSlinkState_t;
+
+/**
+ * snapshot of the link estimate
+ */
+typedef struct {
+    uint32_t rtt;             ///< smoothed rtt in ms, 0 = no sample yet
+    uint32_t rttVar;          ///< rtt variance in ms
+    uint32_t lastRtt;         ///< ms
+    uint32_t samples;         ///< matched pongs since connect
+    uint8_t loss;             ///< lost pings in percent (EWMA, ~ last 8 pings)
+    uint32_t pingInterval;    ///< ms, currently used
+    uint32_t pongTimeout;     ///< ms, currently used
+} WSlinkQuality_t;
+
 typedef struct {
     void init(uint8_t num,
         uint32_t pingInterval,
@@ -379,8 +545,7 @@ typedef struct {
     bool cIsWebsocket = false;    ///< Upgrade == websocket
 
     String cSessionId;        ///< client Set-Cookie (session id)
-    String cKey;              ///< client Sec-WebSocket-Key
-    String cAccept;           ///< client Sec-WebSocket-Accept
+    String cKey;              ///< client Sec-WebSocket-Key (server side)
     String cProtocol;         ///< client Sec-WebSocket-Protocol
     String cExtensions;       ///< client Sec-WebSocket-Extensions
     uint16_t cVersion = 0;    ///< client Sec-WebSocket-Version
@@ -388,6 +553,11 @@ typedef struct {
     uint8_t cWsRXsize = 0;                            ///< State of the RX
     uint8_t cWsHeader[WEBSOCKETS_MAX_HEADER_SIZE];    ///< RX WS Message buffer
     WSMessageHeader_t cWsHeaderDecode;
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    uint8_t * cWsPayload = NULL;    ///< payload of the frame being received, continued in the next loop
+    size_t cWsPayloadRX  = 0;       ///< payload bytes received
+    uint32_t cWsLastRX   = 0;       ///< millis of the last data of the frame being received
+#endif
 
     String base64Authorization;    ///< Base64 encoded Auth request
     String plainAuthorization;     ///< Base64 encoded Auth request
@@ -404,10 +574,17 @@ typedef struct {
     uint8_t disconnectTimeoutCount = 0;    // after how many subsequent pong timeouts discconnect will happen, 0 means "do not disconnect"
     uint8_t pongTimeoutCount       = 0;    // current pong timeout count
 
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-    String cHttpLine;    ///< HTTP header lines
+    WSlinkState_t link;
+
+    uint32_t serviceCount = 0;    ///< header lines / frames handled for this client
+    uint32_t rxBytes      = 0;    ///< bytes read from tcp
+
+#ifdef WEBSOCKETS_METRICS
+    WSmetrics_t metrics = {};
 #endif
 
+    String cHttpLine;    ///< HTTP header line not complete yet
+
 } WSclient_t;
 
 class WebSockets {
@@ -436,8 +613,22 @@ class WebSockets {
     bool handleWebsocketWaitFor(WSclient_t * client, size_t size);
     void handleWebsocketCb(WSclient_t * client);
     void handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t * payload);
+    void dropFrame(WSclient_t * client);
+
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    void readWebsocketPayload(WSclient_t * client);
+    int readAvailable(WSclient_t * client, uint8_t * out, size_t n);
+#endif
 
-    String acceptKey(String & clientKey);
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    bool readHeaderLine(WSclient_t * client, char * line, size_t size, size_t * length);
+#endif
+    static char * trimHeaderLine(char * line, size_t * length);
+    static WSheader_t parseHeaderLine(char * line, char ** value);
+    static bool headerValueContains(const char * value, const char * token);
+
+    bool acceptKey(const char * clientKey, size_t length, char * acceptKey);
+    static size_t base64_encode(const uint8_t * data, size_t length, char * out);
     String base64_encode(uint8_t * data, size_t length);
 
     bool readCb(WSclient_t * client, uint8_t * out, size_t n, WSreadWaitCb cb);
@@ -446,6 +637,14 @@ class WebSockets {
 
     void enableHeartbeat(WSclient_t * client, uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount);
     void handleHBTimeout(WSclient_t * client);
+
+    size_t heartbeatPayload(WSclient_t * client, uint8_t * payload);
+    void handleHBPong(WSclient_t * client, uint8_t * payload, size_t length);
+    void handleHBLoss(WSclient_t * client);
+    void resetLink(WSclient_t * client);
+    uint32_t heartbeatInterval(WSclient_t * client);
+    uint32_t heartbeatTimeout(WSclient_t * client);
+    void linkQuality(WSclient_t * client, WSlinkQuality_t * quality);
 };
 
 #ifndef UNUSED
@@ -31,6 +31,12 @@ WebSocketsClient::WebSocketsClient() {
     _client.cIsClient    = true;
     _client.extraHeaders = WEBSOCKETS_STRING("Origin: file://");
     _reconnectInterval   = 500;
+    _connectStart        = 0;
+    _handshakeTime       = 0;
+    _acceptKey[0]        = 0;
+    _acceptOk            = false;
+    _connectFailures     = 0;
+    _maxStall            = 0;
     _port                = 0;
     _host                = "";
 }
@@ -68,7 +74,6 @@ void WebSocketsClient::begin(const char * host, uint16_t port, const char * url,
     _client.cIsUpgrade          = false;
     _client.cIsWebsocket        = true;
     _client.cKey                = "";
-    _client.cAccept             = "";
     _client.cProtocol           = protocol;
     _client.cExtensions         = "";
     _client.cVersion            = 0;
@@ -94,6 +99,8 @@ void WebSocketsClient::begin(const char * host, uint16_t port, const char * url,
 
     _lastConnectionFail = 0;
     _lastHeaderSent     = 0;
+    _handshakeTime      = 0;
+    _connectFailures    = 0;
 
     DEBUG_WEBSOCKETS("[WS-Client] Websocket Version: " WEBSOCKETS_VERSION "\n");
 }
@@ -227,12 +234,23 @@ void WebSocketsClient::beginSocketIOSSLWithCA(const char * host, uint16_t port,
 
 #if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
 /**
- * called in arduino loop
+ * called in arduino loop, handles one header line or frame
  */
 void WebSocketsClient::loop(void) {
+    loop(0);
+}
+
+/**
+ * called in arduino loop, handles received data until budgetUs are used up.
+ * frames are read as far as the data is there and continued in the next call,
+ * a connect attempt blocks until it is done (up to WEBSOCKETS_TCP_TIMEOUT plus TLS)
+ * @param budgetUs uint32_t  no further header line or frame is started after this, 0 = only one
+ */
+void WebSocketsClient::loop(uint32_t budgetUs) {
     if(_port == 0) {
         return;
     }
+    unsigned long start = micros();
     WEBSOCKETS_YIELD();
     if(!clientIsConnected(&_client)) {
         // do not flood the server
@@ -312,6 +330,7 @@ void WebSocketsClient::loop(void) {
             return;
         }
         WEBSOCKETS_YIELD();
+        _connectStart = millis();
 #if defined(ESP32)
         if(_client.tcp->connect(_host.c_str(), _port, WEBSOCKETS_TCP_TIMEOUT)) {
 #else
@@ -324,13 +343,20 @@ void WebSocketsClient::loop(void) {
             _lastConnectionFail = millis();
         }
     } else {
-        handleClientData();
+        do {
+            handleClientData();
+        } while(budgetUs && _client.tcp && _client.tcp->available() > 0 && (micros() - start) < budgetUs);
         WEBSOCKETS_YIELD();
         if(_client.status == WSC_CONNECTED) {
             handleHBPing();
             handleHBTimeout(&_client);
         }
     }
+
+    unsigned long stall = micros() - start;
+    if(stall > _maxStall) {
+        _maxStall = stall;
+    }
 }
 #endif
 
@@ -401,6 +427,25 @@ bool WebSocketsClient::sendBIN(const uint8_t * payload, size_t length) {
     return sendBIN((uint8_t *)payload, length);
 }
 
+/**
+ * send one fragment of a message
+ * the first fragment has WSop_text or WSop_binary, the following WSop_continuation, the last one fin.
+ * no other text / binary message may be send until the last fragment,
+ * ping / pong (heartbeat) may be send in between (RFC 6455 5.4)
+ * @param opcode WSopcode_t
+ * @param payload uint8_t *
+ * @param length size_t
+ * @param fin bool  last fragment
+ * @param headerToPayload bool  (see sendFrame for more details)
+ * @return true if ok
+ */
+bool WebSocketsClient::sendFragment(WSopcode_t opcode, uint8_t * payload, size_t length, bool fin, bool headerToPayload) {
+    if(clientIsConnected(&_client)) {
+        return sendFrame(&_client, opcode, payload, length, fin, headerToPayload);
+    }
+    return false;
+}
+
 /**
  * sends a WS ping to Server
  * @param payload uint8_t *
@@ -478,6 +523,55 @@ bool WebSocketsClient::isConnected(void) {
     return (_client.status == WSC_CONNECTED);
 }
 
+/**
+ * failed connection attempts (connect, TLS or upgrade) since the last successful connection or begin
+ * @return uint8_t
+ */
+uint8_t WebSocketsClient::getConnectFailures(void) {
+    return _connectFailures;
+}
+
+/**
+ * time the last successful connection took from the start of the TCP connect
+ * to the upgrade response, including DNS and TLS
+ * @return unsigned long ms, 0 if not connected yet
+ */
+unsigned long WebSocketsClient::getHandshakeTime(void) {
+    return _handshakeTime;
+}
+
+/**
+ * longest loop() call, a connect attempt is usually the longest
+ * @param reset bool  start over after reading
+ * @return unsigned long us
+ */
+unsigned long WebSocketsClient::getMaxStall(bool reset) {
+    unsigned long stall = _maxStall;
+    if(reset) {
+        _maxStall = 0;
+    }
+    return stall;
+}
+
+#ifdef WEBSOCKETS_METRICS
+/**
+ * copy the counters, they are kept over reconnects
+ * @param metrics WSmetrics_t *  snapshot
+ */
+void WebSocketsClient::getMetrics(WSmetrics_t * metrics) {
+    if(metrics) {
+        memcpy(metrics, &_client.metrics, sizeof(WSmetrics_t));
+    }
+}
+
+/**
+ * clear the counters
+ */
+void WebSocketsClient::resetMetrics(void) {
+    WebSocketsMetrics::reset(&_client.metrics);
+}
+#endif
+
 // #################################################################################
 // #################################################################################
 // #################################################################################
@@ -525,6 +619,13 @@ void WebSocketsClient::messageReceived(WSclient_t * client, WSopcode_t opcode, u
 void WebSocketsClient::clientDisconnect(WSclient_t * client) {
     bool event = false;
 
+    if(client->status == WSC_HEADER || client->status == WSC_BODY) {
+        // closed before the upgrade completed
+        if(_connectFailures < 0xFF) {
+            _connectFailures++;
+        }
+    }
+
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_RP2040)
     if(client->isSSL && client->ssl) {
         if(client->ssl->connected()) {
@@ -560,17 +661,21 @@ void WebSocketsClient::clientDisconnect(WSclient_t * client) {
 
     client->cCode        = 0;
     client->cKey         = "";
-    client->cAccept      = "";
     client->cVersion     = 0;
     client->cIsUpgrade   = false;
     client->cIsWebsocket = false;
     client->cSessionId   = "";
+    client->cHttpLine    = "";
+
+    dropFrame(client);
 
     client->status      = WSC_NOT_CONNECTED;
     _lastConnectionFail = millis();
 
     DEBUG_WEBSOCKETS("[WS-Client] client disconnected.\n");
     if(event) {
+        // after the tcp / ssl client is gone, so the heap shows what a reconnect can get
+        MEMORY_WEBSOCKETS(WebSocketsMemory::snapshot(WSmem_disconnect));
         runCbEvent(WStype_DISCONNECTED, NULL, 0);
     }
 }
@@ -618,17 +723,20 @@ void WebSocketsClient::handleClientData(void) {
     }
 
     int len = _client.tcp->available();
-    if(len > 0) {
+    // a partly received frame is also continued without new data, for its timeout
+    if(len > 0 || (_client.status == WSC_CONNECTED && _client.cWsRXsize)) {
         switch(_client.status) {
             case WSC_HEADER: {
-                String headerLine = _client.tcp->readStringUntil('\n');
-                handleHeader(&_client, &headerLine);
+                char headerLine[WEBSOCKETS_HEADER_LINE_MAX];
+                size_t length;
+                if(readHeaderLine(&_client, &headerLine[0], sizeof(headerLine), &length)) {
+                    handleHeaderLine(&_client, &headerLine[0], length);
+                }
             } break;
             case WSC_BODY: {
                 char buf[256] = { 0 };
-                _client.tcp->readBytes(&buf[0], std::min((size_t)len, sizeof(buf)));
-                String bodyLine = buf;
-                handleHeader(&_client, &bodyLine);
+                _client.tcp->readBytes(&buf[0], std::min((size_t)len, sizeof(buf) - 1));
+                handleHeaderLine(&_client, &buf[0], strlen(buf));
             } break;
             case WSC_CONNECTED:
                 WebSockets::handleWebsocket(&_client);
@@ -652,79 +760,114 @@ void WebSocketsClient::sendHeader(WSclient_t * client) {
     DEBUG_WEBSOCKETS("[WS-Client][sendHeader] sending header...\n");
 
     uint8_t randomKey[16] = { 0 };
+    char key[WEBSOCKETS_CLIENT_KEY_SIZE];
 
     for(uint8_t i = 0; i < sizeof(randomKey); i++) {
         randomKey[i] = random(0xFF);
     }
 
-    client->cKey = base64_encode(&randomKey[0], 16);
+    base64_encode(&randomKey[0], sizeof(randomKey), &key[0]);
+
+    // only the expected answer is kept, the key itself is not needed after sending
+    _acceptOk = false;
+    if(!acceptKey(&key[0], strlen(key), &_acceptKey[0])) {
+        _acceptKey[0] = 0;
+    }
 
 #ifndef NODEBUG_WEBSOCKETS
     unsigned long start = micros();
 #endif
 
-    String handshake;
     bool ws_header = true;
-    String url     = client->cUrl;
+    char port[6];
+    snprintf(&port[0], sizeof(port), "%u", _port);
 
-    if(client->isSocketIO) {
-        if(client->cSessionId.length() == 0) {
-            url += WEBSOCKETS_STRING("&transport=polling");
-            ws_header = false;
-        } else {
-            url += WEBSOCKETS_STRING("&transport=websocket&sid=");
-            url += client->cSessionId;
-        }
+    if(client->isSocketIO && client->cSessionId.length() == 0) {
+        ws_header = false;
     }
 
-    handshake = WEBSOCKETS_STRING("GET ");
-    handshake += url + WEBSOCKETS_STRING(
-                           " HTTP/1.1\r\n"
-                           "Host: ");
-    handshake += _host + ":" + _port + NEW_LINE;
-
-    if(ws_header) {
-        handshake += WEBSOCKETS_STRING(
-            "Connection: Upgrade\r\n"
-            "Upgrade: websocket\r\n"
-            "Sec-WebSocket-Version: 13\r\n"
-            "Sec-WebSocket-Key: ");
-        handshake += client->cKey + NEW_LINE;
-
-        if(client->cProtocol.length() > 0) {
-            handshake += WEBSOCKETS_STRING("Sec-WebSocket-Protocol: ");
-            handshake += client->cProtocol + NEW_LINE;
+    // first pass counts, second pass fills the buffer
+    char stack[WEBSOCKETS_HANDSHAKE_SIZE];
+    WSheaderBuffer_t handshake;
+    for(uint8_t pass = 0; pass < 2; pass++) {
+        if(pass) {
+            if(!handshake.begin(&stack[0], sizeof(stack))) {
+                DEBUG_WEBSOCKETS("[WS-Client][sendHeader] not enough memory for the handshake\n");
+                METRICS_WEBSOCKETS(client->metrics.mallocFail++);
+                clientDisconnect(client);
+                return;
+            }
         }
 
-        if(client->cExtensions.length() > 0) {
-            handshake += WEBSOCKETS_STRING("Sec-WebSocket-Extensions: ");
-            handshake += client->cExtensions + NEW_LINE;
+        handshake.add("GET ");
+        handshake.add(client->cUrl);
+        if(client->isSocketIO) {
+            if(client->cSessionId.length() == 0) {
+                handshake.add("&transport=polling");
+            } else {
+                handshake.add("&transport=websocket&sid=");
+                handshake.add(client->cSessionId);
+            }
         }
-    } else {
-        handshake += WEBSOCKETS_STRING("Connection: keep-alive\r\n");
-    }
+        handshake.add(
+            " HTTP/1.1\r\n"
+            "Host: ");
+        handshake.add(_host);
+        handshake.add(":");
+        handshake.add(&port[0]);
+        handshake.add(NEW_LINE);
+
+        if(ws_header) {
+            handshake.add(
+                "Connection: Upgrade\r\n"
+                "Upgrade: websocket\r\n"
+                "Sec-WebSocket-Version: 13\r\n"
+                "Sec-WebSocket-Key: ");
+            handshake.add(&key[0]);
+            handshake.add(NEW_LINE);
+
+            if(client->cProtocol.length() > 0) {
+                handshake.add("Sec-WebSocket-Protocol: ");
+                handshake.add(client->cProtocol);
+                handshake.add(NEW_LINE);
+            }
 
-    // add extra headers; by default this includes "Origin: file://"
-    if(client->extraHeaders.length() > 0) {
-        handshake += client->extraHeaders + NEW_LINE;
-    }
+            if(client->cExtensions.length() > 0) {
+                handshake.add("Sec-WebSocket-Extensions: ");
+                handshake.add(client->cExtensions);
+                handshake.add(NEW_LINE);
+            }
+        } else {
+            handshake.add("Connection: keep-alive\r\n");
+        }
+
+        // add extra headers; by default this includes "Origin: file://"
+        if(client->extraHeaders.length() > 0) {
+            handshake.add(client->extraHeaders);
+            handshake.add(NEW_LINE);
+        }
 
-    handshake += WEBSOCKETS_STRING("User-Agent: arduino-WebSocket-Client\r\n");
+        handshake.add("User-Agent: arduino-WebSocket-Client\r\n");
 
-    if(client->base64Authorization.length() > 0) {
-        handshake += WEBSOCKETS_STRING("Authorization: Basic ");
-        handshake += client->base64Authorization + NEW_LINE;
-    }
+        if(client->base64Authorization.length() > 0) {
+            handshake.add("Authorization: Basic ");
+            handshake.add(client->base64Authorization);
+            handshake.add(NEW_LINE);
+        }
 
-    if(client->plainAuthorization.length() > 0) {
-        handshake += WEBSOCKETS_STRING("Authorization: ");
-        handshake += client->plainAuthorization + NEW_LINE;
-    }
+        if(client->plainAuthorization.length() > 0) {
+            handshake.add("Authorization: ");
+            handshake.add(client->plainAuthorization);
+            handshake.add(NEW_LINE);
+        }
 
-    handshake += NEW_LINE;
+        handshake.add(NEW_LINE);
+    }
+    handshake.buffer[handshake.length] = 0;
 
-    DEBUG_WEBSOCKETS("[WS-Client][sendHeader] handshake %s", (uint8_t *)handshake.c_str());
-    write(client, (uint8_t *)handshake.c_str(), handshake.length());
+    DEBUG_WEBSOCKETS("[WS-Client][sendHeader] handshake %s", handshake.buffer);
+    write(client, (uint8_t *)handshake.buffer, handshake.length);
+    handshake.end();
 
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     client->tcp->readStringUntil('\n', &(client->cHttpLine), std::bind(&WebSocketsClient::handleHeader, this, client, &(client->cHttpLine)));
@@ -737,70 +880,97 @@ void WebSocketsClient::sendHeader(WSclient_t * client) {
 /**
  * handle the WebSocket header reading
  * @param client WSclient_t *  ptr to the client struct
+ * @param headerLine String *  the header line, cleared afterwards
  */
 void WebSocketsClient::handleHeader(WSclient_t * client, String * headerLine) {
-    headerLine->trim();    // remove \r
+    char line[WEBSOCKETS_HEADER_LINE_MAX];
+    size_t length = std::min((size_t)headerLine->length(), sizeof(line) - 1);
+
+    memcpy(&line[0], headerLine->c_str(), length);
+    line[length]  = 0;
+    (*headerLine) = "";
+
+    handleHeaderLine(client, &line[0], length);
+}
+
+/**
+ * handle one http header line, only the values needed for the upgrade are stored
+ * @param client WSclient_t *  ptr to the client struct
+ * @param headerLine char *    null terminated line, modified while parsing
+ * @param length size_t        length of the line
+ */
+void WebSocketsClient::handleHeaderLine(WSclient_t * client, char * headerLine, size_t length) {
+    headerLine = trimHeaderLine(headerLine, &length);    // remove \r
 
     // this code handels the http body for Socket.IO V3 requests
-    if(headerLine->length() > 0 && client->isSocketIO && client->status == WSC_BODY && client->cSessionId.length() == 0) {
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader] socket.io json: %s\n", headerLine->c_str());
-        String sid_begin = WEBSOCKETS_STRING("\"sid\":\"");
-        if(headerLine->indexOf(sid_begin) > -1) {
-            int start          = headerLine->indexOf(sid_begin) + sid_begin.length();
-            int end            = headerLine->indexOf('"', start);
-            client->cSessionId = headerLine->substring(start, end);
+    if(length > 0 && client->isSocketIO && client->status == WSC_BODY && client->cSessionId.length() == 0) {
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader] socket.io json: %s\n", headerLine);
+        char * sid = strstr(headerLine, "\"sid\":\"");
+        if(sid) {
+            sid += 7;
+            char * end = strchr(sid, '"');
+            if(end) {
+                *end = 0;
+            }
+            client->cSessionId = sid;
             DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cSessionId: %s\n", client->cSessionId.c_str());
 
             // Trigger websocket connection code path
-            *headerLine = "";
+            length = 0;
         }
     }
 
     // headle HTTP header
-    if(headerLine->length() > 0) {
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader] RX: %s\n", headerLine->c_str());
+    if(length > 0) {
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader] RX: %s\n", headerLine);
 
-        if(headerLine->startsWith(WEBSOCKETS_STRING("HTTP/1."))) {
+        if(strncmp(headerLine, "HTTP/1.", 7) == 0) {
             // "HTTP/1.1 101 Switching Protocols"
-            client->cCode = headerLine->substring(9, headerLine->indexOf(' ', 9)).toInt();
-        } else if(headerLine->indexOf(':') >= 0) {
-            String headerName  = headerLine->substring(0, headerLine->indexOf(':'));
-            String headerValue = headerLine->substring(headerLine->indexOf(':') + 1);
-
-            // remove space in the beginning  (RFC2616)
-            if(headerValue[0] == ' ') {
-                headerValue.remove(0, 1);
-            }
-
-            if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Connection"))) {
-                if(headerValue.equalsIgnoreCase(WEBSOCKETS_STRING("upgrade"))) {
-                    client->cIsUpgrade = true;
-                }
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Upgrade"))) {
-                if(headerValue.equalsIgnoreCase(WEBSOCKETS_STRING("websocket"))) {
-                    client->cIsWebsocket = true;
-                }
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Accept"))) {
-                client->cAccept = headerValue;
-                client->cAccept.trim();    // see rfc6455
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Protocol"))) {
-                client->cProtocol = headerValue;
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Extensions"))) {
-                client->cExtensions = headerValue;
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Version"))) {
-                client->cVersion = headerValue.toInt();
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Set-Cookie")) && headerValue.indexOf(" io=") > -1) {
-                if(headerValue.indexOf(';') > -1) {
-                    client->cSessionId = headerValue.substring(headerValue.indexOf('=') + 1, headerValue.indexOf(";"));
-                } else {
-                    client->cSessionId = headerValue.substring(headerValue.indexOf('=') + 1);
-                }
-            }
+            client->cCode = (length > 9) ? atoi(headerLine + 9) : 0;
         } else {
-            DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Header error (%s)\n", headerLine->c_str());
+            char * headerValue;
+            switch(parseHeaderLine(headerLine, &headerValue)) {
+                case WSheader_connection:
+                    if(strcasecmp(headerValue, "upgrade") == 0) {
+                        client->cIsUpgrade = true;
+                    }
+                    break;
+                case WSheader_upgrade:
+                    if(strcasecmp(headerValue, "websocket") == 0) {
+                        client->cIsWebsocket = true;
+                    }
+                    break;
+                case WSheader_secWebSocketAccept:
+                    // already trimmed, see rfc6455
+                    _acceptOk = (_acceptKey[0] && strcmp(headerValue, &_acceptKey[0]) == 0);
+                    break;
+                case WSheader_secWebSocketProtocol:
+                    client->cProtocol = headerValue;
+                    break;
+                case WSheader_secWebSocketExtensions:
+                    client->cExtensions = headerValue;
+                    break;
+                case WSheader_secWebSocketVersion:
+                    client->cVersion = atoi(headerValue);
+                    break;
+                case WSheader_setCookie:
+                    if(strstr(headerValue, " io=")) {
+                        char * start = strchr(headerValue, '=') + 1;
+                        char * end   = strchr(start, ';');
+                        if(end) {
+                            *end = 0;
+                        }
+                        client->cSessionId = start;
+                    }
+                    break;
+                case WSheader_invalid:
+                    DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Header error (%s)\n", headerLine);
+                    break;
+                default:
+                    break;
+            }
         }
 
-        (*headerLine) = "";
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
         client->tcp->readStringUntil('\n', &(client->cHttpLine), std::bind(&WebSocketsClient::handleHeader, this, client, &(client->cHttpLine)));
 #endif
@@ -809,13 +979,13 @@ void WebSocketsClient::handleHeader(WSclient_t * client, String * headerLine) {
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Client settings:\n");
 
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cURL: %s\n", client->cUrl.c_str());
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cKey: %s\n", client->cKey.c_str());
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - acceptKey: %s\n", &_acceptKey[0]);
 
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Server header:\n");
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cCode: %d\n", client->cCode);
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cIsUpgrade: %d\n", client->cIsUpgrade);
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cIsWebsocket: %d\n", client->cIsWebsocket);
-        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cAccept: %s\n", client->cAccept.c_str());
+        DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cAccept ok: %d\n", _acceptOk);
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cProtocol: %s\n", client->cProtocol.c_str());
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cExtensions: %s\n", client->cExtensions.c_str());
         DEBUG_WEBSOCKETS("[WS-Client][handleHeader]  - cVersion: %d\n", client->cVersion);
@@ -853,22 +1023,17 @@ void WebSocketsClient::handleHeader(WSclient_t * client, String * headerLine) {
             }
         }
 
-        if(ok) {
-            if(client->cAccept.length() == 0) {
-                ok = false;
-            } else {
-                // generate Sec-WebSocket-Accept key for check
-                String sKey = acceptKey(client->cKey);
-                if(sKey != client->cAccept) {
-                    DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Sec-WebSocket-Accept is wrong\n");
-                    ok = false;
-                }
-            }
+        if(ok && !_acceptOk) {
+            DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Sec-WebSocket-Accept is missing or wrong\n");
+            ok = false;
         }
 
         if(ok) {
             DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Websocket connection init done.\n");
             headerDone(client);
+            _handshakeTime   = millis() - _connectStart;
+            _connectFailures = 0;
+            MEMORY_WEBSOCKETS(WebSocketsMemory::snapshot(WSmem_connect));
 
             runCbEvent(WStype_CONNECTED, (uint8_t *)client->cUrl.c_str(), client->cUrl.length());
 #if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
@@ -948,12 +1113,16 @@ void WebSocketsClient::connectedCb() {
 
 void WebSocketsClient::connectFailedCb() {
     DEBUG_WEBSOCKETS("[WS-Client] connection to %s:%u Failed\n", _host.c_str(), _port);
+    if(_connectFailures < 0xFF) {
+        _connectFailures++;
+    }
 }
 
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
 
 void WebSocketsClient::asyncConnect() {
     DEBUG_WEBSOCKETS("[WS-Client] asyncConnect...\n");
+    _connectStart = millis();
 
     AsyncClient * tcpclient = new AsyncClient();
 
@@ -1001,9 +1170,11 @@ void WebSocketsClient::handleHBPing() {
     if(_client.pingInterval == 0)
         return;
     uint32_t pi = millis() - _client.lastPing;
-    if(pi > _client.pingInterval) {
+    if(pi > heartbeatInterval(&_client)) {
         DEBUG_WEBSOCKETS("[WS-Client] sending HB ping\n");
-        if(sendPing()) {
+        uint8_t payload[WEBSOCKETS_HB_PAYLOAD_SIZE];
+        size_t length = heartbeatPayload(&_client, &payload[0]);
+        if(sendPing(&payload[0], length)) {
             _client.lastPing     = millis();
             _client.pongReceived = false;
         } else {
@@ -1023,6 +1194,25 @@ void WebSocketsClient::enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeo
     WebSockets::enableHeartbeat(&_client, pingInterval, pongTimeout, disconnectTimeoutCount);
 }
 
+/**
+ * derive ping interval and pong timeout from the measured rtt and loss
+ * pingInterval and pongTimeout of enableHeartbeat are the base values
+ * @param enable bool
+ */
+void WebSocketsClient::setAdaptiveHeartbeat(bool enable) {
+    _client.link.adaptive = enable;
+}
+
+/**
+ * rtt and loss measured by the heartbeat pings
+ * @param quality WSlinkQuality_t *
+ */
+void WebSocketsClient::getLinkQuality(WSlinkQuality_t * quality) {
+    if(quality) {
+        linkQuality(&_client, quality);
+    }
+}
+
 /**
  * disable ping/pong heartbeat process
  */
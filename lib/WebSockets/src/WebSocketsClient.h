@@ -79,6 +79,7 @@ class WebSocketsClient : protected WebSockets {
 
 #if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
     void loop(void);
+    void loop(uint32_t budgetUs);
 #else
     // Async interface not need a loop call
     void loop(void) __attribute__((deprecated)) {}
@@ -96,6 +97,8 @@ class WebSocketsClient : protected WebSockets {
     bool sendBIN(uint8_t * payload, size_t length, bool headerToPayload = false);
     bool sendBIN(const uint8_t * payload, size_t length);
 
+    bool sendFragment(WSopcode_t opcode, uint8_t * payload, size_t length, bool fin, bool headerToPayload = false);
+
     bool sendPing(uint8_t * payload = NULL, size_t length = 0);
     bool sendPing(String & payload);
 
@@ -110,8 +113,18 @@ class WebSocketsClient : protected WebSockets {
 
     void enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount);
     void disableHeartbeat();
+    void setAdaptiveHeartbeat(bool enable);
+    void getLinkQuality(WSlinkQuality_t * quality);
 
     bool isConnected(void);
+    uint8_t getConnectFailures(void);
+    unsigned long getHandshakeTime(void);
+    unsigned long getMaxStall(bool reset = false);
+
+#ifdef WEBSOCKETS_METRICS
+    void getMetrics(WSmetrics_t * metrics);
+    void resetMetrics(void);
+#endif
 
   protected:
     String _host;
@@ -154,6 +167,14 @@ class WebSocketsClient : protected WebSockets {
     unsigned long _reconnectInterval;
     unsigned long _lastHeaderSent;
 
+    char _acceptKey[WEBSOCKETS_ACCEPT_KEY_SIZE];    ///< Sec-WebSocket-Accept expected for the last request
+    bool _acceptOk;                                 ///< the server sent _acceptKey
+
+    unsigned long _connectStart;     ///< start of the current connection attempt
+    unsigned long _handshakeTime;    ///< ms from connect to upgrade of the last connection
+    uint8_t _connectFailures;        ///< failed attempts since the last connection
+    unsigned long _maxStall;         ///< us, longest loop() call
+
     void messageReceived(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, bool fin);
 
     void clientDisconnect(WSclient_t * client);
@@ -165,6 +186,7 @@ class WebSocketsClient : protected WebSockets {
 
     void sendHeader(WSclient_t * client);
     void handleHeader(WSclient_t * client, String * headerLine);
+    void handleHeaderLine(WSclient_t * client, char * headerLine, size_t length);
 
     void connectedCb();
     void connectFailedCb();
@@ -0,0 +1,268 @@
+/**
+ * @file WebSocketsMemory.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+
+#include "WebSockets.h"
+
+typedef struct {
+    uint32_t size;
+    uint8_t tag;
+} WSmemBlock_t;
+
+static_assert(sizeof(WSmemBlock_t) <= WEBSOCKETS_MEMORY_HEADER, "WSmemBlock_t does not fit into WEBSOCKETS_MEMORY_HEADER");
+
+static const char * const tagNames[WSmem_count] = { "rx", "tx", "handshake", "json", "app", "http" };
+static const char * const eventNames[WSmem_events] = { "connect", "disconnect", "fail" };
+
+static WebSocketsAllocator defaultAllocator;
+
+WebSocketsAllocator * WebSocketsMemory::_allocator = &defaultAllocator;
+WSmemStats_t WebSocketsMemory::_stats[WSmem_count];
+WSmemSnapshot_t WebSocketsMemory::_snapshots[WSmem_events];
+uint32_t WebSocketsMemory::_lowestBlock = 0;
+
+size_t WebSocketsAllocator::freeHeap() {
+#ifdef GET_FREE_HEAP
+    return GET_FREE_HEAP;
+#else
+    return 0;
+#endif
+}
+
+size_t WebSocketsAllocator::largestFreeBlock() {
+#if defined(ESP32)
+    return ESP.getMaxAllocHeap();
+#elif defined(ESP8266)
+    return ESP.getMaxFreeBlockSize();
+#else
+    // no information about fragmentation
+    return freeHeap();
+#endif
+}
+
+void WebSocketsMemory::setAllocator(WebSocketsAllocator * allocator) {
+    _allocator = allocator ? allocator : &defaultAllocator;
+}
+
+void WebSocketsMemory::count(WSmemTag_t tag, size_t size) {
+    WSmemStats_t * s = &_stats[tag];
+    s->current += size;
+    if(s->current > s->peak) {
+        s->peak = s->current;
+    }
+    if(size > s->largest) {
+        s->largest = size;
+    }
+    s->allocs++;
+}
+
+/**
+ * malloc with accounting
+ * @param size size_t
+ * @param tag WSmemTag_t
+ * @return the memory or NULL, a failure takes a WSmem_fail snapshot
+ */
+void * WebSocketsMemory::allocate(size_t size, WSmemTag_t tag) {
+    uint8_t * block = (uint8_t *)_allocator->allocate(size + WEBSOCKETS_MEMORY_HEADER);
+    if(!block) {
+        track(tag, size, false);
+        return NULL;
+    }
+
+    WSmemBlock_t * header = (WSmemBlock_t *)block;
+    header->size          = size;
+    header->tag           = tag;
+    count(tag, size);
+    return block + WEBSOCKETS_MEMORY_HEADER;
+}
+
+/**
+ * realloc with accounting, the block moves to tag
+ * @param ptr void *  from allocate() or NULL
+ * @param size size_t
+ * @param tag WSmemTag_t
+ * @return the memory or NULL, ptr stays valid then
+ */
+void * WebSocketsMemory::reallocate(void * ptr, size_t size, WSmemTag_t tag) {
+    if(!ptr) {
+        return allocate(size, tag);
+    }
+
+    uint8_t * block   = (uint8_t *)ptr - WEBSOCKETS_MEMORY_HEADER;
+    uint32_t oldSize  = ((WSmemBlock_t *)block)->size;
+    WSmemTag_t oldTag = (WSmemTag_t)((WSmemBlock_t *)block)->tag;
+
+    block = (uint8_t *)_allocator->reallocate(block, size + WEBSOCKETS_MEMORY_HEADER);
+    if(!block) {
+        track(tag, size, false);
+        return NULL;
+    }
+
+    _stats[oldTag].current -= oldSize;
+    WSmemBlock_t * header = (WSmemBlock_t *)block;
+    header->size          = size;
+    header->tag           = tag;
+    count(tag, size);
+    return block + WEBSOCKETS_MEMORY_HEADER;
+}
+
+/**
+ * free for memory of allocate() / reallocate()
+ * @param ptr void *  NULL is ignored
+ */
+void WebSocketsMemory::release(void * ptr) {
+    if(!ptr) {
+        return;
+    }
+    uint8_t * block       = (uint8_t *)ptr - WEBSOCKETS_MEMORY_HEADER;
+    WSmemBlock_t * header = (WSmemBlock_t *)block;
+    _stats[header->tag].current -= header->size;
+    _allocator->release(block);
+}
+
+/**
+ * count memory that was allocated somewhere else (e.g. a String), it is not held in current
+ * @param tag WSmemTag_t
+ * @param size size_t
+ * @param ok bool  false: the allocation failed
+ */
+void WebSocketsMemory::track(WSmemTag_t tag, size_t size, bool ok) {
+    WSmemStats_t * s = &_stats[tag];
+    if(ok) {
+        if(size > s->largest) {
+            s->largest = size;
+        }
+        s->allocs++;
+        return;
+    }
+    if(s->fails != 0xFFFF) {
+        s->fails++;
+    }
+    snapshot(WSmem_fail);
+}
+
+/**
+ * remember the heap state, called by the library on connect and disconnect
+ * @param event WSmemEvent_t
+ */
+void WebSocketsMemory::snapshot(WSmemEvent_t event) {
+    WSmemSnapshot_t * s = &_snapshots[event];
+    s->time             = millis();
+    if(s->time == 0) {
+        s->time = 1;
+    }
+    s->freeHeap     = _allocator->freeHeap();
+    s->largestBlock = _allocator->largestFreeBlock();
+    s->held         = held();
+
+    if(_lowestBlock == 0 || s->largestBlock < _lowestBlock) {
+        _lowestBlock = s->largestBlock;
+    }
+}
+
+uint32_t WebSocketsMemory::held() {
+    uint32_t bytes = 0;
+    for(uint8_t i = 0; i < WSmem_count; i++) {
+        bytes += _stats[i].current;
+    }
+    return bytes;
+}
+
+/**
+ * start a new measurement: peaks go down to what is held now, snapshots and failures are kept
+ */
+void WebSocketsMemory::resetPeaks() {
+    for(uint8_t i = 0; i < WSmem_count; i++) {
+        _stats[i].peak    = _stats[i].current;
+        _stats[i].largest = 0;
+    }
+    _lowestBlock = 0;
+}
+
+/**
+ * appends to a fixed buffer, remembers if it did not fit
+ */
+typedef struct {
+    char * buffer;
+    size_t size;
+    size_t length;
+    bool overflow;
+} WSmemJson_t;
+
+static void jsonAdd(WSmemJson_t * json, const char * format, ...) {
+    if(json->overflow) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(json->buffer + json->length, json->size - json->length, format, args);
+    va_end(args);
+    if(len < 0 || (size_t)len >= (json->size - json->length)) {
+        json->overflow = true;
+        return;
+    }
+    json->length += len;
+}
+
+/**
+ * JSON report, 560 - 1000 Byte
+ * {"v":1,"free":..,"block":..,"lowestBlock":..,"held":..,
+ *  "tags":{"rx":{"cur":..,"peak":..,"largest":..,"allocs":..,"fails":..},...},
+ *  "connect":{"t":..,"free":..,"block":..,"held":..},"disconnect":{..},"fail":{..}}
+ * free / block are the heap now, snapshots not taken yet are left out
+ * @param buffer char *
+ * @param size size_t
+ * @return length of the JSON (without null), 0 if the buffer is to small
+ */
+size_t WebSocketsMemory::toJson(char * buffer, size_t size) {
+    WSmemJson_t json = { buffer, size, 0, (size == 0) };
+
+    jsonAdd(&json, "{\"v\":%u,\"free\":%lu,\"block\":%lu,\"lowestBlock\":%lu,\"held\":%lu,\"tags\":{", WEBSOCKETS_MEMORY_VERSION,
+        (unsigned long)_allocator->freeHeap(), (unsigned long)_allocator->largestFreeBlock(), (unsigned long)_lowestBlock, (unsigned long)held());
+    for(uint8_t i = 0; i < WSmem_count; i++) {
+        const WSmemStats_t * s = &_stats[i];
+        jsonAdd(&json, "%s\"%s\":{\"cur\":%lu,\"peak\":%lu,\"largest\":%lu,\"allocs\":%lu,\"fails\":%u}", (i ? "," : ""), tagNames[i],
+            (unsigned long)s->current, (unsigned long)s->peak, (unsigned long)s->largest, (unsigned long)s->allocs, s->fails);
+    }
+    jsonAdd(&json, "}");
+    for(uint8_t i = 0; i < WSmem_events; i++) {
+        const WSmemSnapshot_t * s = &_snapshots[i];
+        if(s->time == 0) {
+            continue;
+        }
+        jsonAdd(&json, ",\"%s\":{\"t\":%lu,\"free\":%lu,\"block\":%lu,\"held\":%lu}", eventNames[i],
+            (unsigned long)s->time, (unsigned long)s->freeHeap, (unsigned long)s->largestBlock, (unsigned long)s->held);
+    }
+    jsonAdd(&json, "}");
+
+    if(json.overflow) {
+        if(size) {
+            buffer[0] = 0;
+        }
+        return 0;
+    }
+    return json.length;
+}
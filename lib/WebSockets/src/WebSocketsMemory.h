@@ -0,0 +1,154 @@
+/**
+ * @file WebSocketsMemory.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef WEBSOCKETSMEMORY_H_
+#define WEBSOCKETSMEMORY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#define WEBSOCKETS_MEMORY_VERSION (1)    ///< version of the JSON report
+
+#define WEBSOCKETS_MEMORY_HEADER (8)    ///< size and tag in front of every block, keeps 8 byte alignment
+
+/**
+ * who holds the memory, the order is the order of the report
+ */
+typedef enum {
+    WSmem_rx,           ///< payload of the frame being received
+    WSmem_tx,           ///< frames copied for sending (header + payload, masking)
+    WSmem_handshake,    ///< http header and base64 buffers
+    WSmem_json,         ///< JSON documents of the application
+    WSmem_app,          ///< other application buffers
+    WSmem_http,         ///< HttpClient response bodies, see track()
+    WSmem_count
+} WSmemTag_t;
+
+typedef enum {
+    WSmem_connect,
+    WSmem_disconnect,
+    WSmem_fail,    ///< an allocation failed
+    WSmem_events
+} WSmemEvent_t;
+
+typedef struct {
+    uint32_t current;    ///< bytes held now
+    uint32_t peak;       ///< high water mark of current
+    uint32_t largest;    ///< largest single allocation
+    uint32_t allocs;
+    uint16_t fails;
+} WSmemStats_t;
+
+/**
+ * heap at an event, largestBlock is what the next malloc can get at most
+ */
+typedef struct {
+    uint32_t time;    ///< millis, 0 = not taken yet
+    uint32_t freeHeap;
+    uint32_t largestBlock;
+    uint32_t held;    ///< bytes held in all tags
+} WSmemSnapshot_t;
+
+/**
+ * where the accounted memory comes from, override it to use another heap
+ * (e.g. PSRAM) or to drive the accounting from a host test.
+ * freeHeap() and largestFreeBlock() return 0 if the platform can not tell.
+ */
+class WebSocketsAllocator {
+  public:
+    virtual ~WebSocketsAllocator() {}
+
+    virtual void * allocate(size_t size) {
+        return malloc(size);
+    }
+
+    virtual void * reallocate(void * ptr, size_t size) {
+        return realloc(ptr, size);
+    }
+
+    virtual void release(void * ptr) {
+        free(ptr);
+    }
+
+    virtual size_t freeHeap();
+    virtual size_t largestFreeBlock();
+};
+
+/**
+ * tagged allocations with current / peak bytes per tag and heap snapshots.
+ * blocks of allocate() must go back with release(), not free().
+ * not thread safe, use it from the task that runs loop().
+ */
+class WebSocketsMemory {
+  public:
+    /**
+     * only change it while no block is allocated, NULL restores malloc
+     * @param allocator WebSocketsAllocator *
+     */
+    static void setAllocator(WebSocketsAllocator * allocator);
+
+    static void * allocate(size_t size, WSmemTag_t tag);
+    static void * reallocate(void * ptr, size_t size, WSmemTag_t tag);
+    static void release(void * ptr);
+
+    static void track(WSmemTag_t tag, size_t size, bool ok);
+    static void snapshot(WSmemEvent_t event);
+
+    static const WSmemStats_t * stats(WSmemTag_t tag) {
+        return &_stats[tag];
+    }
+
+    static const WSmemSnapshot_t * lastSnapshot(WSmemEvent_t event) {
+        return &_snapshots[event];
+    }
+
+    static uint32_t held();
+    static void resetPeaks();
+
+    static size_t toJson(char * buffer, size_t size);
+
+  private:
+    static WebSocketsAllocator * _allocator;
+    static WSmemStats_t _stats[WSmem_count];
+    static WSmemSnapshot_t _snapshots[WSmem_events];
+    static uint32_t _lowestBlock;    ///< smallest largestBlock of all snapshots, 0 = none
+
+    static void count(WSmemTag_t tag, size_t size);
+};
+
+#ifdef WEBSOCKETS_MEMORY
+#define WEBSOCKETS_MALLOC(size, tag) WebSocketsMemory::allocate((size), (tag))
+#define WEBSOCKETS_REALLOC(ptr, size, tag) WebSocketsMemory::reallocate((ptr), (size), (tag))
+#define WEBSOCKETS_FREE(ptr) WebSocketsMemory::release(ptr)
+#define MEMORY_WEBSOCKETS(...) \
+    { __VA_ARGS__; }
+#else
+#define WEBSOCKETS_MALLOC(size, tag) malloc(size)
+#define WEBSOCKETS_REALLOC(ptr, size, tag) realloc((ptr), (size))
+#define WEBSOCKETS_FREE(ptr) free(ptr)
+#define MEMORY_WEBSOCKETS(...)
+#endif
+
+#endif /* WEBSOCKETSMEMORY_H_ */
@@ -0,0 +1,185 @@
+/**
+ * @file WebSocketsMetrics.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+
+#include "WebSocketsMetrics.h"
+
+/**
+ * appends to a fixed buffer, remembers if it did not fit
+ */
+typedef struct {
+    char * buffer;
+    size_t size;
+    size_t length;
+    bool overflow;
+} WSmetricsJson_t;
+
+static void jsonAdd(WSmetricsJson_t * json, const char * format, ...) {
+    if(json->overflow) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(json->buffer + json->length, json->size - json->length, format, args);
+    va_end(args);
+    if(len < 0 || (size_t)len >= (json->size - json->length)) {
+        json->overflow = true;
+        return;
+    }
+    json->length += len;
+}
+
+static void jsonArray32(WSmetricsJson_t * json, const char * name, const uint32_t * values, size_t count) {
+    jsonAdd(json, "\"%s\":[", name);
+    for(size_t i = 0; i < count; i++) {
+        jsonAdd(json, (i ? ",%lu" : "%lu"), (unsigned long)values[i]);
+    }
+    jsonAdd(json, "]");
+}
+
+static void jsonArray16(WSmetricsJson_t * json, const char * name, const uint16_t * values, size_t count) {
+    jsonAdd(json, "\"%s\":[", name);
+    for(size_t i = 0; i < count; i++) {
+        jsonAdd(json, (i ? ",%u" : "%u"), values[i]);
+    }
+    jsonAdd(json, "]");
+}
+
+/**
+ * compact JSON export, arrays by opcode are ordered like WSmetricOpcode_t (cont, text, bin, close, ping, pong)
+ * {"v":1,"in":{"frames":[..],"bytes":[..]},"out":{..},"mallocFail":0,"readTimeout":0,"writeTimeout":0,
+ *  "connects":1,"close":[1000..1011],"closeOther":0,"closeRemote":0,"lastRemoteClose":0,
+ *  "size":[..],"writeUs":[..],"rttMs":[..]}
+ * 385 - 869 Byte, a WEBSOCKETS_METRICS_JSON_SIZE buffer always fits
+ * @param m const WSmetrics_t *
+ * @param buffer char *
+ * @param size size_t
+ * @return length of the JSON (without null), 0 if the buffer is to small
+ */
+size_t WebSocketsMetrics::toJson(const WSmetrics_t * m, char * buffer, size_t size) {
+    WSmetricsJson_t json = { buffer, size, 0, (size == 0) };
+
+    jsonAdd(&json, "{\"v\":%u,\"in\":{", WEBSOCKETS_METRICS_VERSION);
+    jsonArray32(&json, "frames", m->framesIn, WSmetric_count);
+    jsonAdd(&json, ",");
+    jsonArray32(&json, "bytes", m->bytesIn, WSmetric_count);
+    jsonAdd(&json, "},\"out\":{");
+    jsonArray32(&json, "frames", m->framesOut, WSmetric_count);
+    jsonAdd(&json, ",");
+    jsonArray32(&json, "bytes", m->bytesOut, WSmetric_count);
+    jsonAdd(&json, "},\"mallocFail\":%u,\"readTimeout\":%u,\"writeTimeout\":%u,\"connects\":%u,", m->mallocFail, m->readTimeout, m->writeTimeout, m->connects);
+    jsonArray16(&json, "close", m->close, WEBSOCKETS_METRICS_CLOSE_CODES);
+    jsonAdd(&json, ",\"closeOther\":%u,\"closeRemote\":%u,\"lastRemoteClose\":%u,", m->closeOther, m->closeRemote, m->lastRemoteClose);
+    jsonArray16(&json, "size", m->frameSize, WEBSOCKETS_METRICS_BUCKETS);
+    jsonAdd(&json, ",");
+    jsonArray16(&json, "writeUs", m->writeBlock, WEBSOCKETS_METRICS_BUCKETS);
+    jsonAdd(&json, ",");
+    jsonArray16(&json, "rttMs", m->pingRtt, WEBSOCKETS_METRICS_BUCKETS);
+    jsonAdd(&json, "}");
+
+    if(json.overflow) {
+        if(size) {
+            buffer[0] = 0;
+        }
+        return 0;
+    }
+    return json.length;
+}
+
+static uint8_t * put16(uint8_t * p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    return p + 2;
+}
+
+static uint8_t * put32(uint8_t * p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+    return p + 4;
+}
+
+/**
+ * binary export, little endian, WEBSOCKETS_METRICS_BINARY_SIZE byte
+ *   u8 version, u8 opcodes, u8 close codes, u8 buckets
+ *   u32 framesIn[], framesOut[], bytesIn[], bytesOut[]
+ *   u16 mallocFail, readTimeout, writeTimeout, connects
+ *   u16 close[], closeOther, closeRemote, lastRemoteClose
+ *   u16 frameSize[], writeBlock[], pingRtt[]
+ * @param m const WSmetrics_t *
+ * @param buffer uint8_t *
+ * @param size size_t
+ * @return length, 0 if the buffer is to small
+ */
+size_t WebSocketsMetrics::toBinary(const WSmetrics_t * m, uint8_t * buffer, size_t size) {
+    if(size < WEBSOCKETS_METRICS_BINARY_SIZE) {
+        return 0;
+    }
+
+    uint8_t * p = buffer;
+    *p++        = WEBSOCKETS_METRICS_VERSION;
+    *p++        = WSmetric_count;
+    *p++        = WEBSOCKETS_METRICS_CLOSE_CODES;
+    *p++        = WEBSOCKETS_METRICS_BUCKETS;
+
+    for(uint8_t i = 0; i < WSmetric_count; i++) {
+        p = put32(p, m->framesIn[i]);
+    }
+    for(uint8_t i = 0; i < WSmetric_count; i++) {
+        p = put32(p, m->framesOut[i]);
+    }
+    for(uint8_t i = 0; i < WSmetric_count; i++) {
+        p = put32(p, m->bytesIn[i]);
+    }
+    for(uint8_t i = 0; i < WSmetric_count; i++) {
+        p = put32(p, m->bytesOut[i]);
+    }
+
+    p = put16(p, m->mallocFail);
+    p = put16(p, m->readTimeout);
+    p = put16(p, m->writeTimeout);
+    p = put16(p, m->connects);
+
+    for(uint8_t i = 0; i < WEBSOCKETS_METRICS_CLOSE_CODES; i++) {
+        p = put16(p, m->close[i]);
+    }
+    p = put16(p, m->closeOther);
+    p = put16(p, m->closeRemote);
+    p = put16(p, m->lastRemoteClose);
+
+    for(uint8_t i = 0; i < WEBSOCKETS_METRICS_BUCKETS; i++) {
+        p = put16(p, m->frameSize[i]);
+    }
+    for(uint8_t i = 0; i < WEBSOCKETS_METRICS_BUCKETS; i++) {
+        p = put16(p, m->writeBlock[i]);
+    }
+    for(uint8_t i = 0; i < WEBSOCKETS_METRICS_BUCKETS; i++) {
+        p = put16(p, m->pingRtt[i]);
+    }
+
+    return (p - buffer);
+}
@@ -0,0 +1,151 @@
+/**
+ * @file WebSocketsMetrics.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef WEBSOCKETSMETRICS_H_
+#define WEBSOCKETSMETRICS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define WEBSOCKETS_METRICS_VERSION (1)    ///< version of the binary export
+
+#define WEBSOCKETS_METRICS_BUCKETS (16)    ///< log2 histogram buckets, bucket 0 = 0, bucket n = [2^(n-1), 2^n)
+
+#define WEBSOCKETS_METRICS_CLOSE_FIRST (1000)
+#define WEBSOCKETS_METRICS_CLOSE_CODES (12)    ///< close codes 1000 - 1011, others are counted in closeOther
+
+typedef enum {
+    WSmetric_continuation,
+    WSmetric_text,
+    WSmetric_binary,
+    WSmetric_close,
+    WSmetric_ping,
+    WSmetric_pong,
+    WSmetric_count
+} WSmetricOpcode_t;
+
+typedef struct {
+    uint32_t framesIn[WSmetric_count];
+    uint32_t framesOut[WSmetric_count];
+    uint32_t bytesIn[WSmetric_count];     ///< payload bytes
+    uint32_t bytesOut[WSmetric_count];    ///< payload bytes
+
+    uint16_t mallocFail;
+    uint16_t readTimeout;
+    uint16_t writeTimeout;
+    uint16_t connects;    ///< successful handshakes, connects - 1 are reconnects
+
+    uint16_t close[WEBSOCKETS_METRICS_CLOSE_CODES];    ///< local disconnects by close code
+    uint16_t closeOther;
+    uint16_t closeRemote;    ///< close frames received
+    uint16_t lastRemoteClose;
+
+    uint32_t pingSent;    ///< millis of the last ping without pong, 0 = none
+
+    uint16_t frameSize[WEBSOCKETS_METRICS_BUCKETS];     ///< byte, rx and tx
+    uint16_t writeBlock[WEBSOCKETS_METRICS_BUCKETS];    ///< us one write() blocked
+    uint16_t pingRtt[WEBSOCKETS_METRICS_BUCKETS];       ///< ms
+} WSmetrics_t;
+
+// size of the binary export
+#define WEBSOCKETS_METRICS_BINARY_SIZE (4 + (4 * WSmetric_count * 4) + (4 * 2) + ((WEBSOCKETS_METRICS_CLOSE_CODES + 3) * 2) + (3 * WEBSOCKETS_METRICS_BUCKETS * 2))
+
+// buffer for toJson() that always fits, every counter at its maximum is 869 byte + null
+#define WEBSOCKETS_METRICS_JSON_SIZE (928)
+
+/**
+ * counters and log2 histograms per connection
+ * updates are a few adds, the histograms saturate instead of wrapping.
+ */
+class WebSocketsMetrics {
+  public:
+    static uint8_t bucket(uint32_t value) {
+        if(value == 0) {
+            return 0;
+        }
+        uint8_t b = 32 - __builtin_clz(value);
+        return (b < WEBSOCKETS_METRICS_BUCKETS) ? b : (WEBSOCKETS_METRICS_BUCKETS - 1);
+    }
+
+    static void count(uint16_t * histogram, uint32_t value) {
+        uint16_t * c = &histogram[bucket(value)];
+        if(*c != 0xFFFF) {
+            (*c)++;
+        }
+    }
+
+    static uint8_t opcode(uint8_t opcode) {
+        switch(opcode) {
+            case 0x1:
+                return WSmetric_text;
+            case 0x2:
+                return WSmetric_binary;
+            case 0x8:
+                return WSmetric_close;
+            case 0x9:
+                return WSmetric_ping;
+            case 0xA:
+                return WSmetric_pong;
+            default:
+                return WSmetric_continuation;
+        }
+    }
+
+    static void frameIn(WSmetrics_t * m, uint8_t op, size_t length) {
+        m->framesIn[opcode(op)]++;
+        m->bytesIn[opcode(op)] += length;
+        count(m->frameSize, length);
+    }
+
+    static void frameOut(WSmetrics_t * m, uint8_t op, size_t length) {
+        m->framesOut[opcode(op)]++;
+        m->bytesOut[opcode(op)] += length;
+        count(m->frameSize, length);
+    }
+
+    static void closeCode(WSmetrics_t * m, uint16_t code) {
+        if(code >= WEBSOCKETS_METRICS_CLOSE_FIRST && code < WEBSOCKETS_METRICS_CLOSE_FIRST + WEBSOCKETS_METRICS_CLOSE_CODES) {
+            m->close[code - WEBSOCKETS_METRICS_CLOSE_FIRST]++;
+        } else {
+            m->closeOther++;
+        }
+    }
+
+    static void reset(WSmetrics_t * m) {
+        memset(m, 0x00, sizeof(WSmetrics_t));
+    }
+
+    static size_t toJson(const WSmetrics_t * m, char * buffer, size_t size);
+    static size_t toBinary(const WSmetrics_t * m, uint8_t * buffer, size_t size);
+};
+
+#ifdef WEBSOCKETS_METRICS
+#define METRICS_WEBSOCKETS(...) \
+    { __VA_ARGS__; }
+#else
+#define METRICS_WEBSOCKETS(...)
+#endif
+
+#endif /* WEBSOCKETSMETRICS_H_ */
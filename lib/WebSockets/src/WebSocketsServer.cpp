@@ -33,13 +33,38 @@
 #endif    // defined __has_include
 #endif
 
-WebSocketsServerCore::WebSocketsServerCore(const String & origin, const String & protocol) {
+#define WS_TOPIC_TOMBSTONE (1)
+
+/**
+ * FNV-1a step, used to hash topic names incrementally
+ */
+static inline uint32_t topicHashStep(uint32_t hash, char c) {
+    return (hash ^ (uint8_t)c) * 16777619UL;
+}
+
+/**
+ * finish a topic hash so it never collides with the free / tombstone markers
+ */
+static inline uint32_t topicHashFinal(uint32_t hash) {
+    return (hash > WS_TOPIC_TOMBSTONE) ? hash : (hash + WS_TOPIC_TOMBSTONE + 1);
+}
+
+WebSocketsServerCore::WebSocketsServerCore(const String & origin, const String & protocol)
+    : _timers(_timerNodes, WEBSOCKETS_SERVER_CLIENT_MAX * WStimer_count) {
     _origin                 = origin;
     _protocol               = protocol;
     _runnning               = false;
     _pingInterval           = 0;
     _pongTimeout            = 0;
     _disconnectTimeoutCount = 0;
+    _adaptiveHeartbeat      = false;
+    _wildcardTopics         = 0;
+    _topicTombstones        = 0;
+    _nextClient             = 0;
+    _loopBudget             = WEBSOCKETS_SERVER_LOOP_BUDGET;
+    _maxStall               = 0;
+    _framesPerLoop          = WEBSOCKETS_SERVER_FRAMES_PER_LOOP;
+    _bytesPerLoop           = WEBSOCKETS_SERVER_BYTES_PER_LOOP;
 
     _cbEvent = NULL;
 
@@ -121,6 +146,16 @@ void WebSocketsServerCore::close(void) {
     for(int i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
         _clients[i] = WSclient_t();
     }
+
+    for(uint16_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX * WStimer_count; i++) {
+        _timers.cancel(i);
+    }
+
+    for(int i = 0; i < WEBSOCKETS_SERVER_TOPIC_MAX; i++) {
+        _topics[i] = WStopic_t();
+    }
+    _wildcardTopics  = 0;
+    _topicTombstones = 0;
 }
 
 /**
@@ -330,6 +365,163 @@ bool WebSocketsServerCore::broadcastPing(String & payload) {
     return broadcastPing((uint8_t *)payload.c_str(), payload.length());
 }
 
+/**
+ * subscribe a client to a topic
+ * a topic ending with "/" and '*' matches every topic below that path,
+ * a topic of only '*' matches every topic
+ * @param num uint8_t client id
+ * @param topic const char *
+ * @return true if ok
+ */
+bool WebSocketsServerCore::subscribe(uint8_t num, const char * topic) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX || !topic || !*topic) {
+        return false;
+    }
+
+    uint32_t hash = 2166136261UL;
+    size_t length = 0;
+    for(; topic[length]; length++) {
+        hash = topicHashStep(hash, topic[length]);
+    }
+
+    WStopic_t * entry = findTopic(topic, length, false, topicHashFinal(hash), true);
+    if(!entry) {
+        DEBUG_WEBSOCKETS("[WS-Server][%d] topic table full, can not subscribe to %s\n", num, topic);
+        return false;
+    }
+
+    entry->subscribers[num / 8] |= bit(num % 8);
+    return true;
+}
+
+/**
+ * check if a client is subscribed to exactly this topic (wildcards are not expanded)
+ * @param num uint8_t client id
+ * @param topic const char *
+ * @return true if subscribed
+ */
+bool WebSocketsServerCore::isSubscribed(uint8_t num, const char * topic) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX || !topic || !*topic) {
+        return false;
+    }
+
+    uint32_t hash = 2166136261UL;
+    size_t length = 0;
+    for(; topic[length]; length++) {
+        hash = topicHashStep(hash, topic[length]);
+    }
+
+    WStopic_t * entry = findTopic(topic, length, false, topicHashFinal(hash), false);
+    return entry && (entry->subscribers[num / 8] & bit(num % 8));
+}
+
+/**
+ * unsubscribe a client from a topic
+ * @param num uint8_t client id
+ * @param topic const char *
+ * @return true if the client was subscribed
+ */
+bool WebSocketsServerCore::unsubscribe(uint8_t num, const char * topic) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX || !topic || !*topic) {
+        return false;
+    }
+
+    uint32_t hash = 2166136261UL;
+    size_t length = 0;
+    for(; topic[length]; length++) {
+        hash = topicHashStep(hash, topic[length]);
+    }
+
+    WStopic_t * entry = findTopic(topic, length, false, topicHashFinal(hash), false);
+    if(!entry || !(entry->subscribers[num / 8] & bit(num % 8))) {
+        return false;
+    }
+
+    removeSubscriber(entry, num);
+    if(_topicTombstones >= WEBSOCKETS_SERVER_TOPIC_TOMBSTONES) {
+        rehashTopics();
+    }
+    return true;
+}
+
+/**
+ * clear the subscriber bit, frees the slot with the last subscriber
+ * @param entry WStopic_t *
+ * @param num uint8_t client id
+ */
+void WebSocketsServerCore::removeSubscriber(WStopic_t * entry, uint8_t num) {
+    entry->subscribers[num / 8] &= ~bit(num % 8);
+
+    for(size_t i = 0; i < sizeof(entry->subscribers); i++) {
+        if(entry->subscribers[i]) {
+            return;
+        }
+    }
+
+    // last subscriber gone, free the slot
+    if(entry->name.endsWith("*")) {
+        _wildcardTopics--;
+    }
+    entry->hash = WS_TOPIC_TOMBSTONE;
+    entry->name = "";
+    _topicTombstones++;
+}
+
+/**
+ * remove a client from all topics (called on disconnect)
+ * @param num uint8_t client id
+ */
+void WebSocketsServerCore::unsubscribeAll(uint8_t num) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
+        return;
+    }
+    for(uint16_t i = 0; i < WEBSOCKETS_SERVER_TOPIC_MAX; i++) {
+        WStopic_t * entry = &_topics[i];
+        if(entry->hash > WS_TOPIC_TOMBSTONE && (entry->subscribers[num / 8] & bit(num % 8))) {
+            removeSubscriber(entry, num);
+        }
+    }
+    if(_topicTombstones >= WEBSOCKETS_SERVER_TOPIC_TOMBSTONES) {
+        rehashTopics();
+    }
+}
+
+/**
+ * send text data to all clients subscribed to the topic
+ * the frame is encoded once and the same bytes are written to every subscriber
+ * @param topic const char *
+ * @param payload uint8_t *
+ * @param length size_t
+ * @param headerToPayload bool  (see sendFrame for more details)
+ * @return number of clients the message was sent to
+ */
+int WebSocketsServerCore::publish(const char * topic, uint8_t * payload, size_t length, bool headerToPayload) {
+    if(length == 0) {
+        length = strlen((const char *)(payload + (headerToPayload ? WEBSOCKETS_MAX_HEADER_SIZE : 0)));
+    }
+    return publishFrame(topic, WSop_text, payload, length, headerToPayload);
+}
+
+int WebSocketsServerCore::publish(const char * topic, const char * payload, size_t length) {
+    return publish(topic, (uint8_t *)payload, length);
+}
+
+int WebSocketsServerCore::publish(const char * topic, String & payload) {
+    return publish(topic, (uint8_t *)payload.c_str(), payload.length());
+}
+
+/**
+ * send binary data to all clients subscribed to the topic
+ * @param topic const char *
+ * @param payload uint8_t *
+ * @param length size_t
+ * @param headerToPayload bool  (see sendFrame for more details)
+ * @return number of clients the message was sent to
+ */
+int WebSocketsServerCore::publishBIN(const char * topic, uint8_t * payload, size_t length, bool headerToPayload) {
+    return publishFrame(topic, WSop_binary, payload, length, headerToPayload);
+}
+
 /**
  * disconnect all clients
  */
@@ -411,7 +603,7 @@ bool WebSocketsServerCore::clientIsConnected(uint8_t num) {
     return clientIsConnected(client);
 }
 
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_RP2040)
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_RP2040) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_CUSTOM)
 /**
  * get an IP for a client
  * @param num uint8_t client id
@@ -492,8 +684,15 @@ WSclient_t * WebSocketsServerCore::newClient(WEBSOCKETS_NETWORK_CLASS * TCPclien
             client->pingInterval           = _pingInterval;
             client->pongTimeout            = _pongTimeout;
             client->disconnectTimeoutCount = _disconnectTimeoutCount;
+            client->link.adaptive          = _adaptiveHeartbeat;
             client->lastPing               = millis();
             client->pongReceived           = false;
+            client->pongTimeoutCount       = 0;
+            client->serviceCount           = 0;
+            client->rxBytes                = 0;
+            METRICS_WEBSOCKETS(WebSocketsMetrics::reset(&client->metrics));
+
+            scheduleTimer(client, WStimer_handshake, WEBSOCKETS_SERVER_HANDSHAKE_TIMEOUT);
 
             return client;
             break;
@@ -526,7 +725,9 @@ void WebSocketsServerCore::messageReceived(WSclient_t * client, WSopcode_t opcod
             type = WStype_PING;
             break;
         case WSop_pong:
-            type = WStype_PONG;
+            type                     = WStype_PONG;
+            client->pongTimeoutCount = 0;
+            cancelTimer(client, WStimer_pong);
             break;
         case WSop_close:
         default:
@@ -588,16 +789,21 @@ void WebSocketsServerCore::clientDisconnect(WSclient_t * client) {
     client->cIsUpgrade   = false;
     client->cIsWebsocket = false;
 
-    client->cWsRXsize = 0;
+    dropFrame(client);
 
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     client->cHttpLine = "";
-#endif
 
     client->status = WSC_NOT_CONNECTED;
 
+    unsubscribeAll(client->num);
+
+    cancelTimer(client, WStimer_ping);
+    cancelTimer(client, WStimer_pong);
+    cancelTimer(client, WStimer_handshake);
+
     DEBUG_WEBSOCKETS("[WS-Server][%d] client disconnected.\n", client->num);
 
+    MEMORY_WEBSOCKETS(WebSocketsMemory::snapshot(WSmem_disconnect));
     runCbEvent(client->num, WStype_DISCONNECTED, NULL, 0);
 }
 
@@ -666,7 +872,7 @@ WSclient_t * WebSocketsServerCore::handleNewClient(WEBSOCKETS_NETWORK_CLASS * tc
  * Handle incoming Connection Request
  */
 void WebSocketsServer::handleNewClients(void) {
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_RP2040)
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_RP2040) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_CUSTOM)
     while(_server->hasClient()) {
 #endif
 
@@ -684,26 +890,52 @@ void WebSocketsServer::handleNewClients(void) {
 
         handleNewClient(tcpClient);
 
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_RP2040)
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_RP2040) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_CUSTOM)
     }
 #endif
 }
 
 /**
  * Handel incomming data from Client
+ * clients are served round robin, the first client changes every loop.
+ * each client may use _framesPerLoop frames / _bytesPerLoop bytes per loop,
+ * no new client is started when budgetUs is used up, the next loop starts with the first one skipped.
+ * frames are read as far as the data is there and continued in the next loop.
+ * @param budgetUs uint32_t  us, 0 = no limit
  */
-void WebSocketsServerCore::handleClientData(void) {
+void WebSocketsServerCore::handleClientData(uint32_t budgetUs) {
     WSclient_t * client;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
+    unsigned long start = micros();
+    uint8_t first       = _nextClient;
+
+    // a full pass rotates the start by one
+    _nextClient = (_nextClient + 1) % WEBSOCKETS_SERVER_CLIENT_MAX;
+
+    for(uint8_t n = 0; n < WEBSOCKETS_SERVER_CLIENT_MAX; n++) {
+        if(budgetUs && (micros() - start) > budgetUs) {
+            // the next loop starts with the first client that was skipped
+            _nextClient = (first + n) % WEBSOCKETS_SERVER_CLIENT_MAX;
+            DEBUG_WEBSOCKETS("[WS-Server][handleClientData] loop budget used, continue next loop\n");
+            break;
+        }
+
+        client = &_clients[(first + n) % WEBSOCKETS_SERVER_CLIENT_MAX];
         if(clientIsConnected(client)) {
-            int len = client->tcp->available();
-            if(len > 0) {
-                // DEBUG_WEBSOCKETS("[WS-Server][%d][handleClientData] len: %d\n", client->num, len);
+            uint32_t rxStart = client->rxBytes;
+            uint8_t frames   = 0;
+            // a partly received frame is also continued without new data, for its timeout
+            bool pending = (client->status == WSC_CONNECTED && client->cWsRXsize);
+
+            while(client->tcp && (client->tcp->available() > 0 || pending)) {
+                pending = false;
+                // DEBUG_WEBSOCKETS("[WS-Server][%d][handleClientData] len: %d\n", client->num, client->tcp->available());
                 switch(client->status) {
                     case WSC_HEADER: {
-                        String headerLine = client->tcp->readStringUntil('\n');
-                        handleHeader(client, &headerLine);
+                        char headerLine[WEBSOCKETS_HEADER_LINE_MAX];
+                        size_t length;
+                        if(readHeaderLine(client, &headerLine[0], sizeof(headerLine), &length)) {
+                            handleHeaderLine(client, &headerLine[0], length);
+                        }
                     } break;
                     case WSC_CONNECTED:
                         WebSockets::handleWebsocket(client);
@@ -713,91 +945,315 @@ void WebSocketsServerCore::handleClientData(void) {
                         WebSockets::clientDisconnect(client, 1002);
                         break;
                 }
-            }
+                client->serviceCount++;
 
-            handleHBPing(client);
-            handleHBTimeout(client);
+                if(client->status == WSC_NOT_CONNECTED || ++frames >= _framesPerLoop || (client->rxBytes - rxStart) >= _bytesPerLoop) {
+                    break;
+                }
+                if(budgetUs && (micros() - start) > budgetUs) {
+                    break;
+                }
+            }
         }
         WEBSOCKETS_YIELD();
     }
+
+    handleTimers();
 }
 #endif
 
 /*
  * returns an indicator whether the given named header exists in the configured _mandatoryHttpHeaders collection
- * @param headerName String ///< the name of the header being checked
+ * @param headerName const char * ///< the name of the header being checked
  */
-bool WebSocketsServerCore::hasMandatoryHeader(String headerName) {
+bool WebSocketsServerCore::hasMandatoryHeader(const char * headerName) {
     for(size_t i = 0; i < _mandatoryHttpHeaderCount; i++) {
-        if(_mandatoryHttpHeaders[i].equalsIgnoreCase(headerName))
+        if(strcasecmp(_mandatoryHttpHeaders[i].c_str(), headerName) == 0)
             return true;
     }
     return false;
 }
 
+/**
+ * lookup a topic in the open addressed topic table
+ * @param topic const char *   topic name (not need to be null terminated)
+ * @param length size_t        length of the topic name
+ * @param wildcard bool        look for the name topic[0..length) followed by '*'
+ * @param hash uint32_t        finished hash of the full name
+ * @param create bool          insert the topic if not found
+ * @return WStopic_t * or NULL
+ */
+WStopic_t * WebSocketsServerCore::findTopic(const char * topic, size_t length, bool wildcard, uint32_t hash, bool create) {
+    WStopic_t * freeSlot = NULL;
+    uint16_t idx         = hash % WEBSOCKETS_SERVER_TOPIC_MAX;
+
+    for(uint16_t probe = 0; probe < WEBSOCKETS_SERVER_TOPIC_MAX; probe++) {
+        WStopic_t * entry = &_topics[idx];
+        if(entry->hash == 0) {
+            // end of the probe chain
+            if(!freeSlot) {
+                freeSlot = entry;
+            }
+            break;
+        }
+        if(entry->hash == WS_TOPIC_TOMBSTONE) {
+            if(!freeSlot) {
+                freeSlot = entry;
+            }
+        } else if(entry->hash == hash && entry->name.length() == (length + (wildcard ? 1 : 0)) && strncmp(entry->name.c_str(), topic, length) == 0) {
+            if(!wildcard || entry->name[length] == '*') {
+                return entry;
+            }
+        }
+        idx = (idx + 1) % WEBSOCKETS_SERVER_TOPIC_MAX;
+    }
+
+    if(!create || !freeSlot || wildcard) {
+        return NULL;
+    }
+
+    if(freeSlot->hash == WS_TOPIC_TOMBSTONE) {
+        _topicTombstones--;
+    }
+    freeSlot->hash = hash;
+    freeSlot->name = "";
+    freeSlot->name.concat(topic, length);
+    memset(freeSlot->subscribers, 0x00, sizeof(freeSlot->subscribers));
+    if(topic[length - 1] == '*') {
+        _wildcardTopics++;
+    }
+    return freeSlot;
+}
+
+/**
+ * drop the tombstones of freed topics, they make every miss probe further.
+ * entries move back towards their home slot until no free slot is left in
+ * front of them in their probe chain
+ */
+void WebSocketsServerCore::rehashTopics() {
+    for(uint16_t i = 0; i < WEBSOCKETS_SERVER_TOPIC_MAX; i++) {
+        if(_topics[i].hash == WS_TOPIC_TOMBSTONE) {
+            _topics[i].hash = 0;
+        }
+    }
+    _topicTombstones = 0;
+
+    bool moved;
+    do {
+        moved = false;
+        for(uint16_t i = 0; i < WEBSOCKETS_SERVER_TOPIC_MAX; i++) {
+            if(_topics[i].hash == 0) {
+                continue;
+            }
+            for(uint16_t idx = _topics[i].hash % WEBSOCKETS_SERVER_TOPIC_MAX; idx != i; idx = (idx + 1) % WEBSOCKETS_SERVER_TOPIC_MAX) {
+                if(_topics[idx].hash == 0) {
+                    _topics[idx] = _topics[i];
+                    _topics[i]   = WStopic_t();
+                    moved        = true;
+                    break;
+                }
+            }
+        }
+    } while(moved);
+}
+
+/**
+ * build the bitmap of clients subscribed to a topic
+ * wildcard topics are matched by looking up the wildcard name of every path
+ * prefix of the topic, so the cost is one hash lookup per path level and
+ * not per subscription
+ * @param topic const char *
+ * @param subscribers uint8_t *  bitmap, (WEBSOCKETS_SERVER_CLIENT_MAX + 7) / 8 bytes
+ */
+void WebSocketsServerCore::collectSubscribers(const char * topic, uint8_t * subscribers) {
+    const size_t mapSize = (WEBSOCKETS_SERVER_CLIENT_MAX + 7) / 8;
+    uint32_t hash        = 2166136261UL;
+    size_t length        = 0;
+    WStopic_t * entry;
+
+    memset(subscribers, 0x00, mapSize);
+
+    for(; ; length++) {
+        if(_wildcardTopics && (length == 0 || topic[length - 1] == '/')) {
+            // "<topic up to here>*"
+            entry = findTopic(topic, length, true, topicHashFinal(topicHashStep(hash, '*')), false);
+            if(entry) {
+                for(size_t i = 0; i < mapSize; i++) {
+                    subscribers[i] |= entry->subscribers[i];
+                }
+            }
+        }
+        if(!topic[length]) {
+            break;
+        }
+        hash = topicHashStep(hash, topic[length]);
+    }
+
+    entry = findTopic(topic, length, false, topicHashFinal(hash), false);
+    if(entry) {
+        for(size_t i = 0; i < mapSize; i++) {
+            subscribers[i] |= entry->subscribers[i];
+        }
+    }
+}
+
+/**
+ * encode one frame and write it to all subscribers of the topic
+ * @param topic const char *
+ * @param opcode WSopcode_t
+ * @param payload uint8_t *
+ * @param length size_t
+ * @param headerToPayload bool  (see sendFrame for more details)
+ * @return number of clients the message was sent to
+ */
+int WebSocketsServerCore::publishFrame(const char * topic, WSopcode_t opcode, uint8_t * payload, size_t length, bool headerToPayload) {
+    if(!topic || !*topic) {
+        return 0;
+    }
+
+    uint8_t subscribers[(WEBSOCKETS_SERVER_CLIENT_MAX + 7) / 8];
+    collectSubscribers(topic, subscribers);
+
+    uint8_t * frame      = payload;
+    bool useInternBuffer = false;
+
+    if(!headerToPayload) {
+        frame = (uint8_t *)WEBSOCKETS_MALLOC(length + WEBSOCKETS_MAX_HEADER_SIZE, WSmem_tx);
+        if(frame) {
+            memcpy(frame + WEBSOCKETS_MAX_HEADER_SIZE, payload, length);
+            useInternBuffer = true;
+        }
+    }
+
+    // server frames are never masked, so the encoded bytes are the same for every client
+    uint8_t * headerPtr = NULL;
+    size_t frameSize    = 0;
+    if(frame) {
+        uint8_t headerBuf[WEBSOCKETS_MAX_HEADER_SIZE];
+        uint8_t headerSize = createHeader(&headerBuf[0], opcode, length, false, NULL, true);
+        headerPtr          = frame + (WEBSOCKETS_MAX_HEADER_SIZE - headerSize);
+        memcpy(headerPtr, &headerBuf[0], headerSize);
+        frameSize = length + headerSize;
+    }
+
+    DEBUG_WEBSOCKETS("[WS-Server][publish] topic: %s length: %u\n", topic, length);
+
+    int count = 0;
+    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+        if(!(subscribers[i / 8] & bit(i % 8))) {
+            continue;
+        }
+        WSclient_t * client = &_clients[i];
+        if(!clientIsConnected(client) || client->status != WSC_CONNECTED) {
+            continue;
+        }
+
+        bool ok;
+        if(headerPtr) {
+            METRICS_WEBSOCKETS(WebSocketsMetrics::frameOut(&client->metrics, opcode, length));
+            ok = (write(client, headerPtr, frameSize) == frameSize);
+        } else {
+            // no memory for the shared frame, fall back to a frame per client
+            ok = sendFrame(client, opcode, payload, length);
+        }
+        if(ok) {
+            count++;
+        }
+        WEBSOCKETS_YIELD();
+    }
+
+    if(useInternBuffer) {
+        WEBSOCKETS_FREE(frame);
+    }
+
+    return count;
+}
+
 /**
  * handles http header reading for WebSocket upgrade
  * @param client WSclient_t * ///< pointer to the client struct
- * @param headerLine String ///< the header being read / processed
+ * @param headerLine String ///< the header being read / processed, cleared afterwards
  */
 void WebSocketsServerCore::handleHeader(WSclient_t * client, String * headerLine) {
+    char line[WEBSOCKETS_HEADER_LINE_MAX];
+    size_t length = std::min((size_t)headerLine->length(), sizeof(line) - 1);
+
+    memcpy(&line[0], headerLine->c_str(), length);
+    line[length]  = 0;
+    (*headerLine) = "";
+
+    handleHeaderLine(client, &line[0], length);
+}
+
+/**
+ * handles one http header line, only the values needed for the upgrade are stored
+ * @param client WSclient_t * ///< pointer to the client struct
+ * @param headerLine char * ///< null terminated line, modified while parsing
+ * @param length size_t ///< length of the line
+ */
+void WebSocketsServerCore::handleHeaderLine(WSclient_t * client, char * headerLine, size_t length) {
     static const char * NEW_LINE = "\r\n";
 
-    headerLine->trim();    // remove \r
+    headerLine = trimHeaderLine(headerLine, &length);    // remove \r
 
-    if(headerLine->length() > 0) {
-        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] RX: %s\n", client->num, headerLine->c_str());
+    if(length > 0) {
+        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] RX: %s\n", client->num, headerLine);
 
         // websocket requests always start with GET see rfc6455
-        if(headerLine->startsWith("GET ")) {
+        if(strncmp(headerLine, "GET ", 4) == 0) {
             // cut URL out
-            client->cUrl = headerLine->substring(4, headerLine->indexOf(' ', 4));
+            char * url = headerLine + 4;
+            char * end = strchr(url, ' ');
+            if(end) {
+                *end = 0;
+            }
+            client->cUrl = url;
 
             // reset non-websocket http header validation state for this client
             client->cHttpHeadersValid      = true;
             client->cMandatoryHeadersCount = 0;
 
-        } else if(headerLine->indexOf(':') >= 0) {
-            String headerName  = headerLine->substring(0, headerLine->indexOf(':'));
-            String headerValue = headerLine->substring(headerLine->indexOf(':') + 1);
-
-            // remove space in the beginning (RFC2616)
-            if(headerValue[0] == ' ') {
-                headerValue.remove(0, 1);
-            }
-
-            if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Connection"))) {
-                headerValue.toLowerCase();
-                if(headerValue.indexOf(WEBSOCKETS_STRING("upgrade")) >= 0) {
-                    client->cIsUpgrade = true;
-                }
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Upgrade"))) {
-                if(headerValue.equalsIgnoreCase(WEBSOCKETS_STRING("websocket"))) {
-                    client->cIsWebsocket = true;
-                }
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Version"))) {
-                client->cVersion = headerValue.toInt();
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Key"))) {
-                client->cKey = headerValue;
-                client->cKey.trim();    // see rfc6455
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Protocol"))) {
-                client->cProtocol = headerValue;
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Extensions"))) {
-                client->cExtensions = headerValue;
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Authorization"))) {
-                client->base64Authorization = headerValue;
-            } else {
-                client->cHttpHeadersValid &= execHttpHeaderValidation(headerName, headerValue);
-                if(_mandatoryHttpHeaderCount > 0 && hasMandatoryHeader(headerName)) {
-                    client->cMandatoryHeadersCount++;
-                }
-            }
-
         } else {
-            DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Header error (%s)\n", headerLine->c_str());
+            char * headerValue;
+            switch(parseHeaderLine(headerLine, &headerValue)) {
+                case WSheader_connection:
+                    if(headerValueContains(headerValue, "upgrade")) {
+                        client->cIsUpgrade = true;
+                    }
+                    break;
+                case WSheader_upgrade:
+                    if(strcasecmp(headerValue, "websocket") == 0) {
+                        client->cIsWebsocket = true;
+                    }
+                    break;
+                case WSheader_secWebSocketVersion:
+                    client->cVersion = atoi(headerValue);
+                    break;
+                case WSheader_secWebSocketKey:
+                    client->cKey = headerValue;    // already trimmed, see rfc6455
+                    break;
+                case WSheader_secWebSocketProtocol:
+                    client->cProtocol = headerValue;
+                    break;
+                case WSheader_secWebSocketExtensions:
+                    client->cExtensions = headerValue;
+                    break;
+                case WSheader_authorization:
+                    client->base64Authorization = headerValue;
+                    break;
+                case WSheader_invalid:
+                    DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] Header error (%s)\n", client->num, headerLine);
+                    break;
+                default:
+                    // Strings are only needed for the user validation
+                    client->cHttpHeadersValid &= execHttpHeaderValidation(headerLine, headerValue);
+                    if(_mandatoryHttpHeaderCount > 0 && hasMandatoryHeader(headerLine)) {
+                        client->cMandatoryHeadersCount++;
+                    }
+                    break;
+            }
         }
 
-        (*headerLine) = "";
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
         client->tcp->readStringUntil('\n', &(client->cHttpLine), std::bind(&WebSocketsServerCore::handleHeader, this, client, &(client->cHttpLine)));
 #endif
@@ -834,6 +1290,13 @@ void WebSocketsServerCore::handleHeader(WSclient_t * client, String * headerLine
             }
         }
 
+        // generate Sec-WebSocket-Accept key
+        char sKey[WEBSOCKETS_ACCEPT_KEY_SIZE];
+        if(ok && !acceptKey(client->cKey.c_str(), client->cKey.length(), &sKey[0])) {
+            DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] Sec-WebSocket-Key invalid\n", client->num);
+            ok = false;
+        }
+
         if(_base64Authorization.length() > 0) {
             String auth = WEBSOCKETS_STRING("Basic ");
             auth += _base64Authorization;
@@ -846,45 +1309,63 @@ void WebSocketsServerCore::handleHeader(WSclient_t * client, String * headerLine
 
         if(ok) {
             DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] Websocket connection incoming.\n", client->num);
+            DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - sKey: %s\n", client->num, sKey);
+
+            // first pass counts, second pass fills the buffer
+            char stack[WEBSOCKETS_HANDSHAKE_SIZE];
+            WSheaderBuffer_t handshake;
+            for(uint8_t pass = 0; pass < 2; pass++) {
+                if(pass) {
+                    if(!handshake.begin(&stack[0], sizeof(stack))) {
+                        DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] not enough memory for the handshake\n", client->num);
+                        METRICS_WEBSOCKETS(client->metrics.mallocFail++);
+                        clientDisconnect(client);
+                        return;
+                    }
+                }
 
-            // generate Sec-WebSocket-Accept key
-            String sKey = acceptKey(client->cKey);
-
-            DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - sKey: %s\n", client->num, sKey.c_str());
-
-            client->status = WSC_CONNECTED;
+                handshake.add(
+                    "HTTP/1.1 101 Switching Protocols\r\n"
+                    "Server: arduino-WebSocketsServer\r\n"
+                    "Upgrade: websocket\r\n"
+                    "Connection: Upgrade\r\n"
+                    "Sec-WebSocket-Version: 13\r\n"
+                    "Sec-WebSocket-Accept: ");
+                handshake.add(&sKey[0]);
+                handshake.add(NEW_LINE);
+
+                if(_origin.length() > 0) {
+                    handshake.add("Access-Control-Allow-Origin: ");
+                    handshake.add(_origin);
+                    handshake.add(NEW_LINE);
+                }
 
-            String handshake = WEBSOCKETS_STRING(
-                "HTTP/1.1 101 Switching Protocols\r\n"
-                "Server: arduino-WebSocketsServer\r\n"
-                "Upgrade: websocket\r\n"
-                "Connection: Upgrade\r\n"
-                "Sec-WebSocket-Version: 13\r\n"
-                "Sec-WebSocket-Accept: ");
-            handshake += sKey + NEW_LINE;
-
-            if(_origin.length() > 0) {
-                handshake += WEBSOCKETS_STRING("Access-Control-Allow-Origin: ");
-                handshake += _origin + NEW_LINE;
-            }
+                if(client->cProtocol.length() > 0) {
+                    handshake.add("Sec-WebSocket-Protocol: ");
+                    handshake.add(_protocol);
+                    handshake.add(NEW_LINE);
+                }
 
-            if(client->cProtocol.length() > 0) {
-                handshake += WEBSOCKETS_STRING("Sec-WebSocket-Protocol: ");
-                handshake += _protocol + NEW_LINE;
+                // header end
+                handshake.add(NEW_LINE);
             }
+            handshake.buffer[handshake.length] = 0;
 
-            // header end
-            handshake += NEW_LINE;
+            client->status = WSC_CONNECTED;
+            cancelTimer(client, WStimer_handshake);
+            scheduleHBPing(client);
 
-            DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] handshake %s", client->num, (uint8_t *)handshake.c_str());
+            DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] handshake %s", client->num, handshake.buffer);
 
-            write(client, (uint8_t *)handshake.c_str(), handshake.length());
+            write(client, (uint8_t *)handshake.buffer, handshake.length);
+            handshake.end();
 
             headerDone(client);
 
             // send ping
             WebSockets::sendFrame(client, WSop_ping);
 
+            MEMORY_WEBSOCKETS(WebSocketsMemory::snapshot(WSmem_connect));
             runCbEvent(client->num, WStype_CONNECTED, (uint8_t *)client->cUrl.c_str(), client->cUrl.length());
 
         } else {
@@ -894,17 +1375,100 @@ void WebSocketsServerCore::handleHeader(WSclient_t * client, String * headerLine
 }
 
 /**
- * send heartbeat ping to server in set intervals
+ * send heartbeat ping to client, called when the ping timer is due
  */
 void WebSocketsServerCore::handleHBPing(WSclient_t * client) {
     if(client->pingInterval == 0)
         return;
-    uint32_t pi = millis() - client->lastPing;
-    if(pi > client->pingInterval) {
-        DEBUG_WEBSOCKETS("[WS-Server][%d] sending HB ping\n", client->num);
-        if(sendPing(client->num)) {
-            client->lastPing     = millis();
-            client->pongReceived = false;
+    DEBUG_WEBSOCKETS("[WS-Server][%d] sending HB ping\n", client->num);
+    uint8_t payload[WEBSOCKETS_HB_PAYLOAD_SIZE];
+    size_t length = heartbeatPayload(client, &payload[0]);
+    if(sendPing(client->num, &payload[0], length)) {
+        client->lastPing     = millis();
+        client->pongReceived = false;
+        if(client->pongTimeout) {
+            scheduleTimer(client, WStimer_pong, heartbeatTimeout(client));
+        }
+    }
+    if(clientIsConnected(client)) {
+        scheduleTimer(client, WStimer_ping, heartbeatInterval(client));
+    }
+}
+
+/**
+ * pong for the last ping not received in time
+ */
+void WebSocketsServerCore::handlePongTimeout(WSclient_t * client) {
+    if(client->pingInterval == 0 || client->pongReceived) {
+        return;
+    }
+
+    client->pongTimeoutCount++;
+    handleHBLoss(client);
+    DEBUG_WEBSOCKETS("[WS-Server][%d] pong TIMEOUT! lp=%d millis=%lu count=%d\n", client->num, client->lastPing, millis(), client->pongTimeoutCount);
+
+    if(client->disconnectTimeoutCount && client->pongTimeoutCount >= client->disconnectTimeoutCount) {
+        DEBUG_WEBSOCKETS("[WS-Server][%d] count=%d, DISCONNECTING\n", client->num, client->pongTimeoutCount);
+        clientDisconnect(client);
+        return;
+    }
+
+    // retry with a new ping right away
+    scheduleTimer(client, WStimer_ping, 0);
+}
+
+/**
+ * arm a timer of a client
+ * @param client WSclient_t *
+ * @param type WStimerType_t
+ * @param delay uint32_t ms from now
+ */
+void WebSocketsServerCore::scheduleTimer(WSclient_t * client, WStimerType_t type, uint32_t delay) {
+    _timers.schedule(client->num * WStimer_count + type, millis() + delay);
+}
+
+void WebSocketsServerCore::cancelTimer(WSclient_t * client, WStimerType_t type) {
+    _timers.cancel(client->num * WStimer_count + type);
+}
+
+/**
+ * schedule the first heartbeat ping of a client
+ * the first ping gets a random phase between pingInterval / 2 and pingInterval
+ * so pings of clients connected at the same time do not burst
+ */
+void WebSocketsServerCore::scheduleHBPing(WSclient_t * client) {
+    if(client->pingInterval == 0) {
+        cancelTimer(client, WStimer_ping);
+        return;
+    }
+    scheduleTimer(client, WStimer_ping, (client->pingInterval / 2) + random(client->pingInterval / 2 + 1));
+}
+
+/**
+ * run the due timers of all clients
+ */
+void WebSocketsServerCore::handleTimers(void) {
+    uint16_t id;
+    _timers.advance(millis());
+    while(_timers.nextExpired(&id)) {
+        WSclient_t * client = &_clients[id / WStimer_count];
+        switch(id % WStimer_count) {
+            case WStimer_ping:
+                if(client->status == WSC_CONNECTED) {
+                    handleHBPing(client);
+                }
+                break;
+            case WStimer_pong:
+                if(client->status == WSC_CONNECTED) {
+                    handlePongTimeout(client);
+                }
+                break;
+            case WStimer_handshake:
+                if(client->status == WSC_HEADER) {
+                    DEBUG_WEBSOCKETS("[WS-Server][%d] handshake TIMEOUT!\n", client->num);
+                    clientDisconnect(client);
+                }
+                break;
         }
     }
 }
@@ -924,9 +1488,103 @@ void WebSocketsServerCore::enableHeartbeat(uint32_t pingInterval, uint32_t pongT
     for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
         client = &_clients[i];
         WebSockets::enableHeartbeat(client, pingInterval, pongTimeout, disconnectTimeoutCount);
+        if(client->status == WSC_CONNECTED) {
+            scheduleHBPing(client);
+        }
+    }
+}
+
+/**
+ * limit the time one loop() spends handling client data
+ * @param budgetUs uint32_t us, 0 = no limit
+ */
+void WebSocketsServerCore::setLoopBudget(uint32_t budgetUs) {
+    _loopBudget = budgetUs;
+}
+
+/**
+ * limit the work done for a single client per loop()
+ * @param framesPerLoop uint8_t  max frames / header lines
+ * @param bytesPerLoop uint32_t  no further frame is started after this many bytes
+ */
+void WebSocketsServerCore::setClientBudget(uint8_t framesPerLoop, uint32_t bytesPerLoop) {
+    _framesPerLoop = framesPerLoop ? framesPerLoop : 1;
+    _bytesPerLoop  = bytesPerLoop;
+}
+
+/**
+ * number of header lines / frames handled for a client since it connected
+ * @param num uint8_t client id
+ */
+uint32_t WebSocketsServerCore::getServiceCount(uint8_t num) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
+        return 0;
     }
+    return _clients[num].serviceCount;
 }
 
+/**
+ * bytes received from a client since it connected
+ * @param num uint8_t client id
+ */
+uint32_t WebSocketsServerCore::getRxBytes(uint8_t num) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
+        return 0;
+    }
+    return _clients[num].rxBytes;
+}
+
+/**
+ * longest loop() call
+ * @param reset bool  start over after reading
+ * @return unsigned long us
+ */
+unsigned long WebSocketsServerCore::getMaxStall(bool reset) {
+    unsigned long stall = _maxStall;
+    if(reset) {
+        _maxStall = 0;
+    }
+    return stall;
+}
+
+/**
+ * keep the longest loop() call
+ * @param start unsigned long  micros() at the start of the call
+ */
+void WebSocketsServerCore::recordStall(unsigned long start) {
+    unsigned long stall = micros() - start;
+    if(stall > _maxStall) {
+        _maxStall = stall;
+    }
+}
+
+#ifdef WEBSOCKETS_METRICS
+/**
+ * copy the counters of a client, they are reset when a new client takes the slot
+ * @param num uint8_t client id
+ * @param metrics WSmetrics_t *  snapshot
+ * @return true if ok
+ */
+bool WebSocketsServerCore::getMetrics(uint8_t num, WSmetrics_t * metrics) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX || !metrics) {
+        return false;
+    }
+    memcpy(metrics, &_clients[num].metrics, sizeof(WSmetrics_t));
+    return true;
+}
+
+/**
+ * clear the counters of a client
+ * @param num uint8_t client id
+ */
+void WebSocketsServerCore::resetMetrics(uint8_t num) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
+        return;
+    }
+    WebSocketsMetrics::reset(&_clients[num].metrics);
+}
+#endif
+
 /**
  * disable ping/pong heartbeat process
  */
@@ -937,9 +1595,37 @@ void WebSocketsServerCore::disableHeartbeat() {
     for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
         client               = &_clients[i];
         client->pingInterval = 0;
+        cancelTimer(client, WStimer_ping);
+        cancelTimer(client, WStimer_pong);
+    }
+}
+
+/**
+ * derive ping interval and pong timeout of every client from its measured rtt and loss
+ * pingInterval and pongTimeout of enableHeartbeat are the base values
+ * @param enable bool
+ */
+void WebSocketsServerCore::setAdaptiveHeartbeat(bool enable) {
+    _adaptiveHeartbeat = enable;
+    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+        _clients[i].link.adaptive = enable;
     }
 }
 
+/**
+ * rtt and loss of a client measured by the heartbeat pings
+ * @param num uint8_t client id
+ * @param quality WSlinkQuality_t *
+ * @return true if ok
+ */
+bool WebSocketsServerCore::getLinkQuality(uint8_t num, WSlinkQuality_t * quality) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX || !quality) {
+        return false;
+    }
+    linkQuality(&_clients[num], quality);
+    return true;
+}
+
 ////////////////////
 // WebSocketServer
 
@@ -955,7 +1641,7 @@ void WebSocketsServer::begin(void) {
 
 void WebSocketsServer::close(void) {
     WebSocketsServerCore::close();
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_RP2040)
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_RP2040) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_CUSTOM)
     _server->close();
 #elif(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     _server->end();
@@ -966,23 +1652,48 @@ void WebSocketsServer::close(void) {
 
 #if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
 /**
- * called in arduino loop
+ * called in arduino loop, the client data is limited by setLoopBudget()
  */
 void WebSocketsServerCore::loop(void) {
+    loop(_loopBudget);
+}
+
+/**
+ * called in arduino loop
+ * @param budgetUs uint32_t  no further client is served after this, 0 = no limit
+ */
+void WebSocketsServerCore::loop(uint32_t budgetUs) {
     if(_runnning) {
+        unsigned long start = micros();
         WEBSOCKETS_YIELD();
-        handleClientData();
+        handleClientData(budgetUs);
+        recordStall(start);
     }
 }
 
 /**
- * called in arduino loop
+ * called in arduino loop, the client data is limited by setLoopBudget()
  */
 void WebSocketsServer::loop(void) {
+    loop(_loopBudget);
+}
+
+/**
+ * called in arduino loop, new clients are accepted first and count against the budget
+ * @param budgetUs uint32_t  no further client is served after this, 0 = no limit
+ */
+void WebSocketsServer::loop(uint32_t budgetUs) {
     if(_runnning) {
+        unsigned long start = micros();
         WEBSOCKETS_YIELD();
         handleNewClients();
-        WebSocketsServerCore::loop();
+        if(budgetUs) {
+            // at least 1 us, 0 would lift the limit
+            unsigned long used = micros() - start;
+            budgetUs           = (used < budgetUs) ? (budgetUs - used) : 1;
+        }
+        WebSocketsServerCore::loop(budgetUs);
+        recordStall(start);
     }
 }
 #endif
@@ -26,11 +26,49 @@
 #define WEBSOCKETSSERVER_H_
 
 #include "WebSockets.h"
+#include "WebSocketsTimerWheel.h"
 
 #ifndef WEBSOCKETS_SERVER_CLIENT_MAX
 #define WEBSOCKETS_SERVER_CLIENT_MAX (5)
 #endif
 
+#ifndef WEBSOCKETS_SERVER_TOPIC_MAX
+#define WEBSOCKETS_SERVER_TOPIC_MAX (16)
+#endif
+
+#ifndef WEBSOCKETS_SERVER_TOPIC_TOMBSTONES
+#define WEBSOCKETS_SERVER_TOPIC_TOMBSTONES ((WEBSOCKETS_SERVER_TOPIC_MAX / 4) + 1)    ///< freed topic slots before the table is rehashed
+#endif
+
+#ifndef WEBSOCKETS_SERVER_HANDSHAKE_TIMEOUT
+#define WEBSOCKETS_SERVER_HANDSHAKE_TIMEOUT WEBSOCKETS_TCP_TIMEOUT
+#endif
+
+#ifndef WEBSOCKETS_SERVER_FRAMES_PER_LOOP
+#define WEBSOCKETS_SERVER_FRAMES_PER_LOOP (4)    ///< max frames / header lines handled per client and loop
+#endif
+
+#ifndef WEBSOCKETS_SERVER_BYTES_PER_LOOP
+#define WEBSOCKETS_SERVER_BYTES_PER_LOOP (4096)    ///< no further frame of a client is started after this many bytes in one loop
+#endif
+
+#ifndef WEBSOCKETS_SERVER_LOOP_BUDGET
+#define WEBSOCKETS_SERVER_LOOP_BUDGET (0)    ///< us per loop, 0 = no limit
+#endif
+
+typedef enum {
+    WStimer_ping,         ///< next heartbeat ping is due
+    WStimer_pong,         ///< pong for the last ping must be received
+    WStimer_handshake,    ///< http upgrade must be done
+    WStimer_count
+} WStimerType_t;
+
+typedef struct {
+    uint32_t hash = 0;    ///< FNV-1a hash of name, 0 = free slot
+    String name;          ///< topic name, wildcard topics end with '*'
+    uint8_t subscribers[(WEBSOCKETS_SERVER_CLIENT_MAX + 7) / 8] = { 0 };    ///< bitmap of subscribed client nums
+} WStopic_t;
+
 class WebSocketsServerCore : protected WebSockets {
   public:
     WebSocketsServerCore(const String & origin = "", const String & protocol = "arduino");
@@ -77,6 +115,16 @@ class WebSocketsServerCore : protected WebSockets {
     bool broadcastPing(uint8_t * payload = NULL, size_t length = 0);
     bool broadcastPing(String & payload);
 
+    bool subscribe(uint8_t num, const char * topic);
+    bool unsubscribe(uint8_t num, const char * topic);
+    bool isSubscribed(uint8_t num, const char * topic);
+    void unsubscribeAll(uint8_t num);
+
+    int publish(const char * topic, uint8_t * payload, size_t length = 0, bool headerToPayload = false);
+    int publish(const char * topic, const char * payload, size_t length = 0);
+    int publish(const char * topic, String & payload);
+    int publishBIN(const char * topic, uint8_t * payload, size_t length, bool headerToPayload = false);
+
     void disconnect(void);
     void disconnect(uint8_t num);
 
@@ -89,13 +137,28 @@ class WebSocketsServerCore : protected WebSockets {
 
     void enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount);
     void disableHeartbeat();
+    void setAdaptiveHeartbeat(bool enable);
+    bool getLinkQuality(uint8_t num, WSlinkQuality_t * quality);
+
+    void setLoopBudget(uint32_t budgetUs);
+    void setClientBudget(uint8_t framesPerLoop, uint32_t bytesPerLoop);
+
+    uint32_t getServiceCount(uint8_t num);
+    uint32_t getRxBytes(uint8_t num);
+    unsigned long getMaxStall(bool reset = false);
+
+#ifdef WEBSOCKETS_METRICS
+    bool getMetrics(uint8_t num, WSmetrics_t * metrics);
+    void resetMetrics(uint8_t num);
+#endif
 
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_RP2040)
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_RP2040) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_CUSTOM)
     IPAddress remoteIP(uint8_t num);
 #endif
 
 #if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
     void loop(void);    // handle client data only
+    void loop(uint32_t budgetUs);
 #endif
 
     WSclient_t * newClient(WEBSOCKETS_NETWORK_CLASS * TCPclient);
@@ -117,6 +180,20 @@ class WebSocketsServerCore : protected WebSockets {
     uint32_t _pingInterval;
     uint32_t _pongTimeout;
     uint8_t _disconnectTimeoutCount;
+    bool _adaptiveHeartbeat;
+
+    WStopic_t _topics[WEBSOCKETS_SERVER_TOPIC_MAX];
+    uint16_t _wildcardTopics;      ///< number of wildcard topics in _topics
+    uint16_t _topicTombstones;    ///< freed slots that still lengthen probe chains, see rehashTopics()
+
+    uint8_t _nextClient;        ///< client handleClientData starts with: the first one skipped by the budget, else rotates by one
+    uint32_t _loopBudget;       ///< us
+    unsigned long _maxStall;    ///< us, longest loop() call
+    uint8_t _framesPerLoop;     ///< per client
+    uint32_t _bytesPerLoop;     ///< per client
+
+    WStimerNode_t _timerNodes[WEBSOCKETS_SERVER_CLIENT_MAX * WStimer_count];
+    WebSocketsTimerWheel _timers;    ///< heartbeat and handshake timeouts of all clients
 
     void messageReceived(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, bool fin);
 
@@ -124,12 +201,20 @@ class WebSocketsServerCore : protected WebSockets {
     bool clientIsConnected(WSclient_t * client);
 
 #if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
-    void handleClientData(void);
+    void handleClientData(uint32_t budgetUs);
+    void recordStall(unsigned long start);
 #endif
 
     void handleHeader(WSclient_t * client, String * headerLine);
+    void handleHeaderLine(WSclient_t * client, char * headerLine, size_t length);
 
     void handleHBPing(WSclient_t * client);    // send ping in specified intervals
+    void handlePongTimeout(WSclient_t * client);
+
+    void scheduleTimer(WSclient_t * client, WStimerType_t type, uint32_t delay);
+    void cancelTimer(WSclient_t * client, WStimerType_t type);
+    void scheduleHBPing(WSclient_t * client);
+    void handleTimers(void);
 
     /**
      * called if a non Websocket connection is coming in.
@@ -213,7 +298,13 @@ class WebSocketsServerCore : protected WebSockets {
      * returns an indicator whether the given named header exists in the configured _mandatoryHttpHeaders collection
      * @param headerName String ///< the name of the header being checked
      */
-    bool hasMandatoryHeader(String headerName);
+    bool hasMandatoryHeader(const char * headerName);
+
+    WStopic_t * findTopic(const char * topic, size_t length, bool wildcard, uint32_t hash, bool create);
+    void removeSubscriber(WStopic_t * entry, uint8_t num);
+    void rehashTopics();
+    void collectSubscribers(const char * topic, uint8_t * subscribers);
+    int publishFrame(const char * topic, WSopcode_t opcode, uint8_t * payload, size_t length, bool headerToPayload);
 };
 
 class WebSocketsServer : public WebSocketsServerCore {
@@ -226,6 +317,7 @@ class WebSocketsServer : public WebSocketsServerCore {
 
 #if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
     void loop(void);    // handle incoming client and client data
+    void loop(uint32_t budgetUs);
 #else
     // Async interface not need a loop call
     void loop(void) __attribute__((deprecated)) {}
@@ -0,0 +1,184 @@
+/**
+ * @file WebSocketsTimerWheel.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "WebSocketsTimerWheel.h"
+
+/**
+ * @param nodes WStimerNode_t *  storage for the timers, one node per timer id
+ * @param count uint16_t         number of nodes
+ */
+WebSocketsTimerWheel::WebSocketsTimerWheel(WStimerNode_t * nodes, uint16_t count) {
+    _nodes    = nodes;
+    _count    = count;
+    _tick     = 0;
+    _time     = 0;
+    _fireHead = WEBSOCKETS_TIMER_NONE;
+    _fireTail = WEBSOCKETS_TIMER_NONE;
+    for(uint8_t i = 0; i < WEBSOCKETS_TIMER_WHEEL_SLOTS; i++) {
+        _slots[i] = WEBSOCKETS_TIMER_NONE;
+    }
+}
+
+/**
+ * arm (or re-arm) a timer
+ * @param id uint16_t        timer id
+ * @param expires uint32_t   millis when the timer is due
+ */
+void WebSocketsTimerWheel::schedule(uint16_t id, uint32_t expires) {
+    if(id >= _count) {
+        return;
+    }
+    cancel(id);
+
+    // slot of the first tick that ends at or after expires
+    int32_t delta  = (int32_t)(expires - _time);
+    uint32_t ticks = 1;
+    if(delta > WEBSOCKETS_TIMER_WHEEL_TICK) {
+        ticks = ((uint32_t)delta + WEBSOCKETS_TIMER_WHEEL_TICK - 1) / WEBSOCKETS_TIMER_WHEEL_TICK;
+    }
+
+    WStimerNode_t * node = &_nodes[id];
+    node->expires        = expires;
+    node->slot           = (_tick + ticks) % WEBSOCKETS_TIMER_WHEEL_SLOTS;
+    node->prev           = WEBSOCKETS_TIMER_NONE;
+    node->next           = _slots[node->slot];
+    if(node->next != WEBSOCKETS_TIMER_NONE) {
+        _nodes[node->next].prev = id;
+    }
+    _slots[node->slot] = id;
+    node->armed        = true;
+}
+
+/**
+ * disarm a timer, also drops it from the expired list
+ * @param id uint16_t
+ */
+void WebSocketsTimerWheel::cancel(uint16_t id) {
+    if(id >= _count) {
+        return;
+    }
+    if(_nodes[id].armed) {
+        unlink(id);
+    }
+    _nodes[id].firing = false;
+}
+
+bool WebSocketsTimerWheel::isArmed(uint16_t id) {
+    if(id >= _count) {
+        return false;
+    }
+    return _nodes[id].armed;
+}
+
+/**
+ * move all timers due at now to the expired list
+ * @param now uint32_t millis
+ */
+void WebSocketsTimerWheel::advance(uint32_t now) {
+    // elapsed time is calculated with unsigned math, so the millis overflow is no problem
+    uint32_t ticks = (now - _time) / WEBSOCKETS_TIMER_WHEEL_TICK;
+
+    if(ticks == 0) {
+        return;
+    }
+
+    if(ticks >= WEBSOCKETS_TIMER_WHEEL_SLOTS) {
+        // a full turn (or more) elapsed, every slot needs one visit
+        for(uint8_t i = 0; i < WEBSOCKETS_TIMER_WHEEL_SLOTS; i++) {
+            collectSlot(i, now);
+        }
+    } else {
+        for(uint32_t t = 1; t <= ticks; t++) {
+            collectSlot((_tick + t) % WEBSOCKETS_TIMER_WHEEL_SLOTS, now);
+        }
+    }
+    _tick += ticks;
+    _time += ticks * WEBSOCKETS_TIMER_WHEEL_TICK;
+}
+
+/**
+ * get the next expired timer, call after advance() until it returns false
+ * @param id uint16_t *
+ * @return true if a timer expired
+ */
+bool WebSocketsTimerWheel::nextExpired(uint16_t * id) {
+    while(_fireHead != WEBSOCKETS_TIMER_NONE) {
+        uint16_t cur = _fireHead;
+        _fireHead    = _nodes[cur].fireNext;
+        if(_fireHead == WEBSOCKETS_TIMER_NONE) {
+            _fireTail = WEBSOCKETS_TIMER_NONE;
+        }
+        _nodes[cur].fireNext = WEBSOCKETS_TIMER_NONE;
+        _nodes[cur].queued   = false;
+
+        if(_nodes[cur].firing) {
+            // canceled or re-armed timers are skipped
+            _nodes[cur].firing = false;
+            *id                = cur;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WebSocketsTimerWheel::unlink(uint16_t id) {
+    WStimerNode_t * node = &_nodes[id];
+    if(node->prev != WEBSOCKETS_TIMER_NONE) {
+        _nodes[node->prev].next = node->next;
+    } else {
+        _slots[node->slot] = node->next;
+    }
+    if(node->next != WEBSOCKETS_TIMER_NONE) {
+        _nodes[node->next].prev = node->prev;
+    }
+    node->next  = WEBSOCKETS_TIMER_NONE;
+    node->prev  = WEBSOCKETS_TIMER_NONE;
+    node->armed = false;
+}
+
+void WebSocketsTimerWheel::collectSlot(uint8_t slot, uint32_t now) {
+    uint16_t id = _slots[slot];
+    while(id != WEBSOCKETS_TIMER_NONE) {
+        uint16_t next = _nodes[id].next;
+        // timers more then one turn ahead stay in the slot
+        if((int32_t)(now - _nodes[id].expires) >= 0) {
+            unlink(id);
+            _nodes[id].firing = true;
+            if(_nodes[id].queued) {
+                // still in the expired list from an earlier advance
+                id = next;
+                continue;
+            }
+            _nodes[id].queued   = true;
+            _nodes[id].fireNext = WEBSOCKETS_TIMER_NONE;
+            if(_fireTail == WEBSOCKETS_TIMER_NONE) {
+                _fireHead = id;
+            } else {
+                _nodes[_fireTail].fireNext = id;
+            }
+            _fireTail = id;
+        }
+        id = next;
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * @file WebSocketsTimerWheel.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef WEBSOCKETSTIMERWHEEL_H_
+#define WEBSOCKETSTIMERWHEEL_H_
+
+#include <stdint.h>
+
+#ifndef WEBSOCKETS_TIMER_WHEEL_SLOTS
+#define WEBSOCKETS_TIMER_WHEEL_SLOTS (32)
+#endif
+
+#ifndef WEBSOCKETS_TIMER_WHEEL_TICK
+#define WEBSOCKETS_TIMER_WHEEL_TICK (64)    ///< ms covered by one slot
+#endif
+
+#define WEBSOCKETS_TIMER_NONE (0xFFFF)
+
+typedef struct {
+    uint32_t expires  = 0;                        ///< millis when the timer is due
+    uint16_t next     = WEBSOCKETS_TIMER_NONE;    ///< next timer in the same slot
+    uint16_t prev     = WEBSOCKETS_TIMER_NONE;    ///< previous timer in the same slot
+    uint16_t fireNext = WEBSOCKETS_TIMER_NONE;    ///< next timer in the expired list
+    uint8_t slot      = 0;
+    bool armed        = false;    ///< linked into a slot
+    bool queued       = false;    ///< linked into the expired list
+    bool firing       = false;    ///< expired and not yet handed out (cleared by cancel)
+} WStimerNode_t;
+
+/**
+ * hashed timer wheel
+ * timers are identified by their index in the node array supplied by the owner,
+ * so no memory is allocated. advance() only visits the slots of the elapsed ticks,
+ * the cost per call is O(ticks + timers in those slots) and not O(timers).
+ */
+class WebSocketsTimerWheel {
+  public:
+    WebSocketsTimerWheel(WStimerNode_t * nodes, uint16_t count);
+
+    void schedule(uint16_t id, uint32_t expires);
+    void cancel(uint16_t id);
+    bool isArmed(uint16_t id);
+
+    void advance(uint32_t now);
+    bool nextExpired(uint16_t * id);
+
+  protected:
+    WStimerNode_t * _nodes;
+    uint16_t _count;
+    uint16_t _slots[WEBSOCKETS_TIMER_WHEEL_SLOTS];
+    uint32_t _tick;    ///< last processed tick
+    uint32_t _time;    ///< millis at the start of the last processed tick
+    uint16_t _fireHead;
+    uint16_t _fireTail;
+
+    void unlink(uint16_t id);
+    void collectSlot(uint8_t slot, uint32_t now);
+};
+
+#endif /* WEBSOCKETSTIMERWHEEL_H_ */
@@ -0,0 +1,101 @@
+/**
+ * @file WebSocketsTrace.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "WebSocketsTrace.h"
+
+#ifdef WEBSOCKETS_TRACE
+
+static_assert((WEBSOCKETS_TRACE_SIZE & (WEBSOCKETS_TRACE_SIZE - 1)) == 0, "WEBSOCKETS_TRACE_SIZE needs to be a power of 2");
+
+uint8_t WebSocketsTrace::mask = 0xFF;
+WStraceRecord_t WebSocketsTrace::_ring[WEBSOCKETS_TRACE_SIZE];
+uint32_t WebSocketsTrace::_head = 0;
+
+#if defined(ESP32)
+// tasks on both cores may trace, a record is reserved and written under the lock
+static portMUX_TYPE traceLock = portMUX_INITIALIZER_UNLOCKED;
+#define TRACE_LOCK() portENTER_CRITICAL(&traceLock)
+#define TRACE_UNLOCK() portEXIT_CRITICAL(&traceLock)
+#else
+// single context, see WebSocketsTrace
+#define TRACE_LOCK()
+#define TRACE_UNLOCK()
+#endif
+
+/**
+ * add a record to the ring, the oldest record is overwritten
+ * @param event WStraceEvent_t
+ * @param num uint8_t      client num
+ * @param a uint32_t       first argument (see WStraceEvent_t)
+ * @param b uint32_t       second argument
+ */
+void WebSocketsTrace::record(WStraceEvent_t event, uint8_t num, uint32_t a, uint32_t b) {
+    uint32_t ts = micros();
+
+    TRACE_LOCK();
+    WStraceRecord_t * r = &_ring[_head & (WEBSOCKETS_TRACE_SIZE - 1)];
+    _head++;
+
+    r->ts    = ts;
+    r->num   = num;
+    r->event = event;
+    r->a     = a;
+    r->b     = b;
+    TRACE_UNLOCK();
+}
+
+void WebSocketsTrace::clear(void) {
+    TRACE_LOCK();
+    _head = 0;
+    TRACE_UNLOCK();
+}
+
+/**
+ * print the ring, oldest record first
+ * format (decimal):
+ *   WSTRACE <records> <dropped> <now us>
+ *   <ts us> <num> <event> <a> <b>
+ *   WSTRACE END
+ * @param out Print &
+ */
+void WebSocketsTrace::dump(Print & out) {
+    uint32_t head  = _head;
+    uint32_t count = (head > WEBSOCKETS_TRACE_SIZE) ? WEBSOCKETS_TRACE_SIZE : head;
+    char line[64];
+
+    snprintf(&line[0], sizeof(line), "WSTRACE %lu %lu %lu\n", (unsigned long)count, (unsigned long)(head - count), (unsigned long)micros());
+    out.print(&line[0]);
+
+    for(uint32_t i = head - count; i != head; i++) {
+        // copy under the lock, printing may block
+        TRACE_LOCK();
+        WStraceRecord_t r = _ring[i & (WEBSOCKETS_TRACE_SIZE - 1)];
+        TRACE_UNLOCK();
+        snprintf(&line[0], sizeof(line), "%lu %u %u %lu %lu\n", (unsigned long)r.ts, r.num, r.event, (unsigned long)r.a, (unsigned long)r.b);
+        out.print(&line[0]);
+    }
+    out.print("WSTRACE END\n");
+}
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * @file WebSocketsTrace.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef WEBSOCKETSTRACE_H_
+#define WEBSOCKETSTRACE_H_
+
+#include <Arduino.h>
+
+// trace levels, used for the runtime mask
+#define WEBSOCKETS_TRACE_ERROR (0x01)
+#define WEBSOCKETS_TRACE_CONN (0x02)     ///< connect / disconnect
+#define WEBSOCKETS_TRACE_FRAME (0x04)    ///< every frame send / received
+#define WEBSOCKETS_TRACE_IO (0x08)       ///< every tcp read / write
+
+#ifndef WEBSOCKETS_TRACE_SIZE
+#define WEBSOCKETS_TRACE_SIZE (128)    ///< records in the ring, power of 2
+#endif
+
+/**
+ * trace events, the order is the binary format!
+ * tools/decode_trace.py reads the names from this enum, only append new events.
+ */
+typedef enum {
+    WStrace_none,
+    WStrace_connected,       ///< a: -              b: -
+    WStrace_disconnect,      ///< a: close code     b: -
+    WStrace_frameTx,         ///< a: opcode/flags   b: length
+    WStrace_frameTxDone,     ///< a: us             b: ok
+    WStrace_frameRx,         ///< a: opcode/flags   b: length
+    WStrace_ping,            ///< a: -              b: length
+    WStrace_pong,            ///< a: -              b: length
+    WStrace_read,            ///< a: bytes          b: ms
+    WStrace_readTimeout,     ///< a: bytes missing  b: ms
+    WStrace_write,           ///< a: bytes          b: ms
+    WStrace_writeStall,      ///< a: bytes left     b: -
+    WStrace_writeTimeout,    ///< a: bytes left     b: ms
+    WStrace_mallocFail,      ///< a: size           b: -
+} WStraceEvent_t;
+
+// a of frame events: opcode | fin << 8 | mask << 9
+#define WEBSOCKETS_TRACE_FRAME_FLAGS(opcode, fin, mask) ((uint32_t)(opcode) | ((fin) ? 0x100 : 0) | ((mask) ? 0x200 : 0))
+
+#ifdef WEBSOCKETS_TRACE
+
+typedef struct {
+    uint32_t ts;    ///< micros
+    uint8_t num;    ///< client num
+    uint8_t event;
+    uint16_t reserved;
+    uint32_t a;
+    uint32_t b;
+} WStraceRecord_t;
+
+/**
+ * binary trace ring, records are only written (no formatting) so a trace point costs a few dozen cycles.
+ * the ring can be printed with dump() and decoded on the host with tools/decode_trace.py
+ * on ESP32 record() and dump() hold a spinlock, tasks on both cores may trace.
+ * on all other targets trace only from one context (loop() and the callbacks it calls), not from an ISR.
+ */
+class WebSocketsTrace {
+  public:
+    static uint8_t mask;    ///< enabled trace levels
+
+    static void record(WStraceEvent_t event, uint8_t num, uint32_t a, uint32_t b);
+    static void clear(void);
+    static void dump(Print & out);
+
+  protected:
+    static WStraceRecord_t _ring[WEBSOCKETS_TRACE_SIZE];
+    static uint32_t _head;    ///< records written since clear
+};
+
+#define TRACE_WEBSOCKETS(level, event, num, a, b)                                  \
+    do {                                                                           \
+        if(WebSocketsTrace::mask & (level)) {                                      \
+            WebSocketsTrace::record((event), (num), (uint32_t)(a), (uint32_t)(b)); \
+        }                                                                          \
+    } while(0)
+
+#else
+
+// compiled out, no code is generated for a trace point
+#define TRACE_WEBSOCKETS(level, event, num, a, b) \
+    do {                                          \
+    } while(0)
+
+#endif
+
+#endif /* WEBSOCKETSTRACE_H_ */
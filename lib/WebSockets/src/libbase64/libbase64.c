@@ -0,0 +1,134 @@
+/* ================ libbase64.c ================ */
+/*
+base64 (RFC 4648) with lookup tables
+
+Encoding takes 3 input bytes per step, decoding 4 characters per step
+through a 256 entry reverse table.
+
+Test Vectors (RFC 4648, section 10)
+""       -> ""
+"f"      -> "Zg=="
+"fo"     -> "Zm8="
+"foo"    -> "Zm9v"
+"foob"   -> "Zm9vYg=="
+"fooba"  -> "Zm9vYmE="
+"foobar" -> "Zm9vYmFy"
+*/
+
+#include "libbase64.h"
+
+static const char encodeTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#define XX 0xFF /* not a base64 character */
+#define PD 0xFE /* '=' */
+
+static const uint8_t decodeTable[256] = {
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, 62, XX, XX, XX, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, XX, XX, XX, PD, XX, XX,
+    XX, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, XX, XX, XX, XX, XX,
+    XX, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX
+};
+
+/* Encode length bytes into BASE64_ENCODED_SIZE(length) characters, no null is added.
+   Returns the number of characters written. */
+
+size_t base64Encode(const uint8_t* data, size_t length, char* out)
+{
+    char* p = out;
+    uint32_t v;
+
+    while (length >= 3) {
+        v = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
+        p[0] = encodeTable[(v >> 18) & 0x3F];
+        p[1] = encodeTable[(v >> 12) & 0x3F];
+        p[2] = encodeTable[(v >> 6) & 0x3F];
+        p[3] = encodeTable[v & 0x3F];
+        data += 3;
+        length -= 3;
+        p += 4;
+    }
+
+    if (length > 0) {
+        v = (uint32_t)data[0] << 16;
+        if (length > 1) {
+            v |= (uint32_t)data[1] << 8;
+        }
+        p[0] = encodeTable[(v >> 18) & 0x3F];
+        p[1] = encodeTable[(v >> 12) & 0x3F];
+        p[2] = (length > 1) ? encodeTable[(v >> 6) & 0x3F] : '=';
+        p[3] = '=';
+        p += 4;
+    }
+
+    return (size_t)(p - out);
+}
+
+/* Decode length characters (padded, no whitespace) into out of size bytes.
+   Returns the number of bytes written, -1 if the input is not base64
+   or out is too small. */
+
+int base64Decode(const char* in, size_t length, uint8_t* out, size_t size)
+{
+    const uint8_t* s = (const uint8_t*)in;
+    uint8_t* p = out;
+    size_t pad = 0;
+    uint8_t a, b, c, d;
+
+    if (length % 4) {
+        return -1;
+    }
+    if (length && in[length - 1] == '=') {
+        pad = (in[length - 2] == '=') ? 2 : 1;
+    }
+    if (BASE64_DECODED_SIZE(length) - pad > size) {
+        return -1;
+    }
+
+    /* all full groups, the last one may be padded and is done below */
+    while (length > 4 || (length == 4 && !pad)) {
+        a = decodeTable[s[0]];
+        b = decodeTable[s[1]];
+        c = decodeTable[s[2]];
+        d = decodeTable[s[3]];
+        if ((a | b | c | d) & 0xC0) {
+            return -1; /* invalid character or '=' before the end */
+        }
+        p[0] = (uint8_t)((a << 2) | (b >> 4));
+        p[1] = (uint8_t)((b << 4) | (c >> 2));
+        p[2] = (uint8_t)((c << 6) | d);
+        s += 4;
+        length -= 4;
+        p += 3;
+    }
+
+    if (length) {
+        a = decodeTable[s[0]];
+        b = decodeTable[s[1]];
+        c = (pad == 2) ? 0 : decodeTable[s[2]];
+        if ((a | b | c) & 0xC0) {
+            return -1;
+        }
+        /* the bits after the last byte must be zero, RFC 4648 section 3.5 */
+        if ((pad == 2 && (b & 0x0F)) || (pad == 1 && (c & 0x03))) {
+            return -1;
+        }
+        *p++ = (uint8_t)((a << 2) | (b >> 4));
+        if (pad == 1) {
+            *p++ = (uint8_t)((b << 4) | (c >> 2));
+        }
+    }
+
+    return (int)(p - out);
+}
@@ -0,0 +1,30 @@
+/* ================ libbase64.h ================ */
+/*
+base64 (RFC 4648) with lookup tables,
+shared by WebSockets and ArduinoHttpClient
+*/
+
+#ifndef LIBBASE64_H_
+#define LIBBASE64_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* encoded length with padding, without a terminating null */
+#define BASE64_ENCODED_SIZE(len) ((((len) + 2) / 3) * 4)
+
+/* upper bound of the decoded length, exact when the input has no padding */
+#define BASE64_DECODED_SIZE(len) (((len) / 4) * 3)
+
+size_t base64Encode(const uint8_t* data, size_t length, char* out);
+int base64Decode(const char* in, size_t length, uint8_t* out, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -33,14 +33,11 @@ A million repetitions of "a"
 
 /* blk0() and blk() perform the initial expand. */
 /* I got the idea of expanding during the round function from SSLeay */
-#if BYTE_ORDER == LITTLE_ENDIAN
-#define blk0(i) (block->l[i] = (rol(block->l[i],24)&0xFF00FF00) \
-    |(rol(block->l[i],8)&0x00FF00FF))
-#elif BYTE_ORDER == BIG_ENDIAN
-#define blk0(i) block->l[i]
-#else
-#error "Endianness not defined!"
-#endif
+/* blk0() loads the big endian words straight from the input, this works
+ * for any byte order and alignment and saves the copy of the block */
+#define blk0(i) (block->l[i] = ((uint32_t)buffer[(i)*4] << 24) \
+    |((uint32_t)buffer[(i)*4+1] << 16)|((uint32_t)buffer[(i)*4+2] << 8) \
+    |(uint32_t)buffer[(i)*4+3])
 #define blk(i) (block->l[i&15] = rol(block->l[(i+13)&15]^block->l[(i+8)&15] \
     ^block->l[(i+2)&15]^block->l[i&15],1))
 
@@ -57,21 +54,11 @@ A million repetitions of "a"
 void SHA1Transform(uint32_t state[5], const unsigned char buffer[64])
 {
     uint32_t a, b, c, d, e;
-    typedef union {
-        unsigned char c[64];
+    typedef struct {
         uint32_t l[16];
-    } CHAR64LONG16;
-#ifdef SHA1HANDSOFF
-    CHAR64LONG16 block[1];  /* use array to appear as a pointer */
-    memcpy(block, buffer, 64);
-#else
-    /* The following had better never be used because it causes the
-     * pointer-to-const buffer to be cast into a pointer to non-const.
-     * And the result is written through.  I threw a "const" in, hoping
-     * this will cause a diagnostic.
-     */
-    CHAR64LONG16* block = (const CHAR64LONG16*)buffer;
-#endif
+    } LONG16;
+    /* the input is never written, blk0() fills the working block */
+    LONG16 block[1];  /* use array to appear as a pointer */
     /* Copy context->state[] to working vars */
     a = state[0];
     b = state[1];
@@ -107,9 +94,7 @@ void SHA1Transform(uint32_t state[5], const unsigned char buffer[64])
     state[4] += e;
     /* Wipe variables */
     a = b = c = d = e = 0;
-#ifdef SHA1HANDSOFF
     memset(block, '\0', sizeof(block));
-#endif
 }
 
 
@@ -155,9 +140,9 @@ void SHA1Update(SHA1_CTX* context, const unsigned char* data, uint32_t len)
 
 void SHA1Final(unsigned char digest[20], SHA1_CTX* context)
 {
+    static const unsigned char padding[64] = { 0200 };
     unsigned i;
     unsigned char finalcount[8];
-    unsigned char c;
 
 #if 0	/* untested "improvement" by DHR */
     /* Convert context->count to a sequence of bytes
@@ -181,12 +166,9 @@ void SHA1Final(unsigned char digest[20], SHA1_CTX* context)
          >> ((3-(i & 3)) * 8) ) & 255);  /* Endian independent */
     }
 #endif
-    c = 0200;
-    SHA1Update(context, &c, 1);
-    while ((context->count[0] & 504) != 448) {
-	c = 0000;
-        SHA1Update(context, &c, 1);
-    }
+    /* pad with 0x80 and zeros up to 56 mod 64 in one update */
+    i = (context->count[0] >> 3) & 63;
+    SHA1Update(context, padding, (i < 56) ? (56 - i) : (120 - i));
     SHA1Update(context, finalcount, 8);  /* Should cause a SHA1Transform() */
     for (i = 0; i < 20; i++) {
         digest[i] = (unsigned char)
@@ -0,0 +1,81 @@
+/**
+ * @file BenchRelay.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_BENCHRELAY_H_
+#define HOST_BENCHRELAY_H_
+
+#include <WebSocketsServer.h>
+
+#include <map>
+#include <string>
+
+/**
+ * routes {targetId, payload} by the ?id= of the connection and adds "from", like the
+ * hosted relay. fragmented messages and unknown targets are dropped
+ */
+class RelayStub {
+  public:
+    explicit RelayStub(uint16_t port) : _server(port) {
+        _server.onEvent([this](uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
+            if(type == WStype_CONNECTED) {
+                const char * id = strstr((const char *)payload, "id=");
+                _ids[num]       = id ? id + 3 : "";
+            } else if(type == WStype_TEXT) {
+                route(num, (const char *)payload, length);
+            }
+        });
+        _server.begin();
+    }
+
+    void loop() {
+        _server.loop();
+    }
+
+  private:
+    void route(uint8_t from, const char * payload, size_t length) {
+        const char * target = strstr(payload, "\"targetId\":\"");
+        if(!target || length < 2) {
+            return;
+        }
+        target += 12;
+        const char * end = strchr(target, '"');
+        if(!end) {
+            return;
+        }
+        std::string targetId(target, end - target);
+        for(auto & entry : _ids) {
+            if(entry.second == targetId) {
+                _out.assign("{\"from\":\"").append(_ids[from]).append("\",").append(payload + 1, length - 1);
+                _server.sendTXT(entry.first, _out.data(), _out.size());
+                return;
+            }
+        }
+    }
+
+    WebSocketsServer _server;
+    std::map<uint8_t, std::string> _ids;
+    std::string _out;
+};
+
+#endif
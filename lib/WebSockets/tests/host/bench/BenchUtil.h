@@ -0,0 +1,168 @@
+/**
+ * @file BenchUtil.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_BENCHUTIL_H_
+#define HOST_BENCHUTIL_H_
+
+#include <benchmark/benchmark.h>
+#include <Arduino.h>
+#include <HostAlloc.h>
+#include <HostStats.h>
+#include <MockNetwork.h>
+
+/**
+ * counts allocations and the heap peak between start() and report()
+ */
+class BenchWindow {
+  public:
+    void start() {
+        host::resetAllocPeak();
+        _start = host::allocStats();
+    }
+
+    /**
+     * sets msgs/s (items), p50_us / p99_us, allocs/msg and peak_bytes,
+     * the heap high water mark above what was held at start()
+     * @param state benchmark::State &
+     * @param latency const HostLatency & one sample per message, may be empty
+     * @param messages uint64_t
+     */
+    void report(benchmark::State & state, const HostLatency & latency, uint64_t messages) {
+        HostAllocStats_t end = host::allocStats();
+        state.SetItemsProcessed(messages);
+        if(latency.count()) {
+            state.counters["p50_us"] = latency.percentile(50);
+            state.counters["p99_us"] = latency.percentile(99);
+        }
+        if(host::allocCounting()) {
+            state.counters["allocs/msg"] = messages ? (double)(end.allocs - _start.allocs) / messages : 0;
+            state.counters["peak_bytes"] = (double)(end.peak - _start.current);
+        }
+    }
+
+  private:
+    HostAllocStats_t _start;
+};
+
+/**
+ * link presets for the Arg of a benchmark
+ */
+inline HostLink_t benchLink(int preset) {
+    HostLink_t link;
+    switch(preset) {
+        case 1:    // LAN: 100 us, 100 Mbit/s
+            link.latencyUs      = 100;
+            link.bytesPerSecond = 12500000;
+            break;
+        case 2:    // the same with 1 % loss and a 2 ms retransmission
+            link.latencyUs      = 100;
+            link.bytesPerSecond = 12500000;
+            link.loss           = 0.01;
+            link.rtoUs          = 2000;
+            break;
+        default:    // ideal
+            break;
+    }
+    return link;
+}
+
+inline const char * benchLinkName(int preset) {
+    static const char * names[] = { "ideal", "lan", "lan_loss1" };
+    return (preset >= 0 && preset < 3) ? names[preset] : "?";
+}
+
+/**
+ * runs loops until done() or the timeout, false on timeout
+ */
+template<typename Loop, typename Done>
+bool benchUntil(Loop loop, Done done, unsigned long timeoutMs = 2000) {
+    unsigned long start = millis();
+    while(!done()) {
+        if(millis() - start > timeoutMs) {
+            return false;
+        }
+        loop();
+    }
+    return true;
+}
+
+/**
+ * a websocket client on a bare HostClient, for benchmarks with more peers than
+ * WebSocketsClient instances are worth. frames are sent with a zero mask key
+ */
+class BenchPeer {
+  public:
+    /**
+     * connects and sends the upgrade request, the server still has to loop() for the answer
+     */
+    bool connect(uint16_t port) {
+        static const char request[] =
+            "GET / HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Connection: Upgrade\r\n"
+            "Upgrade: websocket\r\n"
+            "Sec-WebSocket-Version: 13\r\n"
+            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+            "\r\n";
+        return tcp.connect("localhost", port) && tcp.write((const uint8_t *)request, sizeof(request) - 1) == sizeof(request) - 1;
+    }
+
+    /**
+     * one TEXT frame
+     * @return bool all bytes written
+     */
+    bool sendText(const char * payload, size_t length) {
+        uint8_t header[8];
+        size_t n  = 0;
+        header[n++] = 0x81;
+        if(length < 126) {
+            header[n++] = 0x80 | length;
+        } else {
+            header[n++] = 0x80 | 126;
+            header[n++] = length >> 8;
+            header[n++] = length & 0xFF;
+        }
+        memset(&header[n], 0, 4);    // mask key
+        n += 4;
+        return tcp.write(header, n) == n && tcp.write((const uint8_t *)payload, length) == length;
+    }
+
+    /**
+     * reads what arrived
+     * @return size_t bytes read
+     */
+    size_t drain() {
+        uint8_t buf[1024];
+        size_t total = 0;
+        int n;
+        while((n = tcp.read(buf, sizeof(buf))) > 0) {
+            total += n;
+        }
+        return total;
+    }
+
+    HostClient tcp;
+};
+
+#endif
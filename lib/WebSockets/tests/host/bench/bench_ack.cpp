@@ -0,0 +1,120 @@
+/**
+ * @file bench_ack.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// command -> ack round trip of nikolaindustryrealtime while the device uploads bulk data.
+// the controller call()s the device, the device reply()s on the control lane, which has
+// to wait for the bulk fragment in flight but not for the queued bulk messages
+// args: bulk upload 0 = off / 1 = on, link preset (see benchLink)
+
+#include "BenchRelay.h"
+#include "BenchUtil.h"
+
+#include <nikolaindustry-realtime.h>
+
+namespace {
+
+const uint16_t port = 8701;
+
+void BM_CommandAck(benchmark::State & state) {
+    bool bulk  = state.range(0);
+    int preset = state.range(1);
+    state.SetLabel(std::string(bulk ? "bulk " : "idle ") + benchLinkName(preset));
+    Serial.mute(true);
+    MockNetwork::setLink(benchLink(preset));
+    MockNetwork::seed(1);
+
+    RelayStub relay(port);
+    nikolaindustryrealtime device, controller;
+    device.setEndpoint("localhost", port, false);
+    controller.setEndpoint("localhost", port, false);
+    device.setOnMessageCallback([&](JsonObject & msg) {
+        device.reply(msg, [](JsonObject & payload) {
+            payload["status"] = "GPIO_OK";
+        });
+    });
+    device.begin("bench-device");
+    controller.begin("bench-controller");
+    auto all = [&]() {
+        device.loop();
+        controller.loop();
+        relay.loop();
+    };
+    if(!benchUntil(all, [&]() { return device.isNikolaindustryRealtimeConnected() && controller.isNikolaindustryRealtimeConnected(); }, 10000)) {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    // 8 KB to a target the relay does not know, it reads and drops them
+    String chunk;
+    while(chunk.length() < 8192) {
+        chunk += (char)('a' + chunk.length() % 26);
+    }
+    uint64_t uploaded = 0;
+    auto upload       = [&]() {
+        if(!bulk) {
+            return;
+        }
+        nikolaindustryJsonDocument doc(256);
+        doc["targetId"]        = "bench-sink";
+        doc["payload"]["data"] = chunk.c_str();
+        // keep the bulk lane full
+        while(device.sendJson(doc.as<JsonObject>(), NIKOLAINDUSTRY_PRIORITY_BULK)) {
+            uploaded += chunk.length();
+        }
+    };
+
+    HostLatency latency;
+    latency.reserve(1 << 16);
+    BenchWindow window;
+    window.start();
+    uint64_t messages = 0;
+    unsigned long begin = millis();
+    for(auto _ : state) {
+        uint32_t start = micros();
+        bool done      = false;
+        bool ok        = false;
+        controller.call("bench-device", [](JsonObject & payload) {
+            payload["commands"][0]["command"] = "GPIO_MANAGEMENT";
+        }, [&](bool success, JsonObject &) {
+            done = true;
+            ok   = success;
+        }, 2000);
+        if(!benchUntil([&]() { upload(); all(); }, [&]() { return done; }, 3000) || !ok) {
+            state.SkipWithError("ack lost");
+            break;
+        }
+        latency.add(micros() - start);
+        messages++;
+    }
+    window.report(state, latency, messages);
+    unsigned long took = millis() - begin;
+    state.counters["bulk_kB/s"] = took ? uploaded / (double)took : 0;
+
+    device.disconnect();
+    controller.disconnect();
+}
+
+}    // namespace
+
+BENCHMARK(BM_CommandAck)->ArgsProduct({ { 0, 1 }, { 0, 1 } })->ArgNames({ "bulk", "link" })->Unit(benchmark::kMicrosecond);
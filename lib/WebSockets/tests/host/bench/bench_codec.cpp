@@ -0,0 +1,76 @@
+/**
+ * @file bench_codec.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// base64 and the Sec-WebSocket-Accept key, the per handshake cost of the codecs
+// args: input bytes
+
+#include "BenchUtil.h"
+
+#include <WebSocketsClient.h>
+#include <libbase64/libbase64.h>
+
+#include <vector>
+
+namespace {
+
+class KeyProbe : public WebSocketsClient {
+  public:
+    using WebSockets::acceptKey;
+};
+
+void BM_Base64Encode(benchmark::State & state) {
+    std::vector<uint8_t> data(state.range(0), 0xA5);
+    std::vector<char> out(BASE64_ENCODED_SIZE(data.size()));
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(base64Encode(data.data(), data.size(), out.data()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+void BM_Base64Decode(benchmark::State & state) {
+    std::vector<uint8_t> data(state.range(0), 0xA5);
+    std::vector<char> encoded(BASE64_ENCODED_SIZE(data.size()));
+    base64Encode(data.data(), data.size(), encoded.data());
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(base64Decode(encoded.data(), encoded.size(), data.data(), data.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+void BM_AcceptKey(benchmark::State & state) {
+    const char key[] = "dGhlIHNhbXBsZSBub25jZQ==";
+    char accept[WEBSOCKETS_ACCEPT_KEY_SIZE];
+    KeyProbe probe;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(probe.acceptKey(key, sizeof(key) - 1, accept));
+    }
+}
+
+}    // namespace
+
+BENCHMARK(BM_Base64Encode)->Arg(16)->Arg(20)->Arg(1024);
+BENCHMARK(BM_Base64Decode)->Arg(16)->Arg(20)->Arg(1024);
+BENCHMARK(BM_AcceptKey);
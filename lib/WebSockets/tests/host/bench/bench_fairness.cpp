@@ -0,0 +1,138 @@
+/**
+ * @file bench_fairness.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// one client floods 1 KB frames while 7 others send a 16 byte frame each as soon as the
+// previous one was handled. an iteration is one WebSocketsServer::loop(), the per client
+// budget (setClientBudget) decides how long the light clients wait behind the flood
+// built with WEBSOCKETS_SERVER_CLIENT_MAX=64
+// args: budget preset 0 = 1 frame, 1 = the defaults, 2 = unlimited
+
+#include "BenchUtil.h"
+
+#include <WebSocketsServer.h>
+
+#include <vector>
+
+namespace {
+
+const uint16_t port     = 8601;
+const size_t lightPeers = 7;
+const size_t floodDepth = 64;    // frames the flooder keeps queued
+
+void BM_Fairness(benchmark::State & state) {
+    int preset = state.range(0);
+    Serial.mute(true);
+    MockNetwork::setLink(HostLink_t());
+
+    WebSocketsServer server(port);
+    switch(preset) {
+        case 0:
+            server.setClientBudget(1, 0xFFFFFFFF);
+            state.SetLabel("1 frame");
+            break;
+        case 2:
+            server.setClientBudget(255, 0xFFFFFFFF);
+            state.SetLabel("unlimited");
+            break;
+        default:
+            state.SetLabel("defaults");
+            break;
+    }
+
+    // nums in connect order, the first one floods
+    std::vector<uint8_t> nums;
+    std::vector<uint32_t> sentAt(lightPeers + 1, 0);
+    std::vector<bool> waiting(lightPeers + 1, false);
+    size_t floodHandled = 0;
+    HostLatency latency;
+    latency.reserve(1 << 20);
+    server.onEvent([&](uint8_t num, WStype_t type, uint8_t *, size_t) {
+        if(type == WStype_CONNECTED) {
+            nums.push_back(num);
+        } else if(type == WStype_TEXT) {
+            if(num == nums[0]) {
+                floodHandled++;
+                return;
+            }
+            for(size_t i = 1; i < nums.size(); i++) {
+                if(nums[i] == num) {
+                    latency.add(micros() - sentAt[i]);
+                    waiting[i] = false;
+                }
+            }
+        }
+    });
+    server.begin();
+
+    std::vector<BenchPeer> peers(lightPeers + 1);
+    for(auto & peer : peers) {
+        peer.connect(port);
+        // one at a time, so nums follow the order of peers
+        if(!benchUntil([&]() { server.loop(); }, [&]() { return nums.size() == (size_t)(&peer - &peers[0] + 1); })) {
+            state.SkipWithError("handshake failed");
+            return;
+        }
+    }
+
+    std::string flood(1024, 'f');
+    size_t floodSent = 0;
+    std::vector<uint32_t> serviceStart;
+    for(uint8_t num : nums) {
+        serviceStart.push_back(server.getServiceCount(num));
+    }
+    server.getMaxStall(true);
+
+    BenchWindow window;
+    window.start();
+    uint64_t messages = 0;
+    for(auto _ : state) {
+        while(floodSent - floodHandled < floodDepth) {
+            peers[0].sendText(flood.data(), flood.size());
+            floodSent++;
+        }
+        for(size_t i = 1; i < peers.size(); i++) {
+            if(!waiting[i]) {
+                sentAt[i]  = micros();
+                waiting[i] = true;
+                peers[i].sendText("light", 5);
+                messages++;
+            }
+        }
+        server.loop();
+    }
+
+    window.report(state, latency, messages);
+    // frames handled for the flooder per frame of an average light client
+    double light = 0;
+    for(size_t i = 1; i < nums.size(); i++) {
+        light += server.getServiceCount(nums[i]) - serviceStart[i];
+    }
+    light /= lightPeers;
+    state.counters["flood_share"]  = light ? (server.getServiceCount(nums[0]) - serviceStart[0]) / light : 0;
+    state.counters["max_stall_us"] = server.getMaxStall();
+}
+
+}    // namespace
+
+BENCHMARK(BM_Fairness)->DenseRange(0, 2)->ArgName("budget")->Unit(benchmark::kMicrosecond);
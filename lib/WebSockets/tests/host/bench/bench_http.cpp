@@ -0,0 +1,199 @@
+/**
+ * @file bench_http.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// ArduinoHttpClient on MockNetwork: keep-alive GET against a canned responder
+// and WebSocketClient echo against a WebSocketsServer, both servers in a thread
+
+#include "BenchUtil.h"
+
+#include <ArduinoHttpClient.h>
+#include <WebSocketsServer.h>
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+const uint16_t httpPort = 8201;
+const uint16_t wsPort   = 8202;
+
+/**
+ * answers every request on a connection with the same body until stopped
+ */
+class HttpResponder {
+  public:
+    explicit HttpResponder(size_t bodySize) {
+        _body.reserve(bodySize);
+        for(size_t i = 0; i < bodySize; i++) {
+            _body += (char)('a' + i % 26);
+        }
+        _server.begin();
+        _thread = std::thread([this]() { run(); });
+    }
+    ~HttpResponder() {
+        _running = false;
+        _thread.join();
+    }
+
+  private:
+    void run() {
+        HostClient connection;
+        String line;
+        int blank = 0;
+        while(_running) {
+            if(_server.hasClient()) {
+                connection = _server.accept();
+            }
+            int c = connection.read();
+            if(c < 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            if(c == '\n') {
+                blank = (line.length() == 0 || line == "\r") ? blank + 1 : 0;
+                line  = "";
+                if(blank) {
+                    String response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: " + String((unsigned int)_body.length()) + "\r\n\r\n" + _body;
+                    connection.write((const uint8_t *)response.c_str(), response.length());
+                    blank = 0;
+                }
+            } else {
+                line += (char)c;
+            }
+        }
+        connection.stop();
+    }
+
+    HostServer _server { httpPort };
+    String _body;
+    std::atomic<bool> _running { true };
+    std::thread _thread;
+};
+
+void BM_HttpGet(benchmark::State & state) {
+    size_t size = state.range(0);
+    int preset  = state.range(1);
+    state.SetLabel(benchLinkName(preset));
+    Serial.mute(true);
+    MockNetwork::setLink(benchLink(preset));
+    MockNetwork::seed(1);
+
+    HttpResponder responder(size);
+    HostClient tcp;
+    HttpClient http(tcp, "localhost", httpPort);
+    http.connectionKeepAlive();
+
+    HostLatency latency;
+    latency.reserve(1 << 16);
+    BenchWindow window;
+    window.start();
+    uint64_t messages = 0;
+    for(auto _ : state) {
+        uint32_t start = micros();
+        int err = http.get("/bench");
+        // every request resets the 100 ms wait between polls, which would be all the bench measures
+        http.setHttpWaitForDataDelay(0);
+        if(err != 0 || http.responseStatusCode() != 200 || http.responseBody().length() != size) {
+            state.SkipWithError("request failed");
+            break;
+        }
+        latency.add(micros() - start);
+        messages++;
+    }
+    window.report(state, latency, messages);
+    state.SetBytesProcessed(messages * size);
+    http.stop();
+}
+
+void BM_WebSocketClientEcho(benchmark::State & state) {
+    size_t size = state.range(0);
+    int preset  = state.range(1);
+    state.SetLabel(benchLinkName(preset));
+    Serial.mute(true);
+    MockNetwork::setLink(benchLink(preset));
+    MockNetwork::seed(1);
+
+    WebSocketsServer server(wsPort);
+    server.onEvent([&](uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
+        if(type == WStype_TEXT) {
+            server.sendTXT(num, payload, length);
+        }
+    });
+    server.begin();
+    std::atomic<bool> running(true);
+    std::thread serverThread([&]() {
+        while(running) {
+            server.loop();
+            std::this_thread::yield();
+        }
+    });
+
+    HostClient tcp;
+    WebSocketClient ws(tcp, "localhost", wsPort);
+    if(ws.begin("/") != 0) {
+        running = false;
+        serverThread.join();
+        state.SkipWithError("handshake failed");
+        return;
+    }
+
+    String payload;
+    payload.reserve(size);
+    for(size_t i = 0; i < size; i++) {
+        payload += (char)('a' + i % 26);
+    }
+
+    HostLatency latency;
+    latency.reserve(1 << 16);
+    BenchWindow window;
+    window.start();
+    uint64_t messages = 0;
+    for(auto _ : state) {
+        uint32_t start = micros();
+        ws.beginMessage(TYPE_TEXT);
+        ws.print(payload);
+        ws.endMessage();
+        int length = 0;
+        if(!benchUntil([]() { std::this_thread::yield(); }, [&]() { return (length = ws.parseMessage()) > 0; })) {
+            state.SkipWithError("echo lost");
+            break;
+        }
+        while(ws.available()) {
+            ws.read();
+        }
+        latency.add(micros() - start);
+        messages++;
+    }
+    window.report(state, latency, messages);
+    state.SetBytesProcessed(messages * size);
+
+    ws.stop();
+    running = false;
+    serverThread.join();
+}
+
+}    // namespace
+
+BENCHMARK(BM_HttpGet)->ArgsProduct({ { 64, 4096 }, { 0, 1 } })->ArgNames({ "bytes", "link" })->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_WebSocketClientEcho)->ArgsProduct({ { 16, 1024 }, { 0, 1 } })->ArgNames({ "bytes", "link" })->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,181 @@
+/**
+ * @file bench_parse.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// the 10 KB command batch of examples/parse_benchmark, parsed with the options of
+// nikolaindustryrealtime, and received end to end by the facade from a WebSocketsServer
+// BM_Parse args: 0 full, 1 filter, 2 filter + zero copy, 3 zero copy
+// BM_Receive args: 0 no filter, 1 filter, 2 filter + zero copy
+// built with NIKOLAINDUSTRY_JSON_CAPACITY=32768, the default 2048 does not hold the batch
+
+#include "BenchUtil.h"
+
+#include <WebSocketsServer.h>
+#include <nikolaindustry-realtime.h>
+
+#include <vector>
+
+namespace {
+
+const uint16_t port          = 8801;
+const uint16_t batchCommands = 80;
+const size_t fullCapacity    = 32768;
+const size_t filterCapacity  = 8192;
+
+std::string buildBatch() {
+    std::string batch = "{\"from\":\"server\",\"payload\":{\"commands\":[";
+    for(uint16_t i = 0; i < batchCommands; i++) {
+        char command[160];
+        snprintf(command, sizeof(command),
+            "%s{\"command\":\"gpio\",\"pin\":%u,\"state\":\"%s\",\"label\":\"output channel %u\",\"meta\":{\"zone\":\"hall\",\"owner\":\"automation\",\"rev\":%u}}",
+            i ? "," : "", i % 40, (i & 1) ? "ON" : "OFF", i, i * 7);
+        batch += command;
+    }
+    batch += "]}}";
+    return batch;
+}
+
+// what setMessageFilter() keeps for a handler that reads command, pin and state
+void buildFilter(JsonDocument & filter) {
+    filter["from"]                              = true;
+    filter["payload"]["commands"][0]["command"] = true;
+    filter["payload"]["commands"][0]["pin"]     = true;
+    filter["payload"]["commands"][0]["state"]   = true;
+}
+
+void BM_Parse(benchmark::State & state) {
+    int mode      = state.range(0);
+    bool filtered = mode == 1 || mode == 2;
+    bool zeroCopy = mode >= 2;
+    static const char * labels[] = { "full", "filter", "filter + zero copy", "zero copy" };
+    state.SetLabel(labels[mode]);
+
+    std::string batch = buildBatch();
+    std::vector<char> frame(batch.size() + 1);
+    StaticJsonDocument<256> filter;
+    buildFilter(filter);
+    size_t capacity = filtered ? filterCapacity : fullCapacity;
+
+    size_t used = 0;
+    BenchWindow window;
+    window.start();
+    uint64_t messages = 0;
+    for(auto _ : state) {
+        // a fresh copy each time, zero copy parsing writes into the frame
+        state.PauseTiming();
+        memcpy(frame.data(), batch.c_str(), batch.size() + 1);
+        state.ResumeTiming();
+
+        nikolaindustryJsonDocument doc(capacity);
+        DeserializationError error;
+        if(zeroCopy) {
+            error = filtered ? deserializeJson(doc, frame.data(), batch.size(), DeserializationOption::Filter(filter)) : deserializeJson(doc, frame.data(), batch.size());
+        } else {
+            error = filtered ? deserializeJson(doc, (const char *)frame.data(), batch.size(), DeserializationOption::Filter(filter)) : deserializeJson(doc, (const char *)frame.data(), batch.size());
+        }
+        if(error) {
+            state.SkipWithError(error.c_str());
+            break;
+        }
+        used = doc.memoryUsage();
+        messages++;
+    }
+    window.report(state, HostLatency(), messages);
+    state.SetBytesProcessed(messages * batch.size());
+    state.counters["doc_bytes"] = used;
+}
+
+void BM_Receive(benchmark::State & state) {
+    int mode = state.range(0);
+    static const char * labels[] = { "no filter", "filter", "filter + zero copy" };
+    state.SetLabel(labels[mode]);
+    Serial.mute(true);
+    MockNetwork::setLink(HostLink_t());
+
+    WebSocketsServer server(port);
+    int8_t device = -1;
+    server.onEvent([&](uint8_t num, WStype_t type, uint8_t *, size_t) {
+        if(type == WStype_CONNECTED) {
+            device = num;
+        }
+    });
+    server.begin();
+
+    nikolaindustryrealtime realtime;
+    realtime.setEndpoint("localhost", port, false);
+    if(mode >= 1) {
+        StaticJsonDocument<256> filter;
+        buildFilter(filter);
+        realtime.setMessageFilter(filter);
+    }
+    realtime.setZeroCopyParsing(mode == 2);
+    size_t commands = 0;
+    bool handled    = false;
+    realtime.setOnMessageCallback([&](JsonObject & msg) {
+        commands = msg["payload"]["commands"].size();
+        handled  = true;
+    });
+    realtime.setOnParseError([&](DeserializationError, size_t) {
+        commands = 0;
+        handled  = true;
+    });
+    realtime.begin("bench-parse");
+    auto both = [&]() {
+        realtime.loop();
+        server.loop();
+    };
+    if(!benchUntil(both, [&]() { return device >= 0 && realtime.isNikolaindustryRealtimeConnected(); }, 10000)) {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    std::string batch = buildBatch();
+    HostLatency latency;
+    latency.reserve(1 << 16);
+    BenchWindow window;
+    window.start();
+    uint64_t messages = 0;
+    for(auto _ : state) {
+        uint32_t start = micros();
+        handled        = false;
+        server.sendTXT(device, batch.data(), batch.size());
+        if(!benchUntil(both, [&]() { return handled; })) {
+            state.SkipWithError("batch lost");
+            break;
+        }
+        latency.add(micros() - start);
+        messages++;
+    }
+    window.report(state, latency, messages);
+    state.SetBytesProcessed(messages * batch.size());
+    if(commands != batchCommands) {
+        state.SkipWithError("batch did not fit NIKOLAINDUSTRY_JSON_CAPACITY");
+    }
+
+    realtime.disconnect();
+}
+
+}    // namespace
+
+BENCHMARK(BM_Parse)->DenseRange(0, 3)->ArgName("mode")->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Receive)->DenseRange(0, 2)->ArgName("mode")->Unit(benchmark::kMicrosecond);
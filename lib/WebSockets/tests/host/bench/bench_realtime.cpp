@@ -0,0 +1,105 @@
+/**
+ * @file bench_realtime.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// nikolaindustryrealtime round trip A -> relay -> B -> relay -> A over MockNetwork,
+// the relay is RelayStub of BenchRelay.h
+// args: payload bytes, link preset (see benchLink)
+
+#include "BenchRelay.h"
+#include "BenchUtil.h"
+
+#include <nikolaindustry-realtime.h>
+
+namespace {
+
+const uint16_t port = 8401;
+
+void BM_RealtimeRoundTrip(benchmark::State & state) {
+    size_t size = state.range(0);
+    int preset  = state.range(1);
+    state.SetLabel(benchLinkName(preset));
+    Serial.mute(true);
+    MockNetwork::setLink(benchLink(preset));
+    MockNetwork::seed(1);
+
+    RelayStub relay(port);
+    String filler;
+    while(filler.length() < size) {
+        filler += (char)('a' + filler.length() % 26);
+    }
+
+    nikolaindustryrealtime a, b;
+    uint32_t answered = 0;
+    a.setEndpoint("localhost", port, false);
+    b.setEndpoint("localhost", port, false);
+    a.setOnMessageCallback([&](JsonObject & msg) {
+        answered = msg["payload"]["seq"] | 0;
+    });
+    b.setOnMessageCallback([&](JsonObject & msg) {
+        uint32_t seq = msg["payload"]["seq"] | 0;
+        b.sendTo("bench-a", [&](JsonObject & payload) {
+            payload["seq"] = seq;
+        });
+    });
+    a.begin("bench-a");
+    b.begin("bench-b");
+    auto all = [&]() {
+        a.loop();
+        b.loop();
+        relay.loop();
+    };
+    if(!benchUntil(all, [&]() { return a.isNikolaindustryRealtimeConnected() && b.isNikolaindustryRealtimeConnected(); }, 10000)) {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    HostLatency latency;
+    latency.reserve(1 << 20);
+    BenchWindow window;
+    window.start();
+    uint64_t messages = 0;
+    uint32_t seq      = 0;
+    for(auto _ : state) {
+        uint32_t start = micros();
+        seq++;
+        a.sendTo("bench-b", [&](JsonObject & payload) {
+            payload["seq"]  = seq;
+            payload["data"] = filler.c_str();
+        });
+        if(!benchUntil(all, [&]() { return answered == seq; })) {
+            state.SkipWithError("reply lost");
+            break;
+        }
+        latency.add(micros() - start);
+        messages++;
+    }
+    window.report(state, latency, messages);
+
+    a.disconnect();
+    b.disconnect();
+}
+
+}    // namespace
+
+BENCHMARK(BM_RealtimeRoundTrip)->ArgsProduct({ { 16, 256 }, { 0, 1 } })->ArgNames({ "bytes", "link" })->Unit(benchmark::kMicrosecond);
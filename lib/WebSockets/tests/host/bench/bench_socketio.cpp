@@ -0,0 +1,153 @@
+/**
+ * @file bench_socketio.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// SocketIOclient event echo over MockNetwork
+// a raw listener answers the engine.io polling request with a session id and hands
+// the connection to a WebSocketsServerCore, which then sees the websocket upgrade
+// args: payload bytes, link preset (see benchLink)
+
+#include "BenchUtil.h"
+
+#include <SocketIOclient.h>
+#include <WebSocketsServer.h>
+
+namespace {
+
+const uint16_t port = 8301;
+
+/**
+ * the engine.io side of the exchange, just enough for SocketIOclient
+ */
+class FakeSocketIO {
+  public:
+    FakeSocketIO() : _listener(port) {
+        _core.onEvent([this](uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
+            if(type != WStype_TEXT) {
+                return;
+            }
+            if(length == 6 && memcmp(payload, "2probe", 6) == 0) {
+                _core.sendTXT(num, "3probe");
+            } else if(length > 2 && payload[0] == '4' && payload[1] == '2') {
+                _core.sendTXT(num, payload, length);
+            }
+        });
+        _core.begin();
+        _listener.begin();
+    }
+
+    void loop() {
+        if(_listener.hasClient()) {
+            _polling = _listener.accept();
+            _request.clear();
+        }
+        if(_polling.connected()) {
+            int c;
+            while((c = _polling.read()) >= 0) {
+                _request += (char)c;
+            }
+            if(_request.size() >= 4 && _request.compare(_request.size() - 4, 4, "\r\n\r\n") == 0) {
+                static const char response[] =
+                    "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: text/plain; charset=UTF-8\r\n"
+                    "\r\n"
+                    "0{\"sid\":\"bench\",\"upgrades\":[\"websocket\"],\"pingInterval\":25000,\"pingTimeout\":60000}\n";
+                _polling.write((const uint8_t *)response, sizeof(response) - 1);
+                // the upgrade request follows on the same connection
+                HostClient * tcp = new HostClient(_polling);
+                if(!_core.newClient(tcp)) {
+                    delete tcp;
+                }
+                _polling = HostClient();
+            }
+        }
+        _core.loop();
+    }
+
+  private:
+    HostServer _listener;
+    HostClient _polling;
+    std::string _request;
+    WebSocketsServerCore _core;
+};
+
+void BM_SocketIOEcho(benchmark::State & state) {
+    size_t size = state.range(0);
+    int preset  = state.range(1);
+    state.SetLabel(benchLinkName(preset));
+    Serial.mute(true);
+    MockNetwork::setLink(benchLink(preset));
+    MockNetwork::seed(1);
+
+    FakeSocketIO server;
+    bool connected = false;
+    size_t echoed  = 0;
+    SocketIOclient client;
+    client.onEvent([&](socketIOmessageType_t type, uint8_t * payload, size_t length) {
+        if(type == sIOtype_CONNECT) {
+            connected = true;
+        } else if(type == sIOtype_EVENT) {
+            echoed = length;
+        }
+    });
+    client.begin("localhost", port);
+    auto both = [&]() {
+        client.loop();
+        server.loop();
+    };
+    if(!benchUntil(both, [&]() { return connected; })) {
+        state.SkipWithError("handshake failed");
+        return;
+    }
+
+    String payload = "[\"bench\",\"";
+    while(payload.length() < size + 10) {
+        payload += (char)('a' + payload.length() % 26);
+    }
+    payload += "\"]";
+
+    HostLatency latency;
+    latency.reserve(1 << 20);
+    BenchWindow window;
+    window.start();
+    uint64_t messages = 0;
+    for(auto _ : state) {
+        uint32_t start = micros();
+        echoed         = 0;
+        client.sendEVENT(payload);
+        if(!benchUntil(both, [&]() { return echoed != 0; })) {
+            state.SkipWithError("echo lost");
+            break;
+        }
+        latency.add(micros() - start);
+        messages++;
+    }
+    window.report(state, latency, messages);
+    state.SetBytesProcessed(messages * size);
+
+    client.disconnect();
+}
+
+}    // namespace
+
+BENCHMARK(BM_SocketIOEcho)->ArgsProduct({ { 16, 1024 }, { 0, 1 } })->ArgNames({ "bytes", "link" })->Unit(benchmark::kMicrosecond);
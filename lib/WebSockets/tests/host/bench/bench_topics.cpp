@@ -0,0 +1,132 @@
+/**
+ * @file bench_topics.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// publish() to a topic against one sendTXT() per subscriber, the frame of a publish
+// is built once, so its cost should only grow by the socket writes
+// built with WEBSOCKETS_SERVER_CLIENT_MAX=64
+// args: subscribers, payload bytes
+
+#include "BenchUtil.h"
+
+#include <WebSocketsServer.h>
+
+#include <chrono>
+#include <vector>
+
+namespace {
+
+const uint16_t port  = 8501;
+const char topic[]   = "bench/topic";
+
+class TopicFixture {
+  public:
+    TopicFixture(size_t subscribers) : server(port), peers(subscribers) {
+        server.onEvent([this](uint8_t num, WStype_t type, uint8_t *, size_t) {
+            if(type == WStype_CONNECTED) {
+                server.subscribe(num, topic);
+                nums.push_back(num);
+            }
+        });
+        server.begin();
+        for(auto & peer : peers) {
+            peer.connect(port);
+        }
+        ok = benchUntil([this]() { server.loop(); }, [this]() { return nums.size() == peers.size(); });
+        drain();
+    }
+
+    void drain() {
+        for(auto & peer : peers) {
+            peer.drain();
+        }
+    }
+
+    WebSocketsServer server;
+    std::vector<BenchPeer> peers;
+    std::vector<uint8_t> nums;
+    bool ok = false;
+};
+
+template<typename Send>
+void run(benchmark::State & state, Send send) {
+    size_t subscribers = state.range(0);
+    size_t size        = state.range(1);
+    Serial.mute(true);
+    MockNetwork::setLink(HostLink_t());
+
+    TopicFixture fixture(subscribers);
+    if(!fixture.ok) {
+        state.SkipWithError("handshake failed");
+        return;
+    }
+    String payload;
+    while(payload.length() < size) {
+        payload += (char)('a' + payload.length() % 26);
+    }
+
+    HostLatency latency;
+    latency.reserve(1 << 20);
+    BenchWindow window;
+    window.start();
+    uint64_t messages = 0;
+    for(auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        int sent   = send(fixture, payload);
+        auto took  = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        state.SetIterationTime(took);
+        latency.add(took * 1e9);
+        if(sent != (int)subscribers) {
+            state.SkipWithError("not every subscriber got the message");
+            break;
+        }
+        fixture.drain();
+        messages++;
+    }
+    // items are frames, allocs/msg and p50/p99 are per publish, in ns here
+    window.report(state, HostLatency(), messages);
+    state.counters["p50_ns"] = latency.percentile(50);
+    state.counters["p99_ns"] = latency.percentile(99);
+    state.SetItemsProcessed(messages * subscribers);
+}
+
+void BM_Publish(benchmark::State & state) {
+    run(state, [](TopicFixture & fixture, String & payload) {
+        return fixture.server.publish(topic, payload);
+    });
+}
+
+void BM_SendEach(benchmark::State & state) {
+    run(state, [](TopicFixture & fixture, String & payload) {
+        int sent = 0;
+        for(uint8_t num : fixture.nums) {
+            sent += fixture.server.sendTXT(num, payload) ? 1 : 0;
+        }
+        return sent;
+    });
+}
+
+}    // namespace
+
+BENCHMARK(BM_Publish)->ArgsProduct({ { 1, 4, 16, 64 }, { 64, 1024 } })->ArgNames({ "subscribers", "bytes" })->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SendEach)->ArgsProduct({ { 1, 4, 16, 64 }, { 64, 1024 } })->ArgNames({ "subscribers", "bytes" })->UseManualTime()->Unit(benchmark::kMicrosecond);
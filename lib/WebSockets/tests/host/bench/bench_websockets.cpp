@@ -0,0 +1,104 @@
+/**
+ * @file bench_websockets.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// WebSocketsClient -> WebSocketsServer echo over MockNetwork
+// args: payload bytes, link preset (see benchLink)
+
+#include "BenchUtil.h"
+
+#include <WebSocketsClient.h>
+#include <WebSocketsServer.h>
+
+namespace {
+
+const uint16_t port = 8101;
+
+void BM_Echo(benchmark::State & state) {
+    size_t size = state.range(0);
+    int preset  = state.range(1);
+    state.SetLabel(benchLinkName(preset));
+    Serial.mute(true);
+    MockNetwork::setLink(benchLink(preset));
+    MockNetwork::seed(1);
+
+    WebSocketsServer server(port);
+    server.onEvent([&](uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
+        if(type == WStype_TEXT) {
+            server.sendTXT(num, payload, length);
+        }
+    });
+    server.begin();
+
+    bool connected = false;
+    size_t echoed  = 0;
+    WebSocketsClient client;
+    client.onEvent([&](WStype_t type, uint8_t * payload, size_t length) {
+        if(type == WStype_CONNECTED) {
+            connected = true;
+        } else if(type == WStype_TEXT) {
+            echoed = length;
+        }
+    });
+    client.begin("localhost", port, "/");
+    auto both = [&]() {
+        client.loop();
+        server.loop();
+    };
+    if(!benchUntil(both, [&]() { return connected; })) {
+        state.SkipWithError("handshake failed");
+        return;
+    }
+
+    String payload;
+    payload.reserve(size);
+    for(size_t i = 0; i < size; i++) {
+        payload += (char)('a' + i % 26);
+    }
+
+    HostLatency latency;
+    latency.reserve(1 << 20);
+    BenchWindow window;
+    window.start();
+    uint64_t messages = 0;
+    for(auto _ : state) {
+        uint32_t start = micros();
+        echoed         = 0;
+        client.sendTXT(payload);
+        if(!benchUntil(both, [&]() { return echoed != 0; })) {
+            state.SkipWithError("echo lost");
+            break;
+        }
+        latency.add(micros() - start);
+        messages++;
+    }
+    window.report(state, latency, messages);
+    state.SetBytesProcessed(messages * size);
+
+    client.disconnect();
+    server.close();
+}
+
+}    // namespace
+
+BENCHMARK(BM_Echo)->ArgsProduct({ { 16, 256, 4096 }, { 0, 1, 2 } })->ArgNames({ "bytes", "link" })->Unit(benchmark::kMicrosecond);
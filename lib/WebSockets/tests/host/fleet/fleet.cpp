@@ -0,0 +1,427 @@
+/**
+ * @file fleet.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// examples/fleet_simulator as a PC program: thousands of nikolaindustryrealtime devices (sim-<n>)
+// on worker threads against a relay, on the sockets of the host.
+// every device calls the next one with a GPIO command answered by reply() / GPIO_OK and sends it
+// telemetry on the bulk lane, so the load goes through the same lanes, rate limit and RPC code as a device.
+//
+// options:
+//   --devices <n>        5000
+//   --threads <n>        number of cores (one less with the relay in this process), every thread loops its share of the devices
+//   --seconds <n>        60, then a summary is printed
+//   --relay <host:port>  relay to use, without it a HostRelay (relay/) runs in this process on --port
+//   --port <n>           8081
+//   --command-ms <n>     1000, call() interval per device, 0 = off
+//   --telemetry-ms <n>   1000, telemetry interval per device, 0 = off
+//   --storm-ms <n>       20000, drop every connection at once, 0 = off
+//
+// prints connected devices, messages per second, lost calls and the call round trip every 5 s;
+// the summary adds p50 / p90 / p99 / p99.9 over the whole run and how long the first connect and
+// every storm took until all devices were connected again. exits with 1 if the fleet never was
+// connected completely
+
+#include <HostRelay.h>
+#include <HostStats.h>
+#include <PosixNetwork.h>
+#include <nikolaindustry-realtime.h>
+
+#include <atomic>
+#include <getopt.h>
+#include <mutex>
+#include <signal.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct FleetOptions {
+    uint32_t devices     = 5000;
+    uint32_t threads     = 0;
+    uint32_t seconds     = 60;
+    String relayHost     = "";
+    uint16_t port        = 8081;
+    uint32_t commandMs   = 1000;
+    uint32_t telemetryMs = 1000;
+    uint32_t stormMs     = 20000;
+};
+
+FleetOptions options;
+
+std::atomic<bool> stopping(false);
+std::atomic<uint32_t> stormEpoch(0);
+std::atomic<int32_t> connectedCount(0);
+
+/**
+ * what the devices of one worker counted since the last take(), the lock is only
+ * contended while the reporter takes it
+ */
+struct FleetCounters {
+    uint64_t sent     = 0;
+    uint64_t received = 0;
+    uint64_t lost     = 0;
+    HostLatency latency;
+
+    void merge(const FleetCounters & other) {
+        sent += other.sent;
+        received += other.received;
+        lost += other.lost;
+        latency.merge(other.latency);
+    }
+};
+
+struct SimDevice {
+    nikolaindustryrealtime rt;
+    String id;
+    String next;
+    bool connected         = false;
+    uint32_t lastCommand   = 0;
+    uint32_t lastTelemetry = 0;
+};
+
+class FleetWorker {
+  public:
+    void add(uint32_t n) {
+        _sims.emplace_back(new SimDevice());
+        SimDevice & sim = *_sims.back();
+        sim.id          = "sim-" + String(n);
+        sim.next        = "sim-" + String((n + 1) % options.devices);
+        // first command and telemetry spread over the interval
+        sim.lastCommand   = options.commandMs ? random(options.commandMs) : 0;
+        sim.lastTelemetry = options.telemetryMs ? random(options.telemetryMs) : 0;
+    }
+
+    void start() {
+        _thread = std::thread([this]() { run(); });
+    }
+    void join() {
+        _thread.join();
+    }
+
+    FleetCounters take() {
+        std::lock_guard<std::mutex> guard(_lock);
+        FleetCounters taken = std::move(_counters);
+        _counters           = FleetCounters();
+        return taken;
+    }
+
+  private:
+    void setup(SimDevice & sim) {
+        sim.rt.setEndpoint(options.relayHost.length() ? options.relayHost.c_str() : "localhost", options.port, false);
+
+        sim.rt.setOnConnectionStatusChange([&sim](bool connected) {
+            if(connected == sim.connected) {
+                return;
+            }
+            sim.connected = connected;
+            connectedCount += connected ? 1 : -1;
+        });
+
+        // commands are answered like gpio_control.ino, telemetry is only counted
+        sim.rt.setOnMessageCallback([this, &sim](JsonObject & msg) {
+            count([](FleetCounters & c) { c.received++; });
+            JsonObject payload = msg["payload"];
+            if(payload["command"] == "gpio") {
+                sim.rt.reply(msg, [](JsonObject & resp) {
+                    resp["response"] = "GPIO_OK";
+                });
+            }
+        });
+
+        sim.rt.begin(sim.id.c_str());
+    }
+
+    void sendCommand(SimDevice & sim) {
+        uint32_t start = micros();
+        bool queued    = sim.rt.call(sim.next, [](JsonObject & cmd) {
+            cmd["command"] = "gpio";
+            cmd["pin"]     = 2;
+            cmd["state"]   = "ON";
+        }, [this, start](bool ok, JsonObject & response) {
+            uint32_t took = micros() - start;
+            count([&](FleetCounters & c) {
+                if(!ok || response["response"] != "GPIO_OK") {
+                    c.lost++;
+                    return;
+                }
+                c.received++;
+                c.latency.add(took);
+            });
+        });
+        if(queued) {
+            count([](FleetCounters & c) { c.sent++; });
+        }
+    }
+
+    void run() {
+        for(auto & sim : _sims) {
+            setup(*sim);
+        }
+
+        uint32_t epoch = stormEpoch;
+        while(!stopping) {
+            if(stormEpoch != epoch) {
+                epoch = stormEpoch;
+                for(auto & sim : _sims) {
+                    sim->rt.disconnect();
+                }
+            }
+
+            for(auto & sim : _sims) {
+                sim->rt.loop();
+                if(!sim->connected) {
+                    continue;
+                }
+                uint32_t now = millis();
+                if(options.commandMs && now - sim->lastCommand >= options.commandMs) {
+                    sim->lastCommand = now;
+                    sendCommand(*sim);
+                }
+                if(options.telemetryMs && now - sim->lastTelemetry >= options.telemetryMs) {
+                    sim->lastTelemetry = now;
+                    sim->rt.sendTo(sim->next, [now](JsonObject & telemetry) {
+                        telemetry["telemetry"] = now;
+                        telemetry["rssi"]      = -60;
+                    }, NIKOLAINDUSTRY_PRIORITY_BULK);
+                    count([](FleetCounters & c) { c.sent++; });
+                }
+            }
+        }
+
+        for(auto & sim : _sims) {
+            sim->rt.disconnect();
+        }
+    }
+
+    template<typename F>
+    void count(F update) {
+        std::lock_guard<std::mutex> guard(_lock);
+        update(_counters);
+    }
+
+    std::vector<std::unique_ptr<SimDevice>> _sims;
+    std::thread _thread;
+    std::mutex _lock;
+    FleetCounters _counters;
+};
+
+void onSignal(int) {
+    stopping = true;
+}
+
+void usage(const char * name) {
+    fprintf(stderr,
+        "usage: %s [--devices n] [--threads n] [--seconds n] [--relay host:port] [--port n]\n"
+        "          [--command-ms n] [--telemetry-ms n] [--storm-ms n]\n",
+        name);
+}
+
+bool parseOptions(int argc, char ** argv) {
+    static const struct option longOptions[] = {
+        { "devices", required_argument, nullptr, 'd' },
+        { "threads", required_argument, nullptr, 't' },
+        { "seconds", required_argument, nullptr, 's' },
+        { "relay", required_argument, nullptr, 'r' },
+        { "port", required_argument, nullptr, 'p' },
+        { "command-ms", required_argument, nullptr, 'c' },
+        { "telemetry-ms", required_argument, nullptr, 'm' },
+        { "storm-ms", required_argument, nullptr, 'x' },
+        { nullptr, 0, nullptr, 0 },
+    };
+    int option;
+    while((option = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+        unsigned long value = optarg ? strtoul(optarg, nullptr, 10) : 0;
+        switch(option) {
+            case 'd':
+                options.devices = value;
+                break;
+            case 't':
+                options.threads = value;
+                break;
+            case 's':
+                options.seconds = value;
+                break;
+            case 'r': {
+                const char * colon = strrchr(optarg, ':');
+                if(!colon) {
+                    return false;
+                }
+                options.relayHost = "";
+                options.relayHost.concat(optarg, colon - optarg);
+                options.port = atoi(colon + 1);
+                break;
+            }
+            case 'p':
+                options.port = value;
+                break;
+            case 'c':
+                options.commandMs = value;
+                break;
+            case 'm':
+                options.telemetryMs = value;
+                break;
+            case 'x':
+                options.stormMs = value;
+                break;
+            default:
+                return false;
+        }
+    }
+    if(!options.threads) {
+        uint32_t cores  = std::max(1u, std::thread::hardware_concurrency());
+        options.threads = (options.relayHost.length() || cores == 1) ? cores : cores - 1;
+    }
+    return options.devices > 0 && optind == argc;
+}
+
+void report(const FleetCounters & counters, float seconds) {
+    printf("connected %d/%u  tx %.0f/s  rx %.0f/s  lost %llu  rtt p50 %u us  p99 %u us  (%zu samples)\n", (int)connectedCount, options.devices,
+        counters.sent / seconds, counters.received / seconds, (unsigned long long)counters.lost, counters.latency.percentile(50), counters.latency.percentile(99),
+        counters.latency.count());
+}
+
+}    // namespace
+
+int main(int argc, char ** argv) {
+    if(!parseOptions(argc, argv)) {
+        usage(argv[0]);
+        return 1;
+    }
+    Serial.mute(true);
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+    host::setNetwork(HOST_NETWORK_POSIX);
+
+    unsigned long files = PosixNetwork::raiseFileLimit();
+    uint32_t sockets    = options.devices * (options.relayHost.length() ? 1 : 2);
+    if(files < sockets + 16) {
+        printf("⚠️ open file limit is %lu, %u devices need %u, raise it (ulimit -n)\n", files, options.devices, sockets + 16);
+    }
+
+    std::unique_ptr<HostRelay> relay;
+    std::thread relayThread;
+    if(!options.relayHost.length()) {
+        relay.reset(new HostRelay(options.port, options.devices + 16));
+        if(!relay->begin()) {
+            fprintf(stderr, "❌ can not listen on port %u\n", options.port);
+            return 1;
+        }
+        relayThread = std::thread([&relay]() { relay->run(); });
+    }
+    printf("%u devices on %u threads against %s:%u, call every %u ms, telemetry every %u ms, storm every %u ms\n", options.devices, options.threads,
+        options.relayHost.length() ? options.relayHost.c_str() : "relay in this process", options.port, options.commandMs, options.telemetryMs,
+        options.stormMs);
+
+    std::vector<std::unique_ptr<FleetWorker>> workers;
+    for(uint32_t t = 0; t < options.threads; t++) {
+        workers.emplace_back(new FleetWorker());
+    }
+    for(uint32_t n = 0; n < options.devices; n++) {
+        workers[n % options.threads]->add(n);
+    }
+
+    uint32_t begin = millis();
+    uint32_t end   = begin + options.seconds * 1000;
+    for(auto & worker : workers) {
+        worker->start();
+    }
+
+    FleetCounters total, interval;
+    std::vector<uint32_t> convergence;
+    uint32_t lastReport = millis();
+    uint32_t lastStorm  = millis();
+    uint32_t stormStart = millis();
+    bool dropped        = true;    // nobody is connected at the start
+    bool converged      = false;
+    while(!stopping && (int32_t)(end - millis()) > 0) {
+        delay(10);
+        uint32_t now      = millis();
+        int32_t connected = connectedCount;
+
+        // the workers drop their connections a little after the storm started, so
+        // converged means the count went down and is back at every device
+        if(!converged) {
+            if(!dropped) {
+                dropped = connected < (int32_t)options.devices;
+            } else if(connected == (int32_t)options.devices) {
+                converged = true;
+                convergence.push_back(now - stormStart);
+                printf("all %u devices connected %u ms after the %s\n", options.devices, now - stormStart, convergence.size() == 1 ? "start" : "storm");
+            }
+        }
+
+        if(options.stormMs && now - lastStorm >= options.stormMs) {
+            lastStorm = now;
+            if(!converged) {
+                printf("storm skipped, %d/%u devices connected\n", (int)connected, options.devices);
+            } else {
+                printf("connect storm\n");
+                stormStart = now;
+                dropped    = false;
+                converged  = false;
+                stormEpoch++;
+            }
+        }
+
+        if(now - lastReport >= 5000) {
+            float seconds = (now - lastReport) / 1000.0f;
+            lastReport    = now;
+            for(auto & worker : workers) {
+                interval.merge(worker->take());
+            }
+            report(interval, seconds);
+            total.merge(interval);
+            interval = FleetCounters();
+        }
+    }
+
+    stopping = true;
+    for(auto & worker : workers) {
+        worker->join();
+        total.merge(worker->take());
+    }
+    if(relay) {
+        relay->stop();
+        relayThread.join();
+    }
+
+    float seconds = (millis() - begin) / 1000.0f;
+    printf("\nsummary over %.1f s\n", seconds);
+    printf("messages sent %llu (%.0f/s), received %llu (%.0f/s), calls lost %llu\n", (unsigned long long)total.sent, total.sent / seconds,
+        (unsigned long long)total.received, total.received / seconds, (unsigned long long)total.lost);
+    printf("call round trip p50 %u us  p90 %u us  p99 %u us  p99.9 %u us  (%zu calls)\n", total.latency.percentile(50), total.latency.percentile(90),
+        total.latency.percentile(99), total.latency.percentile(99.9), total.latency.count());
+    for(size_t i = 0; i < convergence.size(); i++) {
+        printf("%s converged in %u ms\n", i ? "storm" : "first connect", convergence[i]);
+    }
+    if(relay) {
+        HostRelayStats_t stats = relay->stats();
+        printf("relay: %llu messages in, %llu out, %llu for unknown ids, %llu connections rejected, %llu dropped as slow consumers\n",
+            (unsigned long long)stats.messages, (unsigned long long)stats.delivered, (unsigned long long)stats.unknown, (unsigned long long)stats.rejected,
+            (unsigned long long)stats.slow);
+    }
+    // for scripts: 1 when the fleet never was connected completely
+    return convergence.empty() ? 1 : 0;
+}
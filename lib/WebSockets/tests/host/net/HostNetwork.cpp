@@ -0,0 +1,71 @@
+/**
+ * @file HostNetwork.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "HostNetwork.h"
+#include "MockNetwork.h"
+#include "PosixNetwork.h"
+
+#include <atomic>
+
+namespace {
+
+std::atomic<HostNetworkMode_t> mode(HOST_NETWORK_MOCK);
+
+}    // namespace
+
+namespace host {
+
+void setNetwork(HostNetworkMode_t m) {
+    mode = m;
+}
+
+HostNetworkMode_t network() {
+    return mode;
+}
+
+}    // namespace host
+
+int HostClient::connect(IPAddress ip, uint16_t port) {
+    return connect(ip.toString().c_str(), port);
+}
+
+int HostClient::connect(const char * host, uint16_t port) {
+    if(_transport) {
+        _transport->close();
+    }
+    if(mode == HOST_NETWORK_POSIX) {
+        _transport = PosixNetwork::connect(host, port, getTimeout());
+    } else {
+        _transport = MockNetwork::connect(port);
+    }
+    return _transport ? 1 : 0;
+}
+
+void HostServer::begin() {
+    if(mode == HOST_NETWORK_POSIX) {
+        _listener = PosixNetwork::listen(_port);
+    } else {
+        _listener = MockNetwork::listen(_port);
+    }
+}
@@ -0,0 +1,154 @@
+/**
+ * @file HostNetwork.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_NETWORK_H_
+#define HOST_NETWORK_H_
+
+// WEBSOCKETS_NETWORK_CUSTOM_INCLUDE of the host builds.
+// HostClient / HostServer are handles on a transport, copies share the connection
+// like WiFiClient copies do. Which transport connect() and begin() create is
+// chosen at run time: the in-memory pair of MockNetwork or POSIX sockets.
+
+#include <Arduino.h>
+#include <Client.h>
+#include <memory>
+
+class HostTransport {
+  public:
+    virtual ~HostTransport() {}
+    virtual size_t write(const uint8_t * buf, size_t size) = 0;
+    virtual int available()                                = 0;
+    virtual int read(uint8_t * buf, size_t size)           = 0;
+    virtual int peek()                                     = 0;
+    virtual bool connected()                               = 0;    ///< open, or data of a closed peer left
+    virtual void close()                                   = 0;
+};
+
+class HostListener {
+  public:
+    virtual ~HostListener() {}
+    virtual bool pending()                          = 0;
+    virtual std::shared_ptr<HostTransport> accept() = 0;
+};
+
+typedef enum {
+    HOST_NETWORK_MOCK,     ///< MockNetwork, in process, link set by MockNetwork::setLink()
+    HOST_NETWORK_POSIX,    ///< PosixNetwork, TCP sockets of the host
+} HostNetworkMode_t;
+
+namespace host {
+
+/**
+ * backend of the connections and listeners created from now on (default HOST_NETWORK_MOCK)
+ * @param mode HostNetworkMode_t
+ */
+void setNetwork(HostNetworkMode_t mode);
+HostNetworkMode_t network();
+
+}    // namespace host
+
+class HostClient : public Client {
+  public:
+    HostClient() {}
+    explicit HostClient(std::shared_ptr<HostTransport> transport) : _transport(transport) {}
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char * host, uint16_t port) override;
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+    size_t write(const uint8_t * buf, size_t size) override {
+        return _transport ? _transport->write(buf, size) : 0;
+    }
+    using Print::write;
+
+    int available() override {
+        return _transport ? _transport->available() : 0;
+    }
+    int read() override {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    int read(uint8_t * buf, size_t size) override {
+        return _transport ? _transport->read(buf, size) : -1;
+    }
+    int peek() override {
+        return _transport ? _transport->peek() : -1;
+    }
+    void flush() override {}
+    void stop() override {
+        if(_transport) {
+            _transport->close();
+        }
+    }
+    uint8_t connected() override {
+        return _transport && _transport->connected();
+    }
+    operator bool() override {
+        return connected();
+    }
+
+    void setNoDelay(bool) {}
+    IPAddress remoteIP() const {
+        return IPAddress(127, 0, 0, 1);
+    }
+
+  private:
+    std::shared_ptr<HostTransport> _transport;
+};
+
+class HostServer {
+  public:
+    HostServer(uint16_t port) : _port(port) {}
+
+    void begin();
+    void close() {
+        _listener.reset();
+    }
+    void end() {
+        close();
+    }
+    bool hasClient() {
+        return _listener && _listener->pending();
+    }
+    HostClient accept() {
+        return _listener ? HostClient(_listener->accept()) : HostClient();
+    }
+    HostClient available() {
+        return accept();
+    }
+    uint16_t port() const {
+        return _port;
+    }
+
+  private:
+    uint16_t _port;
+    std::shared_ptr<HostListener> _listener;
+};
+
+#define WEBSOCKETS_NETWORK_CLASS HostClient
+#define WEBSOCKETS_NETWORK_SERVER_CLASS HostServer
+
+#endif
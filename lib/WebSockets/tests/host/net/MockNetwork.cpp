@@ -0,0 +1,292 @@
+/**
+ * @file MockNetwork.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "MockNetwork.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace {
+
+uint64_t nowUs() {
+    return host::micros64();
+}
+
+/**
+ * one direction of a connection.
+ * the bytes live in a buffer that is compacted instead of freed and the segment marks
+ * in a vector used the same way, so a steady stream does not allocate in here
+ * and the allocation counters only see the library.
+ */
+class Pipe {
+  public:
+    explicit Pipe(const HostLink_t & link, uint32_t seed) : _link(link), _rng(seed) {}
+
+    size_t write(const uint8_t * buf, size_t size) {
+        std::lock_guard<std::mutex> guard(_lock);
+        if(_readerClosed || _writerClosed) {
+            return 0;
+        }
+        uint64_t now = nowUs();
+        compact();
+        _bytes.insert(_bytes.end(), buf, buf + size);
+        size_t segment = _link.segmentSize ? _link.segmentSize : size;
+        for(size_t done = 0; done < size; done += segment) {
+            size_t len = std::min(segment, size - done);
+            uint64_t sent = std::max(now, _busyUntil);
+            if(_link.bytesPerSecond) {
+                sent += (uint64_t)len * 1000000 / _link.bytesPerSecond;
+            }
+            _busyUntil  = sent;
+            uint64_t at = sent + _link.latencyUs;
+            if(_link.loss > 0 && std::uniform_real_distribution<float>(0, 1)(_rng) < _link.loss) {
+                at += _link.rtoUs;
+            }
+            at          = std::max(at, _lastAt);
+            _lastAt     = at;
+            _written    += len;
+            _marks.push_back({ _written, at });
+        }
+        return size;
+    }
+
+    int available() {
+        std::lock_guard<std::mutex> guard(_lock);
+        return delivered();
+    }
+
+    int read(uint8_t * buf, size_t size) {
+        std::lock_guard<std::mutex> guard(_lock);
+        size_t n = std::min<size_t>(delivered(), size);
+        if(!n) {
+            return -1;
+        }
+        memcpy(buf, &_bytes[_head], n);
+        _head += n;
+        _read += n;
+        return n;
+    }
+
+    int peek() {
+        std::lock_guard<std::mutex> guard(_lock);
+        return delivered() ? _bytes[_head] : -1;
+    }
+
+    bool open() {
+        std::lock_guard<std::mutex> guard(_lock);
+        return !_writerClosed || delivered() || _read < _written;
+    }
+
+    void closeWriter() {
+        std::lock_guard<std::mutex> guard(_lock);
+        _writerClosed = true;
+    }
+
+    void closeReader() {
+        std::lock_guard<std::mutex> guard(_lock);
+        _readerClosed = true;
+        _bytes.clear();
+        _marks.clear();
+        _head = _markHead = 0;
+        _read = _written;
+    }
+
+  private:
+    typedef struct {
+        uint64_t end;    ///< stream offset after the segment
+        uint64_t at;     ///< arrival in nowUs()
+    } Mark;
+
+    size_t delivered() {
+        uint64_t now  = nowUs();
+        uint64_t upTo = _read;
+        for(size_t i = _markHead; i < _marks.size() && _marks[i].at <= now; i++) {
+            upTo = _marks[i].end;
+        }
+        while(_markHead < _marks.size() && _marks[_markHead].end <= _read) {
+            _markHead++;
+        }
+        return upTo - _read;
+    }
+
+    void compact() {
+        if(_head && _head == _bytes.size()) {
+            _bytes.clear();
+            _head = 0;
+        } else if(_head > 4096 && _head * 2 > _bytes.size()) {
+            _bytes.erase(_bytes.begin(), _bytes.begin() + _head);
+            _head = 0;
+        }
+        if(_markHead && _markHead == _marks.size()) {
+            _marks.clear();
+            _markHead = 0;
+        } else if(_markHead > 256 && _markHead * 2 > _marks.size()) {
+            _marks.erase(_marks.begin(), _marks.begin() + _markHead);
+            _markHead = 0;
+        }
+    }
+
+    std::mutex _lock;
+    HostLink_t _link;
+    std::minstd_rand _rng;
+    std::vector<uint8_t> _bytes;
+    size_t _head = 0;
+    std::vector<Mark> _marks;
+    size_t _markHead    = 0;
+    uint64_t _written   = 0;
+    uint64_t _read      = 0;
+    uint64_t _busyUntil = 0;
+    uint64_t _lastAt    = 0;
+    bool _writerClosed  = false;
+    bool _readerClosed  = false;
+};
+
+class MockTransport : public HostTransport {
+  public:
+    MockTransport(std::shared_ptr<Pipe> in, std::shared_ptr<Pipe> out) : _in(in), _out(out) {}
+    ~MockTransport() {
+        close();
+    }
+
+    size_t write(const uint8_t * buf, size_t size) override {
+        if(_closed) {
+            return 0;
+        }
+        size_t n = _out->write(buf, size);
+        if(!n && size) {
+            // the peer is gone, like a reset the connection ends here
+            close();
+        }
+        return n;
+    }
+    int available() override {
+        return _closed ? 0 : _in->available();
+    }
+    int read(uint8_t * buf, size_t size) override {
+        return _closed ? -1 : _in->read(buf, size);
+    }
+    int peek() override {
+        return _closed ? -1 : _in->peek();
+    }
+    bool connected() override {
+        return !_closed && _in->open();
+    }
+    void close() override {
+        if(!_closed) {
+            _closed = true;
+            _out->closeWriter();
+            _in->closeReader();
+        }
+    }
+
+  private:
+    std::shared_ptr<Pipe> _in;
+    std::shared_ptr<Pipe> _out;
+    std::atomic<bool> _closed { false };
+};
+
+class MockListener : public HostListener {
+  public:
+    explicit MockListener(uint16_t port) : _port(port) {}
+    ~MockListener();
+
+    bool pending() override {
+        std::lock_guard<std::mutex> guard(_lock);
+        return !_queue.empty();
+    }
+    std::shared_ptr<HostTransport> accept() override {
+        std::lock_guard<std::mutex> guard(_lock);
+        if(_queue.empty()) {
+            return nullptr;
+        }
+        std::shared_ptr<HostTransport> transport = _queue.front();
+        _queue.erase(_queue.begin());
+        return transport;
+    }
+    void push(std::shared_ptr<HostTransport> transport) {
+        std::lock_guard<std::mutex> guard(_lock);
+        _queue.push_back(transport);
+    }
+
+  private:
+    uint16_t _port;
+    std::mutex _lock;
+    std::vector<std::shared_ptr<HostTransport>> _queue;
+};
+
+std::mutex registryLock;
+std::map<uint16_t, MockListener *> listeners;
+HostLink_t currentLink;
+uint32_t nextSeed = 1;
+
+MockListener::~MockListener() {
+    std::lock_guard<std::mutex> guard(registryLock);
+    auto it = listeners.find(_port);
+    if(it != listeners.end() && it->second == this) {
+        listeners.erase(it);
+    }
+}
+
+}    // namespace
+
+namespace MockNetwork {
+
+void setLink(const HostLink_t & link) {
+    std::lock_guard<std::mutex> guard(registryLock);
+    currentLink = link;
+}
+
+HostLink_t link() {
+    std::lock_guard<std::mutex> guard(registryLock);
+    return currentLink;
+}
+
+void seed(uint32_t seed) {
+    std::lock_guard<std::mutex> guard(registryLock);
+    nextSeed = seed ? seed : 1;
+}
+
+std::shared_ptr<HostListener> listen(uint16_t port) {
+    std::shared_ptr<MockListener> listener = std::make_shared<MockListener>(port);
+    std::lock_guard<std::mutex> guard(registryLock);
+    listeners[port] = listener.get();
+    return listener;
+}
+
+std::shared_ptr<HostTransport> connect(uint16_t port) {
+    std::lock_guard<std::mutex> guard(registryLock);
+    auto it = listeners.find(port);
+    if(it == listeners.end()) {
+        return nullptr;
+    }
+    std::shared_ptr<Pipe> up   = std::make_shared<Pipe>(currentLink, nextSeed++);
+    std::shared_ptr<Pipe> down = std::make_shared<Pipe>(currentLink, nextSeed++);
+    it->second->push(std::make_shared<MockTransport>(up, down));
+    return std::make_shared<MockTransport>(down, up);
+}
+
+}    // namespace MockNetwork
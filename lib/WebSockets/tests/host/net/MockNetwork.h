@@ -0,0 +1,65 @@
+/**
+ * @file MockNetwork.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_MOCKNETWORK_H_
+#define HOST_MOCKNETWORK_H_
+
+#include "HostNetwork.h"
+
+/**
+ * properties of the connections MockNetwork creates, both directions alike.
+ * a write is cut into segments, every segment leaves the sender after the previous one
+ * at the link rate and arrives latencyUs later, in order like TCP: a lost segment comes
+ * rtoUs late and holds back the ones behind it.
+ * the times are micros() of the shim, a test on the manual clock moves the data with host::advance()
+ */
+typedef struct {
+    uint32_t latencyUs     = 0;       ///< one way delay
+    uint32_t bytesPerSecond = 0;      ///< 0 is unlimited
+    uint16_t segmentSize   = 1460;    ///< 0 keeps every write in one segment
+    float loss             = 0;       ///< chance a segment is lost once (0..1)
+    uint32_t rtoUs         = 200000;  ///< retransmission delay of a lost segment
+} HostLink_t;
+
+namespace MockNetwork {
+
+/**
+ * link of the connections created from now on
+ * @param link const HostLink_t &
+ */
+void setLink(const HostLink_t & link);
+HostLink_t link();
+
+/**
+ * seeds the loss decisions so runs repeat
+ * @param seed uint32_t
+ */
+void seed(uint32_t seed);
+
+std::shared_ptr<HostListener> listen(uint16_t port);
+std::shared_ptr<HostTransport> connect(uint16_t port);
+
+}    // namespace MockNetwork
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ * @file PosixNetwork.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "PosixNetwork.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+#ifndef POSIX_NETWORK_RX_BUFFER
+#define POSIX_NETWORK_RX_BUFFER (4096)
+#endif
+
+#ifndef POSIX_NETWORK_BACKLOG
+#define POSIX_NETWORK_BACKLOG (4096)
+#endif
+
+bool nonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+void noDelay(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+/**
+ * socket with a small receive buffer in user space,
+ * available() / peek() / connected() are answered from it without a syscall while it holds data
+ */
+class PosixTransport : public HostTransport {
+  public:
+    explicit PosixTransport(int fd) : _fd(fd) {}
+    ~PosixTransport() {
+        close();
+    }
+
+    size_t write(const uint8_t * buf, size_t size) override {
+        size_t sent = 0;
+        while(_fd >= 0 && sent < size) {
+            ssize_t n = ::send(_fd, buf + sent, size - sent, MSG_NOSIGNAL);
+            if(n > 0) {
+                sent += n;
+            } else if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // the library writes until WEBSOCKETS_TCP_TIMEOUT itself, hand back what went out
+                if(sent) {
+                    break;
+                }
+                struct pollfd p = { _fd, POLLOUT, 0 };
+                if(poll(&p, 1, 10) <= 0) {
+                    break;
+                }
+            } else if(n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                _eof = true;
+                break;
+            }
+        }
+        return sent;
+    }
+
+    int available() override {
+        fill();
+        return _len - _pos;
+    }
+
+    int read(uint8_t * buf, size_t size) override {
+        if(_pos == _len) {
+            // large reads skip the buffer
+            if(size >= POSIX_NETWORK_RX_BUFFER) {
+                return receive(buf, size);
+            }
+            fill();
+        }
+        size_t n = std::min<size_t>(_len - _pos, size);
+        if(!n) {
+            return -1;
+        }
+        memcpy(buf, &_buffer[_pos], n);
+        _pos += n;
+        return n;
+    }
+
+    int peek() override {
+        fill();
+        return _pos < _len ? _buffer[_pos] : -1;
+    }
+
+    bool connected() override {
+        if(_fd < 0) {
+            return false;
+        }
+        fill();
+        return _pos < _len || !_eof;
+    }
+
+    void close() override {
+        if(_fd >= 0) {
+            ::close(_fd);
+            _fd = -1;
+        }
+    }
+
+  private:
+    void fill() {
+        if(_pos < _len || _fd < 0 || _eof) {
+            return;
+        }
+        _pos = _len = 0;
+        int n       = receive(_buffer, sizeof(_buffer));
+        if(n > 0) {
+            _len = n;
+        }
+    }
+
+    int receive(uint8_t * buf, size_t size) {
+        ssize_t n = ::recv(_fd, buf, size, MSG_DONTWAIT);
+        if(n > 0) {
+            return n;
+        }
+        if(n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            _eof = true;
+        }
+        return -1;
+    }
+
+    int _fd;
+    bool _eof   = false;
+    size_t _pos = 0;
+    size_t _len = 0;
+    uint8_t _buffer[POSIX_NETWORK_RX_BUFFER];
+};
+
+class PosixListener : public HostListener {
+  public:
+    explicit PosixListener(int fd) : _fd(fd) {}
+    ~PosixListener() {
+        if(_next >= 0) {
+            ::close(_next);
+        }
+        ::close(_fd);
+    }
+
+    bool pending() override {
+        if(_next < 0) {
+            _next = ::accept(_fd, nullptr, nullptr);
+            if(_next >= 0 && !nonBlocking(_next)) {
+                ::close(_next);
+                _next = -1;
+            }
+        }
+        return _next >= 0;
+    }
+
+    std::shared_ptr<HostTransport> accept() override {
+        if(!pending()) {
+            return nullptr;
+        }
+        int fd = _next;
+        _next  = -1;
+        noDelay(fd);
+        return std::make_shared<PosixTransport>(fd);
+    }
+
+  private:
+    int _fd;
+    int _next = -1;
+};
+
+}    // namespace
+
+namespace PosixNetwork {
+
+std::shared_ptr<HostListener> listen(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if(fd < 0) {
+        return nullptr;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {};
+    addr.sin_family         = AF_INET;
+    addr.sin_addr.s_addr    = htonl(INADDR_ANY);
+    addr.sin_port           = htons(port);
+    if(bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || ::listen(fd, POSIX_NETWORK_BACKLOG) < 0 || !nonBlocking(fd)) {
+        ::close(fd);
+        return nullptr;
+    }
+    return std::make_shared<PosixListener>(fd);
+}
+
+std::shared_ptr<HostTransport> connect(const char * host, uint16_t port, unsigned long timeoutMs) {
+    struct addrinfo hints = {};
+    struct addrinfo * list;
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if(getaddrinfo(host, service, &hints, &list) != 0) {
+        return nullptr;
+    }
+    int fd = socket(list->ai_family, list->ai_socktype, list->ai_protocol);
+    if(fd < 0 || !nonBlocking(fd)) {
+        if(fd >= 0) {
+            ::close(fd);
+        }
+        freeaddrinfo(list);
+        return nullptr;
+    }
+    int ret = ::connect(fd, list->ai_addr, list->ai_addrlen);
+    freeaddrinfo(list);
+    if(ret < 0 && errno == EINPROGRESS) {
+        struct pollfd p = { fd, POLLOUT, 0 };
+        int error       = 0;
+        socklen_t len   = sizeof(error);
+        if(poll(&p, 1, timeoutMs) == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0) {
+            ret = 0;
+        }
+    }
+    if(ret < 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    noDelay(fd);
+    return std::make_shared<PosixTransport>(fd);
+}
+
+unsigned long raiseFileLimit() {
+    struct rlimit limit;
+    if(getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+        return 0;
+    }
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    getrlimit(RLIMIT_NOFILE, &limit);
+    return limit.rlim_cur;
+}
+
+}    // namespace PosixNetwork
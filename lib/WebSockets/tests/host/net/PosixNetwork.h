@@ -0,0 +1,55 @@
+/**
+ * @file PosixNetwork.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_POSIXNETWORK_H_
+#define HOST_POSIXNETWORK_H_
+
+#include "HostNetwork.h"
+
+namespace PosixNetwork {
+
+/**
+ * listening socket on all interfaces, non-blocking, accept() hands out what is queued
+ * @param port uint16_t
+ * @return nullptr when bind / listen fails
+ */
+std::shared_ptr<HostListener> listen(uint16_t port);
+
+/**
+ * blocking connect like the Arduino clients, the socket is non-blocking afterwards
+ * @param host const char * name or address
+ * @param port uint16_t
+ * @param timeoutMs unsigned long
+ */
+std::shared_ptr<HostTransport> connect(const char * host, uint16_t port, unsigned long timeoutMs);
+
+/**
+ * raises the open file limit to the hard limit, a relay or fleet needs one per connection
+ * @return the limit now in effect
+ */
+unsigned long raiseFileLimit();
+
+}    // namespace PosixNetwork
+
+#endif
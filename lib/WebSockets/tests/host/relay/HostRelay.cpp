@@ -0,0 +1,303 @@
+/**
+ * @file HostRelay.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "HostRelay.h"
+
+#include <PosixNetwork.h>
+
+#ifndef HOST_RELAY_JSON_CAPACITY
+#define HOST_RELAY_JSON_CAPACITY (16384)    ///< largest text message that is routed
+#endif
+
+/**
+ * WebSockets::write() retries a socket that takes nothing for WEBSOCKETS_TCP_TIMEOUT, so one device
+ * that does not read would stall every other one. like a hosted relay drops slow consumers, a write
+ * the socket does not take completely closes the connection, the device reconnects
+ */
+class HostRelayTransport : public HostTransport {
+  public:
+    HostRelayTransport(std::shared_ptr<HostTransport> socket, uint64_t * dropped) : _socket(socket), _dropped(dropped) {}
+
+    size_t write(const uint8_t * buf, size_t size) override {
+        size_t sent = _socket->write(buf, size);
+        if(sent < size && _socket->connected()) {
+            _socket->close();
+            (*_dropped)++;
+        }
+        return sent;
+    }
+    int available() override {
+        return _socket->available();
+    }
+    int read(uint8_t * buf, size_t size) override {
+        return _socket->read(buf, size);
+    }
+    int peek() override {
+        return _socket->peek();
+    }
+    bool connected() override {
+        return _socket->connected();
+    }
+    void close() override {
+        _socket->close();
+    }
+
+  private:
+    std::shared_ptr<HostTransport> _socket;
+    uint64_t * _dropped;
+};
+
+class HostRelayShard : public WebSocketsServerCore {
+  public:
+    explicit HostRelayShard(HostRelay * relay) {
+        onEvent([this, relay](uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
+            switch(type) {
+                case WStype_CONNECTED:
+                    ids[num] = idFromUrl((const char *)payload);
+                    if(!ids[num].length()) {
+                        disconnect(num);
+                        break;
+                    }
+                    subscribe(num, ids[num].c_str());
+                    relay->_stats.connections++;
+                    break;
+                case WStype_DISCONNECTED:
+                    if(ids[num].length()) {
+                        relay->_stats.connections--;
+                        ids[num] = "";
+                    }
+                    break;
+                case WStype_TEXT:
+                    relay->_stats.messages++;
+                    relay->route(this, num, payload, length);
+                    break;
+                case WStype_BIN:
+                    relay->_stats.messages++;
+                    relay->routeBinary(this, num, payload, length);
+                    break;
+                default:
+                    break;
+            }
+        });
+        begin();
+    }
+
+    /**
+     * newClient() of a full core closes its last client to make room,
+     * so a connection is only handed to a shard with a free slot
+     */
+    bool hasRoom() {
+        for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+            if(!_clients[i].tcp) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    String ids[WEBSOCKETS_SERVER_CLIENT_MAX];
+
+  private:
+    static String idFromUrl(const char * url) {
+        const char * id = strstr(url, "id=");
+        if(!id) {
+            return String();
+        }
+        id += 3;
+        const char * end = strchr(id, '&');
+        String result;
+        result.concat(id, end ? end - id : strlen(id));
+        return result;
+    }
+};
+
+HostRelay::HostRelay(uint16_t port, uint32_t maxConnections)
+    : _port(port), _maxConnections(maxConnections), _pingInterval(0), _pongTimeout(0), _disconnectTimeoutCount(0), _stop(false), _in(HOST_RELAY_JSON_CAPACITY), _out(HOST_RELAY_JSON_CAPACITY) {
+}
+
+HostRelay::~HostRelay() {
+    close();
+}
+
+bool HostRelay::begin() {
+    _listener = PosixNetwork::listen(_port);
+    return _listener != nullptr;
+}
+
+void HostRelay::close() {
+    _listener.reset();
+    for(auto & shard : _shards) {
+        shard->disconnect();
+    }
+    _shards.clear();
+}
+
+void HostRelay::enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount) {
+    _pingInterval           = pingInterval;
+    _pongTimeout            = pongTimeout;
+    _disconnectTimeoutCount = disconnectTimeoutCount;
+    for(auto & shard : _shards) {
+        shard->enableHeartbeat(pingInterval, pongTimeout, disconnectTimeoutCount);
+    }
+}
+
+/**
+ * first shard with a free slot, a new one while maxConnections (rounded up to whole shards) allows it
+ * @return nullptr when the relay is full
+ */
+HostRelayShard * HostRelay::shardWithRoom() {
+    for(auto & shard : _shards) {
+        if(shard->hasRoom()) {
+            return shard.get();
+        }
+    }
+    if(_shards.size() * WEBSOCKETS_SERVER_CLIENT_MAX >= _maxConnections) {
+        return nullptr;
+    }
+    _shards.emplace_back(new HostRelayShard(this));
+    if(_pingInterval) {
+        _shards.back()->enableHeartbeat(_pingInterval, _pongTimeout, _disconnectTimeoutCount);
+    }
+    return _shards.back().get();
+}
+
+bool HostRelay::loop() {
+    bool busy = false;
+    while(_listener && _listener->pending()) {
+        HostClient * tcp       = new HostClient(std::make_shared<HostRelayTransport>(_listener->accept(), &_stats.slow));
+        HostRelayShard * shard = shardWithRoom();
+        if(!shard) {
+            tcp->stop();
+            delete tcp;
+            _stats.rejected++;
+            continue;
+        }
+        shard->newClient(tcp);
+        busy = true;
+    }
+
+    uint64_t messages = _stats.messages;
+    for(auto & shard : _shards) {
+        shard->loop();
+    }
+    return busy || _stats.messages != messages;
+}
+
+void HostRelay::run(unsigned long stopAfterMs) {
+    unsigned long start = millis();
+    while(!_stop && (!stopAfterMs || millis() - start < stopAfterMs)) {
+        if(!loop()) {
+            delay(1);
+        }
+    }
+}
+
+void HostRelay::stop() {
+    _stop = true;
+}
+
+unsigned long HostRelay::getMaxStall(bool reset) {
+    unsigned long stall = 0;
+    for(auto & shard : _shards) {
+        stall = std::max(stall, shard->getMaxStall(reset));
+    }
+    return stall;
+}
+
+/**
+ * the same message to the subscribers of topic in every shard
+ * @return number of clients it was sent to
+ */
+int HostRelay::publish(const char * topic, WSopcode_t opcode, uint8_t * payload, size_t length) {
+    int count = 0;
+    for(auto & shard : _shards) {
+        count += (opcode == WSop_binary) ? shard->publishBIN(topic, payload, length) : shard->publish(topic, payload, length);
+    }
+    _stats.delivered += count;
+    if(!count) {
+        _stats.unknown++;
+    }
+    return count;
+}
+
+void HostRelay::route(HostRelayShard * shard, uint8_t num, uint8_t * payload, size_t length) {
+    if(deserializeJson(_in, payload, length)) {
+        _stats.invalid++;
+        return;
+    }
+
+    if(_in.containsKey("register") || _in.containsKey("unregister")) {
+        for(JsonVariant id : _in["register"].as<JsonArray>()) {
+            shard->subscribe(num, id.as<const char *>());
+        }
+        for(JsonVariant id : _in["unregister"].as<JsonArray>()) {
+            // a device can not unregister itself
+            if(shard->ids[num] != id.as<const char *>()) {
+                shard->unsubscribe(num, id.as<const char *>());
+            }
+        }
+        return;
+    }
+
+    const char * targetId = _in["targetId"];
+    if(!targetId || !*targetId) {
+        _stats.invalid++;
+        return;
+    }
+
+    const char * as = _in["as"];
+    _out.clear();
+    _out["from"]    = (as && shard->isSubscribed(num, as)) ? as : shard->ids[num].c_str();
+    _out["to"]      = targetId;
+    _out["payload"] = _in["payload"];
+    if(_out.overflowed()) {
+        _stats.invalid++;
+        return;
+    }
+
+    _message = "";
+    serializeJson(_out, _message);
+    publish(targetId, WSop_text, (uint8_t *)_message.c_str(), _message.length());
+}
+
+void HostRelay::routeBinary(HostRelayShard * shard, uint8_t num, uint8_t * payload, size_t length) {
+    if(length < 1 || length < 1 + (size_t)payload[0]) {
+        _stats.invalid++;
+        return;
+    }
+
+    char targetId[256];
+    memcpy(targetId, payload + 1, payload[0]);
+    targetId[payload[0]] = 0;
+
+    // [id length][target id] becomes [id length][sender id]
+    const String & from = shard->ids[num];
+    size_t rest         = length - 1 - payload[0];
+    _binary.resize(1 + from.length() + rest);
+    _binary[0] = from.length();
+    memcpy(&_binary[1], from.c_str(), from.length());
+    memcpy(&_binary[1 + from.length()], payload + 1 + payload[0], rest);
+
+    publish(targetId, WSop_binary, _binary.data(), _binary.size());
+}
@@ -0,0 +1,124 @@
+/**
+ * @file HostRelay.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_RELAY_H_
+#define HOST_RELAY_H_
+
+// the nikolaindustry-realtime relay protocol of examples/local_relay on the host:
+// devices connect with ws://<host>:<port>/?id=<deviceId>, {"targetId": ..., "payload": ...}
+// goes to that device as {"from": <sender>, "to": <targetId>, "payload": ...}.
+// register / unregister / "as" of gateways and the binary chunks of sendFile() work like in the sketch.
+//
+// a WebSocketsServerCore numbers its clients with a uint8_t, so the connections are spread over
+// shards of WEBSOCKETS_SERVER_CLIENT_MAX clients. every device subscribes to the topic of its id
+// in its shard, a message is published on every shard.
+
+#include <ArduinoJson.h>
+#include <HostNetwork.h>
+#include <WebSocketsServer.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+typedef struct {
+    uint32_t connections = 0;    ///< devices connected with an id
+    uint64_t messages    = 0;    ///< text and binary messages received
+    uint64_t delivered   = 0;    ///< frames sent, one per subscriber of the target
+    uint64_t unknown     = 0;    ///< messages for an id nobody is connected as
+    uint64_t invalid     = 0;    ///< text that is no json, has no targetId, or does not fit
+    uint64_t rejected    = 0;    ///< connections closed because every shard was full
+    uint64_t slow        = 0;    ///< connections closed because the device did not read what was sent to it
+} HostRelayStats_t;
+
+class HostRelayShard;
+
+class HostRelay {
+  public:
+    /**
+     * @param port uint16_t
+     * @param maxConnections uint32_t  more are closed right after accept
+     */
+    explicit HostRelay(uint16_t port, uint32_t maxConnections = 10000);
+    ~HostRelay();
+
+    /**
+     * listens on all interfaces, sockets of the host whatever host::setNetwork() says
+     * @return false when the port can not be bound
+     */
+    bool begin();
+    void close();
+
+    /**
+     * accepts what is queued and serves every shard once
+     * @return true if a connection was accepted or a message received, an idle caller may sleep
+     */
+    bool loop();
+
+    /**
+     * loop() until stop() or stopAfterMs, sleeps 1 ms when a pass found nothing to do
+     * @param stopAfterMs unsigned long  0 = until stop()
+     */
+    void run(unsigned long stopAfterMs = 0);
+    void stop();
+    bool stopped() const {
+        return _stop;
+    }
+
+    void enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount);
+
+    HostRelayStats_t stats() const {
+        return _stats;
+    }
+    size_t shards() const {
+        return _shards.size();
+    }
+    unsigned long getMaxStall(bool reset = false);
+
+  private:
+    friend class HostRelayShard;
+
+    HostRelayShard * shardWithRoom();
+    void route(HostRelayShard * shard, uint8_t num, uint8_t * payload, size_t length);
+    void routeBinary(HostRelayShard * shard, uint8_t num, uint8_t * payload, size_t length);
+    int publish(const char * topic, WSopcode_t opcode, uint8_t * payload, size_t length);
+
+    uint16_t _port;
+    uint32_t _maxConnections;
+    std::shared_ptr<HostListener> _listener;
+    std::vector<std::unique_ptr<HostRelayShard>> _shards;
+    HostRelayStats_t _stats;
+
+    uint32_t _pingInterval;
+    uint32_t _pongTimeout;
+    uint8_t _disconnectTimeoutCount;
+    std::atomic<bool> _stop;
+
+    DynamicJsonDocument _in;
+    DynamicJsonDocument _out;
+    String _message;
+    std::vector<uint8_t> _binary;
+};
+
+#endif
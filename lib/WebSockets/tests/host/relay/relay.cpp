@@ -0,0 +1,84 @@
+/**
+ * @file relay.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// the relay of examples/local_relay as a PC program, see HostRelay.h
+// args: [port (8081)] [max connections (10000)]
+// prints the number of devices and messages every 5 s, stops on SIGINT / SIGTERM
+
+#include "HostRelay.h"
+
+#include <PosixNetwork.h>
+
+#include <signal.h>
+
+namespace {
+
+HostRelay * running = nullptr;
+
+void onSignal(int) {
+    if(running) {
+        running->stop();
+    }
+}
+
+}    // namespace
+
+int main(int argc, char ** argv) {
+    uint16_t port           = argc > 1 ? atoi(argv[1]) : 8081;
+    uint32_t maxConnections = argc > 2 ? strtoul(argv[2], nullptr, 10) : 10000;
+
+    unsigned long files = PosixNetwork::raiseFileLimit();
+    if(files < maxConnections + 16) {
+        printf("⚠️ open file limit is %lu, raise it (ulimit -n) for %u connections\n", files, maxConnections);
+    }
+
+    HostRelay relay(port, maxConnections);
+    if(!relay.begin()) {
+        fprintf(stderr, "❌ can not listen on port %u\n", port);
+        return 1;
+    }
+    relay.enableHeartbeat(15000, 3000, 2);
+    printf("✅ relay on ws://<this host>:%u/?id=<deviceId>, up to %u devices\n", port, maxConnections);
+
+    running = &relay;
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    HostRelayStats_t last = relay.stats();
+    unsigned long start   = millis();
+    while(!relay.stopped()) {
+        relay.run(5000);
+        HostRelayStats_t now = relay.stats();
+        float seconds        = (millis() - start) / 1000.0f;
+        start                = millis();
+        printf("devices %u  shards %zu  in %.0f/s  out %.0f/s  unknown %llu  invalid %llu  rejected %llu  slow %llu  max stall %lu us\n",
+            now.connections, relay.shards(), (now.messages - last.messages) / seconds, (now.delivered - last.delivered) / seconds,
+            (unsigned long long)now.unknown, (unsigned long long)now.invalid, (unsigned long long)now.rejected,
+            (unsigned long long)now.slow, relay.getMaxStall(true));
+        last = now;
+    }
+    relay.close();
+    return 0;
+}
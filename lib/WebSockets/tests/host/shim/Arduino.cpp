@@ -0,0 +1,371 @@
+/**
+ * @file Arduino.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+#include <HostAlloc.h>
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+HostWiFi WiFi;
+
+namespace {
+
+typedef std::chrono::steady_clock steady;
+
+const steady::time_point start = steady::now();
+
+std::atomic<bool> manual(false);
+std::atomic<uint64_t> manualUs(0);
+
+uint64_t nowUs() {
+    if(manual) {
+        return manualUs;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(steady::now() - start).count();
+}
+
+thread_local std::minstd_rand rng(1);
+
+std::string toBase(unsigned long long value, unsigned char base) {
+    if(base < 2 || base > 36) {
+        base = 10;
+    }
+    char buf[8 * sizeof(value) + 1];
+    char * p = &buf[sizeof(buf) - 1];
+    *p       = 0;
+    do {
+        unsigned digit = value % base;
+        *--p           = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while(value);
+    return p;
+}
+
+std::string signedBase(long long value, unsigned char base) {
+    if(value < 0 && base == 10) {
+        return "-" + toBase(0ULL - (unsigned long long)value, base);
+    }
+    return toBase((unsigned long long)value, base);
+}
+
+std::string fixed(double value, unsigned char decimalPlaces) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+    return buf;
+}
+
+}    // namespace
+
+namespace host {
+
+void useManualClock(uint32_t startMs) {
+    manualUs = (uint64_t)startMs * 1000;
+    manual   = true;
+}
+
+void useRealClock() {
+    manual = false;
+}
+
+void advanceMicros(uint64_t us) {
+    if(manual) {
+        manualUs += us;
+    }
+}
+
+bool manualClock() {
+    return manual;
+}
+
+uint64_t micros64() {
+    return nowUs();
+}
+
+}    // namespace host
+
+unsigned long millis() {
+    return (unsigned long)(uint32_t)(nowUs() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)(uint32_t)nowUs();
+}
+
+void delay(unsigned long ms) {
+    if(manual) {
+        host::advanceMicros((uint64_t)ms * 1000);
+    } else if(ms) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+void delayMicroseconds(unsigned int us) {
+    if(manual) {
+        host::advanceMicros(us);
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+void yield() {
+}
+
+long random(long max) {
+    return max > 0 ? (long)(rng() % (unsigned long)max) : 0;
+}
+
+long random(long min, long max) {
+    return min < max ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    rng.seed(seed ? seed : 1);
+}
+
+void pinMode(uint8_t, uint8_t) {
+}
+
+void digitalWrite(uint8_t, uint8_t) {
+}
+
+int digitalRead(uint8_t) {
+    return LOW;
+}
+
+String::String(unsigned char value, unsigned char base) : s(toBase(value, base)) {}
+String::String(int value, unsigned char base) : s(signedBase(value, base)) {}
+String::String(unsigned int value, unsigned char base) : s(toBase(value, base)) {}
+String::String(long value, unsigned char base) : s(signedBase(value, base)) {}
+String::String(unsigned long value, unsigned char base) : s(toBase(value, base)) {}
+String::String(long long value, unsigned char base) : s(signedBase(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : s(toBase(value, base)) {}
+String::String(float value, unsigned char decimalPlaces) : s(fixed(value, decimalPlaces)) {}
+String::String(double value, unsigned char decimalPlaces) : s(fixed(value, decimalPlaces)) {}
+
+void String::replace(const String & find, const String & replace) {
+    if(find.s.empty()) {
+        return;
+    }
+    size_t pos = 0;
+    while((pos = s.find(find.s, pos)) != std::string::npos) {
+        s.replace(pos, find.s.size(), replace.s);
+        pos += replace.s.size();
+    }
+}
+
+void String::trim() {
+    size_t begin = 0;
+    size_t end   = s.size();
+    while(begin < end && isspace((unsigned char)s[begin])) begin++;
+    while(end > begin && isspace((unsigned char)s[end - 1])) end--;
+    s = s.substr(begin, end - begin);
+}
+
+void String::toCharArray(char * buf, unsigned int bufsize, unsigned int index) const {
+    if(!buf || !bufsize) {
+        return;
+    }
+    size_t n = 0;
+    if(index < s.size()) {
+        n = std::min<size_t>(s.size() - index, bufsize - 1);
+        memcpy(buf, s.data() + index, n);
+    }
+    buf[n] = 0;
+}
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buf);
+}
+
+size_t Print::write(const uint8_t * buffer, size_t size) {
+    size_t n = 0;
+    while(size--) {
+        if(!write(*buffer++)) {
+            break;
+        }
+        n++;
+    }
+    return n;
+}
+
+size_t Print::printf(const char * format, ...) {
+    char small[128];
+    va_list arg;
+    va_start(arg, format);
+    int len = vsnprintf(small, sizeof(small), format, arg);
+    va_end(arg);
+    if(len < 0) {
+        return 0;
+    }
+    if((size_t)len < sizeof(small)) {
+        return write((const uint8_t *)small, len);
+    }
+    std::string big(len + 1, 0);
+    va_start(arg, format);
+    vsnprintf(&big[0], big.size(), format, arg);
+    va_end(arg);
+    return write((const uint8_t *)big.data(), len);
+}
+
+// the manual clock never moves on its own, the timeouts below would spin forever,
+// so a read that finds nothing gives up at once in that mode
+int Stream::timedRead() {
+    unsigned long begin = millis();
+    do {
+        int c = read();
+        if(c >= 0) {
+            return c;
+        }
+        if(host::manualClock()) {
+            break;
+        }
+        std::this_thread::yield();
+    } while(millis() - begin < _timeout);
+    return -1;
+}
+
+int Stream::timedPeek() {
+    unsigned long begin = millis();
+    do {
+        int c = peek();
+        if(c >= 0) {
+            return c;
+        }
+        if(host::manualClock()) {
+            break;
+        }
+        std::this_thread::yield();
+    } while(millis() - begin < _timeout);
+    return -1;
+}
+
+bool Stream::find(const char * target) {
+    size_t len   = strlen(target);
+    size_t index = 0;
+    if(!len) {
+        return true;
+    }
+    int c;
+    while((c = timedRead()) >= 0) {
+        if(c == target[index]) {
+            if(++index == len) {
+                return true;
+            }
+        } else {
+            index = (c == target[0]) ? 1 : 0;
+        }
+    }
+    return false;
+}
+
+size_t Stream::readBytes(char * buffer, size_t length) {
+    size_t count = 0;
+    while(count < length) {
+        int c = timedRead();
+        if(c < 0) {
+            break;
+        }
+        *buffer++ = (char)c;
+        count++;
+    }
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char * buffer, size_t length) {
+    size_t index = 0;
+    while(index < length) {
+        int c = timedRead();
+        if(c < 0 || c == terminator) {
+            break;
+        }
+        *buffer++ = (char)c;
+        index++;
+    }
+    return index;
+}
+
+String Stream::readString() {
+    String ret;
+    int c;
+    while((c = timedRead()) >= 0) {
+        ret += (char)c;
+    }
+    return ret;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String ret;
+    int c;
+    while((c = timedRead()) >= 0 && c != terminator) {
+        ret += (char)c;
+    }
+    return ret;
+}
+
+long Stream::parseInt() {
+    int c;
+    while((c = timedPeek()) >= 0 && c != '-' && !isdigit(c)) {
+        read();
+    }
+    bool negative = false;
+    long value    = 0;
+    if(c == '-') {
+        negative = true;
+        read();
+    }
+    while((c = timedPeek()) >= 0 && isdigit(c)) {
+        value = value * 10 + (c - '0');
+        read();
+    }
+    return negative ? -value : value;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t * buffer, size_t size) {
+    if(!_muted) {
+        fwrite(buffer, 1, size, stdout);
+        fflush(stdout);
+    }
+    return size;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    const int64_t heap = 320 * 1024;
+    int64_t used       = host::allocStats().current;
+    return used < heap ? (uint32_t)(heap - used) : 0;
+}
@@ -0,0 +1,455 @@
+/**
+ * @file Arduino.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+// the part of the Arduino core api the library, ArduinoHttpClient and the
+// nikolaindustry facade use, backed by the C/C++ runtime of the host
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <string>
+#include <algorithm>
+#include <type_traits>
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define PROGMEM
+#define PGM_P const char *
+#define F(string_literal) (string_literal)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define memcpy_P memcpy
+
+#define bit(b) (1UL << (b))
+#define lowByte(w) ((uint8_t)((w)&0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::max;
+using std::min;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+inline bool isHexadecimalDigit(int c) { return isxdigit(c); }
+inline bool isAlphaNumeric(int c) { return isalnum(c); }
+inline bool isSpace(int c) { return isspace(c); }
+inline bool isDigit(int c) { return isdigit(c); }
+
+namespace host {
+
+/**
+ * switch millis() / micros() to a clock that only moves by advance() or delay()
+ * @param startMs uint32_t millis() right after the switch
+ */
+void useManualClock(uint32_t startMs = 0);
+
+/**
+ * back to the monotonic clock of the host
+ */
+void useRealClock();
+
+/**
+ * moves the manual clock forward, no-op on the real clock
+ * @param us uint64_t
+ */
+void advanceMicros(uint64_t us);
+
+inline void advance(uint32_t ms) {
+    advanceMicros((uint64_t)ms * 1000);
+}
+
+/**
+ * true while millis() is driven by advance()
+ */
+bool manualClock();
+
+/**
+ * micros() without the 32 bit wrap
+ */
+uint64_t micros64();
+
+}    // namespace host
+
+class __FlashStringHelper;
+
+class String {
+  public:
+    String() {}
+    String(const char * cstr) : s(cstr ? cstr : "") {}
+    String(const std::string & str) : s(str) {}
+    String(char c) : s(1, c) {}
+    String(unsigned char value, unsigned char base = 10);
+    String(int value, unsigned char base = 10);
+    String(unsigned int value, unsigned char base = 10);
+    String(long value, unsigned char base = 10);
+    String(unsigned long value, unsigned char base = 10);
+    String(long long value, unsigned char base = 10);
+    String(unsigned long long value, unsigned char base = 10);
+    String(float value, unsigned char decimalPlaces = 2);
+    String(double value, unsigned char decimalPlaces = 2);
+
+    const char * c_str() const {
+        return s.c_str();
+    }
+    unsigned int length() const {
+        return s.size();
+    }
+    bool isEmpty() const {
+        return s.empty();
+    }
+    bool reserve(unsigned int size) {
+        s.reserve(size);
+        return true;
+    }
+    void clear() {
+        s.clear();
+    }
+
+    bool concat(const String & str) {
+        s += str.s;
+        return true;
+    }
+    bool concat(const char * cstr) {
+        if(cstr) s += cstr;
+        return true;
+    }
+    bool concat(const char * cstr, unsigned int length) {
+        if(cstr) s.append(cstr, length);
+        return true;
+    }
+    bool concat(char c) {
+        s += c;
+        return true;
+    }
+    template<typename T>
+    bool concat(T value) {
+        return concat(String(value));
+    }
+
+    template<typename T>
+    String & operator+=(const T & rhs) {
+        concat(rhs);
+        return *this;
+    }
+
+    char charAt(unsigned int index) const {
+        return index < s.size() ? s[index] : 0;
+    }
+    void setCharAt(unsigned int index, char c) {
+        if(index < s.size()) s[index] = c;
+    }
+    char operator[](unsigned int index) const {
+        return charAt(index);
+    }
+    char & operator[](unsigned int index) {
+        return s[index];
+    }
+
+    int compareTo(const String & str) const {
+        return s.compare(str.s);
+    }
+    bool equals(const String & str) const {
+        return s == str.s;
+    }
+    bool equals(const char * cstr) const {
+        return s == (cstr ? cstr : "");
+    }
+    bool equalsIgnoreCase(const String & str) const {
+        return s.size() == str.s.size() && strcasecmp(s.c_str(), str.s.c_str()) == 0;
+    }
+    bool startsWith(const String & prefix) const {
+        return s.compare(0, prefix.s.size(), prefix.s) == 0;
+    }
+    bool startsWith(const String & prefix, unsigned int offset) const {
+        return offset <= s.size() && s.compare(offset, prefix.s.size(), prefix.s) == 0;
+    }
+    bool endsWith(const String & suffix) const {
+        return s.size() >= suffix.s.size() && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+    }
+
+    bool operator==(const String & rhs) const {
+        return s == rhs.s;
+    }
+    bool operator==(const char * cstr) const {
+        return equals(cstr);
+    }
+    bool operator!=(const String & rhs) const {
+        return s != rhs.s;
+    }
+    bool operator!=(const char * cstr) const {
+        return !equals(cstr);
+    }
+    bool operator<(const String & rhs) const {
+        return s < rhs.s;
+    }
+
+    int indexOf(char ch, unsigned int fromIndex = 0) const {
+        return found(s.find(ch, fromIndex));
+    }
+    int indexOf(const String & str, unsigned int fromIndex = 0) const {
+        return found(s.find(str.s, fromIndex));
+    }
+    int lastIndexOf(char ch) const {
+        return found(s.rfind(ch));
+    }
+    int lastIndexOf(const String & str) const {
+        return found(s.rfind(str.s));
+    }
+    String substring(unsigned int beginIndex) const {
+        return beginIndex < s.size() ? String(s.substr(beginIndex)) : String();
+    }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const {
+        if(beginIndex > endIndex) std::swap(beginIndex, endIndex);
+        if(beginIndex >= s.size()) return String();
+        return String(s.substr(beginIndex, endIndex - beginIndex));
+    }
+
+    void replace(const String & find, const String & replace);
+    void remove(unsigned int index) {
+        if(index < s.size()) s.erase(index);
+    }
+    void remove(unsigned int index, unsigned int count) {
+        if(index < s.size()) s.erase(index, count);
+    }
+    void toLowerCase() {
+        for(auto & c : s) c = tolower((unsigned char)c);
+    }
+    void toUpperCase() {
+        for(auto & c : s) c = toupper((unsigned char)c);
+    }
+    void trim();
+
+    long toInt() const {
+        return atol(s.c_str());
+    }
+    float toFloat() const {
+        return atof(s.c_str());
+    }
+    void toCharArray(char * buf, unsigned int bufsize, unsigned int index = 0) const;
+    void getBytes(unsigned char * buf, unsigned int bufsize, unsigned int index = 0) const {
+        toCharArray((char *)buf, bufsize, index);
+    }
+
+  private:
+    static int found(size_t pos) {
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    std::string s;
+};
+
+// only when one side is a String, numbers keep their built-in +
+template<typename L, typename R, typename = typename std::enable_if<std::is_same<L, String>::value || std::is_same<R, String>::value>::type>
+inline String operator+(const L & lhs, const R & rhs) {
+    String r(lhs);
+    r.concat(rhs);
+    return r;
+}
+
+class Printable;
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t * buffer, size_t size);
+    size_t write(const char * str) {
+        return str ? write((const uint8_t *)str, strlen(str)) : 0;
+    }
+    size_t write(const char * buffer, size_t size) {
+        return write((const uint8_t *)buffer, size);
+    }
+    virtual int availableForWrite() {
+        return 0;
+    }
+    virtual void flush() {}
+
+    size_t print(const String & s) {
+        return write(s.c_str(), s.length());
+    }
+    size_t print(const char * str) {
+        return write(str);
+    }
+    size_t print(char c) {
+        return write((uint8_t)c);
+    }
+    size_t print(unsigned char n, int base = 10) {
+        return print((unsigned long)n, base);
+    }
+    size_t print(int n, int base = 10) {
+        return print((long)n, base);
+    }
+    size_t print(unsigned int n, int base = 10) {
+        return print((unsigned long)n, base);
+    }
+    size_t print(long n, int base = 10) {
+        return print(String(n, base));
+    }
+    size_t print(unsigned long n, int base = 10) {
+        return print(String(n, base));
+    }
+    size_t print(long long n, int base = 10) {
+        return print(String(n, base));
+    }
+    size_t print(unsigned long long n, int base = 10) {
+        return print(String(n, base));
+    }
+    size_t print(double n, int digits = 2) {
+        return print(String(n, digits));
+    }
+    size_t print(const Printable & p);
+
+    template<typename T>
+    size_t println(const T & v) {
+        size_t n = print(v);
+        return n + println();
+    }
+    template<typename T>
+    size_t println(const T & v, int format) {
+        size_t n = print(v, format);
+        return n + println();
+    }
+    size_t println() {
+        return write("\r\n");
+    }
+
+    size_t printf(const char * format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Printable {
+  public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print & p) const = 0;
+};
+
+inline size_t Print::print(const Printable & p) {
+    return p.printTo(*this);
+}
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) {
+        _timeout = timeout;
+    }
+    unsigned long getTimeout() const {
+        return _timeout;
+    }
+
+    bool find(const char * target);
+    size_t readBytes(char * buffer, size_t length);
+    size_t readBytes(uint8_t * buffer, size_t length) {
+        return readBytes((char *)buffer, length);
+    }
+    size_t readBytesUntil(char terminator, char * buffer, size_t length);
+    size_t readBytesUntil(char terminator, uint8_t * buffer, size_t length) {
+        return readBytesUntil(terminator, (char *)buffer, length);
+    }
+    String readString();
+    String readStringUntil(char terminator);
+    long parseInt();
+
+  protected:
+    int timedRead();
+    int timedPeek();
+    unsigned long _timeout = 1000;
+};
+
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long) {}
+    void end() {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t * buffer, size_t size) override;
+    using Print::write;
+    int available() override {
+        return 0;
+    }
+    int read() override {
+        return -1;
+    }
+    int peek() override {
+        return -1;
+    }
+    operator bool() const {
+        return true;
+    }
+
+    /**
+     * drops everything printed, benchmarks keep the console quiet with it
+     * @param on bool
+     */
+    void mute(bool on) {
+        _muted = on;
+    }
+
+  private:
+    bool _muted = false;
+};
+
+extern HardwareSerial Serial;
+
+// the heap of an ESP32 less what the host process holds (HostAlloc.cpp), so
+// sketches that print ESP.getFreeHeap() show what they use
+class EspClass {
+  public:
+    uint32_t getFreeHeap();
+};
+
+extern EspClass ESP;
+
+#include "IPAddress.h"
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * @file Client.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_CLIENT_H_
+#define HOST_CLIENT_H_
+
+#include "Arduino.h"
+
+class Client : public Stream {
+  public:
+    virtual int connect(IPAddress ip, uint16_t port)       = 0;
+    virtual int connect(const char * host, uint16_t port)  = 0;
+    virtual size_t write(uint8_t c)                        = 0;
+    virtual size_t write(const uint8_t * buf, size_t size) = 0;
+    virtual int available()                                = 0;
+    virtual int read()                                     = 0;
+    virtual int read(uint8_t * buf, size_t size)           = 0;
+    virtual int peek()                                     = 0;
+    virtual void flush()                                   = 0;
+    virtual void stop()                                    = 0;
+    virtual uint8_t connected()                            = 0;
+    virtual operator bool()                                = 0;
+    using Print::write;
+};
+
+#endif
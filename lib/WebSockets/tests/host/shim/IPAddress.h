@@ -0,0 +1,76 @@
+/**
+ * @file IPAddress.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_IPADDRESS_H_
+#define HOST_IPADDRESS_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+class String;
+
+class IPAddress {
+  public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+        _bytes[0] = a;
+        _bytes[1] = b;
+        _bytes[2] = c;
+        _bytes[3] = d;
+    }
+    IPAddress(uint32_t address) {
+        memcpy(_bytes, &address, 4);
+    }
+
+    operator uint32_t() const {
+        uint32_t address;
+        memcpy(&address, _bytes, 4);
+        return address;
+    }
+    bool operator==(const IPAddress & rhs) const {
+        return memcmp(_bytes, rhs._bytes, 4) == 0;
+    }
+    uint8_t operator[](int index) const {
+        return _bytes[index];
+    }
+    uint8_t & operator[](int index) {
+        return _bytes[index];
+    }
+
+    bool fromString(const char * address) {
+        unsigned int a, b, c, d;
+        if(!address || sscanf(address, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+            return false;
+        }
+        *this = IPAddress(a, b, c, d);
+        return true;
+    }
+    String toString() const;
+
+  private:
+    uint8_t _bytes[4] = { 0, 0, 0, 0 };
+};
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * @file WiFi.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_WIFI_H_
+#define HOST_WIFI_H_
+
+#include "Arduino.h"
+
+typedef enum {
+    WL_IDLE_STATUS     = 0,
+    WL_NO_SSID_AVAIL   = 1,
+    WL_CONNECTED       = 3,
+    WL_CONNECT_FAILED  = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED    = 6
+} wl_status_t;
+
+// the host is always online, setStatus() lets a test take the link down
+class HostWiFi {
+  public:
+    wl_status_t begin(const char *, const char * = nullptr) {
+        return _status;
+    }
+    wl_status_t status() const {
+        return _status;
+    }
+    void setStatus(wl_status_t status) {
+        _status = status;
+    }
+    IPAddress localIP() const {
+        return IPAddress(127, 0, 0, 1);
+    }
+    IPAddress broadcastIP() const {
+        return IPAddress(127, 255, 255, 255);
+    }
+
+  private:
+    wl_status_t _status = WL_CONNECTED;
+};
+
+extern HostWiFi WiFi;
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @file WiFiUdp.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_WIFIUDP_H_
+#define HOST_WIFIUDP_H_
+
+#include "Arduino.h"
+
+// LAN discovery is not part of the host runs, packets go nowhere and none arrive
+class WiFiUDP : public Stream {
+  public:
+    uint8_t begin(uint16_t) {
+        return 1;
+    }
+    void stop() {}
+    int beginPacket(IPAddress, uint16_t) {
+        return 1;
+    }
+    int endPacket() {
+        return 1;
+    }
+    int parsePacket() {
+        return 0;
+    }
+    IPAddress remoteIP() const {
+        return IPAddress();
+    }
+    uint16_t remotePort() const {
+        return 0;
+    }
+    size_t write(uint8_t) override {
+        return 1;
+    }
+    size_t write(const uint8_t *, size_t size) override {
+        return size;
+    }
+    using Print::write;
+    int available() override {
+        return 0;
+    }
+    int read() override {
+        return -1;
+    }
+    int read(unsigned char *, size_t) {
+        return 0;
+    }
+    int read(char *, size_t) {
+        return 0;
+    }
+    int peek() override {
+        return -1;
+    }
+};
+
+#endif
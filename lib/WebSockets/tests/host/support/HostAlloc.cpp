@@ -0,0 +1,156 @@
+/**
+ * @file HostAlloc.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "HostAlloc.h"
+
+#include <atomic>
+#include <stddef.h>
+#include <errno.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+extern "C" {
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t n, size_t size);
+void * __libc_realloc(void * ptr, size_t size);
+void * __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void * ptr);
+}
+#endif
+
+namespace {
+
+std::atomic<uint64_t> allocs(0);
+std::atomic<uint64_t> frees(0);
+std::atomic<int64_t> current(0);
+std::atomic<int64_t> peak(0);
+
+void added(void * ptr) {
+#if defined(__GLIBC__)
+    if(!ptr) {
+        return;
+    }
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    int64_t now  = current.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed) + malloc_usable_size(ptr);
+    int64_t high = peak.load(std::memory_order_relaxed);
+    while(now > high && !peak.compare_exchange_weak(high, now, std::memory_order_relaxed)) {
+    }
+#else
+    (void)ptr;
+#endif
+}
+
+void removed(void * ptr) {
+#if defined(__GLIBC__)
+    if(!ptr) {
+        return;
+    }
+    frees.fetch_add(1, std::memory_order_relaxed);
+    current.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+#else
+    (void)ptr;
+#endif
+}
+
+}    // namespace
+
+namespace host {
+
+HostAllocStats_t allocStats() {
+    HostAllocStats_t stats;
+    stats.allocs  = allocs.load(std::memory_order_relaxed);
+    stats.frees   = frees.load(std::memory_order_relaxed);
+    stats.current = current.load(std::memory_order_relaxed);
+    stats.peak    = peak.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void resetAllocPeak() {
+    peak.store(current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+bool allocCounting() {
+#if defined(__GLIBC__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+}    // namespace host
+
+#if defined(__GLIBC__)
+// operator new / delete of libstdc++ end up here as well
+extern "C" {
+
+void * malloc(size_t size) {
+    void * ptr = __libc_malloc(size);
+    added(ptr);
+    return ptr;
+}
+
+void * calloc(size_t n, size_t size) {
+    void * ptr = __libc_calloc(n, size);
+    added(ptr);
+    return ptr;
+}
+
+void * realloc(void * ptr, size_t size) {
+    removed(ptr);
+    void * moved = __libc_realloc(ptr, size);
+    if(!moved && size) {
+        added(ptr);    // the old block is still valid
+        return moved;
+    }
+    added(moved);
+    return moved;
+}
+
+void free(void * ptr) {
+    removed(ptr);
+    __libc_free(ptr);
+}
+
+void * memalign(size_t alignment, size_t size) {
+    void * ptr = __libc_memalign(alignment, size);
+    added(ptr);
+    return ptr;
+}
+
+void * aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void ** out, size_t alignment, size_t size) {
+    void * ptr = memalign(alignment, size);
+    if(!ptr && size) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+}    // extern "C"
+#endif
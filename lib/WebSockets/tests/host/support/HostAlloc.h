@@ -0,0 +1,57 @@
+/**
+ * @file HostAlloc.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_ALLOC_H_
+#define HOST_ALLOC_H_
+
+#include <stdint.h>
+
+typedef struct {
+    uint64_t allocs;     ///< malloc / calloc / realloc / new calls since start
+    uint64_t frees;
+    int64_t current;     ///< bytes held now (usable size of the blocks)
+    int64_t peak;        ///< high water mark of current since resetPeak()
+} HostAllocStats_t;
+
+namespace host {
+
+/**
+ * counters of the malloc wrappers in HostAlloc.cpp, all threads together.
+ * only glibc lets the wrappers reach the real allocator, elsewhere the counters stay 0
+ */
+HostAllocStats_t allocStats();
+
+/**
+ * starts a new high water mark at the bytes held now
+ */
+void resetAllocPeak();
+
+/**
+ * false when the wrappers are not active on this platform
+ */
+bool allocCounting();
+
+}    // namespace host
+
+#endif
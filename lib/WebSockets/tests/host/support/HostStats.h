@@ -0,0 +1,72 @@
+/**
+ * @file HostStats.h
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HOST_STATS_H_
+#define HOST_STATS_H_
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+/**
+ * keeps every sample, percentiles sort a copy.
+ * reserve() up front, add() does not allocate below that count
+ */
+class HostLatency {
+  public:
+    void reserve(size_t count) {
+        _samples.reserve(count);
+    }
+    void add(uint32_t us) {
+        _samples.push_back(us);
+    }
+    void clear() {
+        _samples.clear();
+    }
+    size_t count() const {
+        return _samples.size();
+    }
+    void merge(const HostLatency & other) {
+        _samples.insert(_samples.end(), other._samples.begin(), other._samples.end());
+    }
+
+    /**
+     * @param p double 0..100
+     * @return sample at the nearest rank, 0 without samples
+     */
+    uint32_t percentile(double p) const {
+        if(_samples.empty()) {
+            return 0;
+        }
+        std::vector<uint32_t> sorted(_samples);
+        size_t rank = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+        return sorted[rank];
+    }
+
+  private:
+    std::vector<uint32_t> _samples;
+};
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * @file test_codec.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// libbase64 against RFC 4648, the ArduinoHttpClient wrapper and the
+// Sec-WebSocket-Accept key (libsha1 + libbase64) against RFC 6455
+
+#include <gtest/gtest.h>
+
+#include <WebSocketsClient.h>
+#include <b64.h>
+#include <libbase64/libbase64.h>
+
+#include <string>
+
+namespace {
+
+struct Vector {
+    const char * plain;
+    const char * encoded;
+};
+
+// RFC 4648, section 10
+const Vector rfc4648[] = {
+    { "", "" },
+    { "f", "Zg==" },
+    { "fo", "Zm8=" },
+    { "foo", "Zm9v" },
+    { "foob", "Zm9vYg==" },
+    { "fooba", "Zm9vYmE=" },
+    { "foobar", "Zm9vYmFy" },
+};
+
+std::string encode(const std::string & plain) {
+    std::string out(BASE64_ENCODED_SIZE(plain.size()), '?');
+    size_t n = base64Encode((const uint8_t *)plain.data(), plain.size(), &out[0]);
+    out.resize(n);
+    return out;
+}
+
+int decode(const std::string & encoded, std::string & plain) {
+    plain.assign(BASE64_DECODED_SIZE(encoded.size()), '?');
+    int n = base64Decode(encoded.data(), encoded.size(), (uint8_t *)&plain[0], plain.size());
+    if(n >= 0) {
+        plain.resize(n);
+    }
+    return n;
+}
+
+TEST(Base64, EncodesRfc4648Vectors) {
+    for(const Vector & v : rfc4648) {
+        EXPECT_EQ(encode(v.plain), v.encoded) << v.plain;
+    }
+}
+
+TEST(Base64, DecodesRfc4648Vectors) {
+    for(const Vector & v : rfc4648) {
+        std::string plain;
+        EXPECT_EQ(decode(v.encoded, plain), (int)strlen(v.plain)) << v.encoded;
+        EXPECT_EQ(plain, v.plain);
+    }
+}
+
+TEST(Base64, RoundTripsAllByteValues) {
+    for(size_t length = 0; length < 300; length++) {
+        std::string data;
+        for(size_t i = 0; i < length; i++) {
+            data += (char)((i * 7 + length) & 0xFF);
+        }
+        std::string back;
+        ASSERT_EQ(decode(encode(data), back), (int)length);
+        EXPECT_EQ(back, data);
+    }
+}
+
+TEST(Base64, RejectsMalformedInput) {
+    std::string plain;
+    EXPECT_EQ(decode("Zm9", plain), -1);         // not a multiple of 4
+    EXPECT_EQ(decode("Zm9v!A==", plain), -1);    // invalid character
+    EXPECT_EQ(decode("Zg==Zm8=", plain), -1);    // padding in the middle
+    EXPECT_EQ(decode("Z===", plain), -1);        // three pad characters
+    EXPECT_EQ(decode("Zh==", plain), -1);        // bits set after the last byte
+    EXPECT_EQ(decode("Zm9=", plain), -1);
+}
+
+TEST(Base64, DecodeNeedsRoom) {
+    uint8_t out[3];
+    EXPECT_EQ(base64Decode("Zm9vYg==", 8, out, sizeof(out)), -1);
+    EXPECT_EQ(base64Decode("Zm9v", 4, out, sizeof(out)), 3);
+}
+
+TEST(Base64, HttpClientWrapperKeepsItsContract) {
+    unsigned char out[16];
+    EXPECT_EQ(b64_encode((const unsigned char *)"foob", 4, out, 7), 8);    // too small, needed length
+    EXPECT_EQ(b64_encode((const unsigned char *)"foob", 4, out, sizeof(out)), 8);
+    EXPECT_EQ(std::string((char *)out, 8), "Zm9vYg==");
+}
+
+class KeyProbe : public WebSocketsClient {
+  public:
+    using WebSockets::acceptKey;
+};
+
+TEST(AcceptKey, MatchesRfc6455Example) {
+    // RFC 6455, section 1.3
+    const char key[] = "dGhlIHNhbXBsZSBub25jZQ==";
+    char accept[WEBSOCKETS_ACCEPT_KEY_SIZE];
+    KeyProbe probe;
+    ASSERT_TRUE(probe.acceptKey(key, strlen(key), accept));
+    EXPECT_STREQ(accept, "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+}
+
+}    // namespace
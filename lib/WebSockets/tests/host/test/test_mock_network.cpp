@@ -0,0 +1,251 @@
+/**
+ * @file test_mock_network.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// MockNetwork link model and a WebSocketsServer / WebSocketsClient round trip on it
+
+#include <gtest/gtest.h>
+
+#include <MockNetwork.h>
+#include <WebSocketsClient.h>
+#include <WebSocketsServer.h>
+
+namespace {
+
+class MockNetworkTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        host::useManualClock(1000);
+        MockNetwork::setLink(HostLink_t());
+        MockNetwork::seed(1);
+    }
+    void TearDown() override {
+        MockNetwork::setLink(HostLink_t());
+        host::useRealClock();
+    }
+
+    void pair(HostServer & server, HostClient & client, HostClient & accepted) {
+        server.begin();
+        ASSERT_TRUE(client.connect("localhost", server.port()));
+        ASSERT_TRUE(server.hasClient());
+        accepted = server.accept();
+        ASSERT_TRUE(accepted.connected());
+    }
+};
+
+TEST_F(MockNetworkTest, ConnectNeedsListener) {
+    HostClient client;
+    EXPECT_FALSE(client.connect("localhost", 9));
+    EXPECT_FALSE(client.connected());
+}
+
+TEST_F(MockNetworkTest, LatencyDelaysDelivery) {
+    HostLink_t link;
+    link.latencyUs = 5000;
+    MockNetwork::setLink(link);
+    HostServer server(8001);
+    HostClient client, accepted;
+    pair(server, client, accepted);
+
+    EXPECT_EQ(client.write((const uint8_t *)"hello", 5), 5u);
+    EXPECT_EQ(accepted.available(), 0);
+    host::advanceMicros(4999);
+    EXPECT_EQ(accepted.available(), 0);
+    host::advanceMicros(1);
+    EXPECT_EQ(accepted.available(), 5);
+
+    char buf[8] = { 0 };
+    EXPECT_EQ(accepted.read((uint8_t *)buf, sizeof(buf)), 5);
+    EXPECT_STREQ(buf, "hello");
+}
+
+TEST_F(MockNetworkTest, BandwidthPacesSegments) {
+    HostLink_t link;
+    link.bytesPerSecond = 100000;    // 100 bytes per ms
+    link.segmentSize    = 100;
+    MockNetwork::setLink(link);
+    HostServer server(8002);
+    HostClient client, accepted;
+    pair(server, client, accepted);
+
+    uint8_t data[300];
+    memset(data, 'x', sizeof(data));
+    client.write(data, sizeof(data));
+    EXPECT_EQ(accepted.available(), 0);
+    host::advance(1);
+    EXPECT_EQ(accepted.available(), 100);
+    host::advance(1);
+    EXPECT_EQ(accepted.available(), 200);
+    host::advance(1);
+    EXPECT_EQ(accepted.available(), 300);
+}
+
+TEST_F(MockNetworkTest, LossHoldsBackLaterSegments) {
+    HostLink_t link;
+    link.segmentSize = 10;
+    link.loss        = 1;
+    link.rtoUs       = 20000;
+    MockNetwork::setLink(link);
+    HostServer server(8003);
+    HostClient client, accepted;
+    pair(server, client, accepted);
+
+    client.write((const uint8_t *)"0123456789abcdefghij", 20);
+    host::advance(19);
+    EXPECT_EQ(accepted.available(), 0);
+    host::advance(1);
+    EXPECT_EQ(accepted.available(), 20);
+}
+
+TEST_F(MockNetworkTest, CloseAfterDataIsRead) {
+    HostServer server(8004);
+    HostClient client, accepted;
+    pair(server, client, accepted);
+
+    client.write((const uint8_t *)"bye", 3);
+    client.stop();
+    EXPECT_FALSE(client.connected());
+    EXPECT_TRUE(accepted.connected());
+    uint8_t buf[4];
+    EXPECT_EQ(accepted.read(buf, sizeof(buf)), 3);
+    EXPECT_FALSE(accepted.connected());
+    EXPECT_EQ(accepted.write(buf, 3), 0u);
+}
+
+TEST_F(MockNetworkTest, CopiesShareTheConnection) {
+    HostServer server(8005);
+    HostClient client, accepted;
+    pair(server, client, accepted);
+
+    HostClient copy(accepted);
+    client.write((const uint8_t *)"a", 1);
+    EXPECT_EQ(copy.read(), 'a');
+    EXPECT_EQ(accepted.available(), 0);
+    copy.stop();
+    EXPECT_FALSE(accepted.connected());
+}
+
+TEST(WebSocketsOnMock, OneLoopAcceptsAllQueued) {
+    MockNetwork::setLink(HostLink_t());
+    WebSocketsServer server(8006);
+    server.begin();
+
+    HostClient raw[3];
+    for(auto & client : raw) {
+        ASSERT_TRUE(client.connect("localhost", 8006));
+    }
+    server.loop();
+    for(uint8_t num = 0; num < 3; num++) {
+        EXPECT_TRUE(server.clientIsConnected(num));
+    }
+}
+
+TEST(WebSocketsOnMock, EchoRoundTrip) {
+    MockNetwork::setLink(HostLink_t());
+    Serial.mute(true);
+
+    WebSocketsServer server(8007);
+    server.onEvent([&](uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
+        if(type == WStype_TEXT) {
+            server.sendTXT(num, payload, length);
+        }
+    });
+    server.begin();
+
+    String received;
+    bool connected = false;
+    WebSocketsClient client;
+    client.onEvent([&](WStype_t type, uint8_t * payload, size_t length) {
+        if(type == WStype_CONNECTED) {
+            connected = true;
+        } else if(type == WStype_TEXT) {
+            received = String((const char *)payload);
+        }
+    });
+    client.begin("localhost", 8007, "/");
+
+    unsigned long start = millis();
+    while(!connected && millis() - start < 2000) {
+        client.loop();
+        server.loop();
+    }
+    ASSERT_TRUE(connected);
+
+    client.sendTXT("ping over mock");
+    start = millis();
+    while(!received.length() && millis() - start < 2000) {
+        client.loop();
+        server.loop();
+    }
+    EXPECT_EQ(received, "ping over mock");
+
+    start = millis();
+    client.disconnect();
+    server.loop();
+    EXPECT_LT(millis() - start, 100ul);
+}
+
+TEST(WebSocketsOnMock, PartialHeaderLineKeepsBudget) {
+    MockNetwork::setLink(HostLink_t());
+    Serial.mute(true);
+
+    WebSocketsServer server(8008);
+    bool connected = false;
+    server.onEvent([&](uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
+        if(type == WStype_CONNECTED) {
+            connected = true;
+        }
+    });
+    server.begin();
+
+    static const char request[] =
+        "GET / HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Connection: Upgrade\r\n"
+        "Upgrade: websocket\r\n"
+        "Sec-WebSocket-Version: 13\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+        "\r\n";
+    // ends in the middle of the Upgrade line
+    size_t split = strstr(request, "websocket") - request;
+    HostClient raw;
+    ASSERT_TRUE(raw.connect("localhost", 8008));
+    raw.write((const uint8_t *)request, split);
+
+    // the rest of the line is not waited for
+    unsigned long start = millis();
+    for(int i = 0; i < 3; i++) {
+        server.loop(1000);
+    }
+    EXPECT_LT(millis() - start, 100ul);
+    EXPECT_FALSE(connected);
+
+    raw.write((const uint8_t *)request + split, sizeof(request) - 1 - split);
+    start = millis();
+    while(!connected && millis() - start < 2000) {
+        server.loop(1000);
+    }
+    EXPECT_TRUE(connected);
+}
+
+}    // namespace
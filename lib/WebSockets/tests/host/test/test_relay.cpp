@@ -0,0 +1,248 @@
+/**
+ * @file test_relay.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// HostRelay (relay/) on the sockets of the host: routing, gateways, binary chunks, shards
+
+#include <gtest/gtest.h>
+
+#include <HostRelay.h>
+#include <WebSocketsClient.h>
+
+#include <functional>
+#include <vector>
+
+namespace {
+
+class RelayTest : public ::testing::Test {
+  protected:
+    static const uint16_t port = 18301;
+
+    void SetUp() override {
+        host::setNetwork(HOST_NETWORK_POSIX);
+        Serial.mute(true);
+        ASSERT_TRUE(relay.begin());
+    }
+    void TearDown() override {
+        for(auto & device : devices) {
+            device->client.disconnect();
+        }
+        relay.close();
+        host::setNetwork(HOST_NETWORK_MOCK);
+    }
+
+    struct Device {
+        WebSocketsClient client;
+        bool connected = false;
+        String text;
+        std::vector<uint8_t> binary;
+    };
+
+    Device & device(const char * id) {
+        devices.emplace_back(new Device());
+        Device & d = *devices.back();
+        d.client.onEvent([&d](WStype_t type, uint8_t * payload, size_t length) {
+            if(type == WStype_CONNECTED) {
+                d.connected = true;
+            } else if(type == WStype_DISCONNECTED) {
+                d.connected = false;
+            } else if(type == WStype_TEXT) {
+                d.text = String((const char *)payload);
+            } else if(type == WStype_BIN) {
+                d.binary.assign(payload, payload + length);
+            }
+        });
+        String url = "/?id=";
+        url += id;
+        d.client.begin("localhost", port, url.c_str());
+        return d;
+    }
+
+    bool until(std::function<bool()> done, unsigned long timeoutMs = 2000) {
+        unsigned long start = millis();
+        while(!done()) {
+            if(millis() - start > timeoutMs) {
+                return false;
+            }
+            for(auto & device : devices) {
+                device->client.loop();
+            }
+            relay.loop();
+        }
+        return true;
+    }
+
+    HostRelay relay{ port, 1000 };
+    std::vector<std::unique_ptr<Device>> devices;
+};
+
+TEST_F(RelayTest, AddsFromAndTo) {
+    Device & a = device("a");
+    Device & b = device("b");
+    ASSERT_TRUE(until([&]() { return a.connected && b.connected; }));
+    EXPECT_EQ(relay.stats().connections, 2u);
+
+    a.client.sendTXT("{\"targetId\":\"b\",\"payload\":{\"x\":1}}");
+    ASSERT_TRUE(until([&]() { return b.text.length() > 0; }));
+    EXPECT_EQ(b.text, "{\"from\":\"a\",\"to\":\"b\",\"payload\":{\"x\":1}}");
+    EXPECT_EQ(a.text.length(), 0u);
+}
+
+TEST_F(RelayTest, CountsUnknownAndInvalid) {
+    Device & a = device("a");
+    ASSERT_TRUE(until([&]() { return a.connected; }));
+
+    a.client.sendTXT("{\"targetId\":\"nobody\",\"payload\":1}");
+    a.client.sendTXT("{\"payload\":1}");
+    a.client.sendTXT("not json");
+    ASSERT_TRUE(until([&]() { return relay.stats().messages == 3; }));
+    EXPECT_EQ(relay.stats().unknown, 1u);
+    EXPECT_EQ(relay.stats().invalid, 2u);
+    EXPECT_EQ(relay.stats().delivered, 0u);
+}
+
+TEST_F(RelayTest, ClosesConnectionWithoutId) {
+    HostClient raw;
+    ASSERT_TRUE(raw.connect("localhost", port));
+    static const char request[] =
+        "GET / HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Connection: Upgrade\r\n"
+        "Upgrade: websocket\r\n"
+        "Sec-WebSocket-Version: 13\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+        "\r\n";
+    raw.write((const uint8_t *)request, sizeof(request) - 1);
+    EXPECT_TRUE(until([&]() {
+        uint8_t buf[256];
+        while(raw.read(buf, sizeof(buf)) > 0) {
+        }
+        return !raw.connected();
+    }));
+    EXPECT_EQ(relay.stats().connections, 0u);
+}
+
+TEST_F(RelayTest, GatewaySpeaksForRegisteredIds) {
+    Device & gateway = device("gw");
+    Device & app     = device("app");
+    ASSERT_TRUE(until([&]() { return gateway.connected && app.connected; }));
+
+    gateway.client.sendTXT("{\"register\":[\"sensor-1\"]}");
+    app.client.sendTXT("{\"targetId\":\"sensor-1\",\"payload\":\"read\"}");
+    ASSERT_TRUE(until([&]() { return gateway.text.length() > 0; }));
+    EXPECT_EQ(gateway.text, "{\"from\":\"app\",\"to\":\"sensor-1\",\"payload\":\"read\"}");
+
+    // "as" only for ids the gateway registered
+    gateway.client.sendTXT("{\"targetId\":\"app\",\"as\":\"sensor-1\",\"payload\":1}");
+    ASSERT_TRUE(until([&]() { return app.text.length() > 0; }));
+    EXPECT_EQ(app.text, "{\"from\":\"sensor-1\",\"to\":\"app\",\"payload\":1}");
+    app.text = "";
+    gateway.client.sendTXT("{\"targetId\":\"app\",\"as\":\"sensor-2\",\"payload\":2}");
+    ASSERT_TRUE(until([&]() { return app.text.length() > 0; }));
+    EXPECT_EQ(app.text, "{\"from\":\"gw\",\"to\":\"app\",\"payload\":2}");
+}
+
+TEST_F(RelayTest, BinaryCarriesSenderId) {
+    Device & a = device("a");
+    Device & b = device("bb");
+    ASSERT_TRUE(until([&]() { return a.connected && b.connected; }));
+
+    uint8_t chunk[] = { 2, 'b', 'b', 0xDE, 0xAD };
+    a.client.sendBIN(chunk, sizeof(chunk));
+    ASSERT_TRUE(until([&]() { return b.binary.size() > 0; }));
+    std::vector<uint8_t> expected = { 1, 'a', 0xDE, 0xAD };
+    EXPECT_EQ(b.binary, expected);
+}
+
+TEST_F(RelayTest, DropsDeviceThatDoesNotRead) {
+    HostClient slow;
+    ASSERT_TRUE(slow.connect("localhost", port));
+    static const char request[] =
+        "GET /?id=slow HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Connection: Upgrade\r\n"
+        "Upgrade: websocket\r\n"
+        "Sec-WebSocket-Version: 13\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+        "\r\n";
+    slow.write((const uint8_t *)request, sizeof(request) - 1);
+    Device & a = device("a");
+    ASSERT_TRUE(until([&]() { return a.connected && relay.stats().connections == 2; }));
+
+    String message = "{\"targetId\":\"slow\",\"payload\":\"";
+    while(message.length() < 8192) {
+        message += 'x';
+    }
+    message += "\"}";
+    // fills the socket buffers until a write of the relay comes up short
+    EXPECT_TRUE(until([&]() {
+        a.client.sendTXT(message);
+        return relay.stats().slow == 1;
+    }, 10000));
+    EXPECT_TRUE(until([&]() { return relay.stats().connections == 1; }));
+    EXPECT_TRUE(a.connected);
+}
+
+TEST_F(RelayTest, RoutesAcrossShards) {
+    // more connections than one WebSocketsServerCore holds
+    const size_t count = WEBSOCKETS_SERVER_CLIENT_MAX + 10;
+    std::vector<HostClient> peers(count);
+    for(size_t i = 0; i < count; i++) {
+        char request[256];
+        int length = snprintf(request, sizeof(request),
+            "GET /?id=p%u HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Connection: Upgrade\r\n"
+            "Upgrade: websocket\r\n"
+            "Sec-WebSocket-Version: 13\r\n"
+            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+            "\r\n",
+            (unsigned)i);
+        ASSERT_TRUE(peers[i].connect("localhost", port));
+        peers[i].write((const uint8_t *)request, length);
+    }
+    ASSERT_TRUE(until([&]() { return relay.stats().connections == count; }, 5000));
+    EXPECT_EQ(relay.shards(), 2u);
+
+    uint8_t buf[1024];
+    HostClient & last = peers[count - 1];
+    while(last.read(buf, sizeof(buf)) > 0) {
+    }
+    Device & a = device("a");
+    ASSERT_TRUE(until([&]() { return a.connected; }));
+    String message = "{\"targetId\":\"p";
+    message += (unsigned)(count - 1);
+    message += "\",\"payload\":0}";
+    a.client.sendTXT(message);
+    ASSERT_TRUE(until([&]() { return relay.stats().delivered == 1; }));
+
+    // unmasked text frame, 7 bit length
+    std::string expected = "{\"from\":\"a\",\"to\":\"p" + std::to_string(count - 1) + "\",\"payload\":0}";
+    int n = 0;
+    ASSERT_TRUE(until([&]() { return (n = last.read(buf, sizeof(buf))) > 0; }));
+    ASSERT_EQ(n, (int)expected.size() + 2);
+    EXPECT_EQ(buf[0], 0x81);
+    EXPECT_EQ(std::string((const char *)buf + 2, n - 2), expected);
+}
+
+}    // namespace
@@ -0,0 +1,263 @@
+/**
+ * @file test_telemetry.cpp
+ * @date 19.10.2026
+ * @author NIKOLAINDUSTRY
+ *
+ * Copyright (c) 2026 NIKOLAINDUSTRY. All rights reserved.
+ * This file is part of the WebSockets for Arduino.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+// nikolaindustrytelemetry on the manual clock: schedule, window aggregates, raw series, dropped batches
+
+#include <gtest/gtest.h>
+
+#include <MockNetwork.h>
+#include <WebSocketsServer.h>
+#include <nikolaindustry-telemetry.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+class TelemetryTest : public ::testing::Test {
+  protected:
+    static const uint16_t port = 8711;
+
+    void SetUp() override {
+        host::useManualClock(1000);
+        MockNetwork::setLink(HostLink_t());
+        Serial.mute(true);
+        server.onEvent([this](uint8_t, WStype_t type, uint8_t * payload, size_t length) {
+            if(type == WStype_TEXT) {
+                received.emplace_back((const char *)payload, length);
+            }
+        });
+        server.begin();
+    }
+    void TearDown() override {
+        device.disconnect();
+        server.close();
+        Serial.mute(false);
+        host::useRealClock();
+    }
+
+    bool connect() {
+        device.setEndpoint("localhost", port, false);
+        device.begin("sensor");
+        for(int i = 0; i < 1000 && !device.isNikolaindustryRealtimeConnected(); i++) {
+            host::advance(10);
+            device.loop();
+            server.loop();
+        }
+        return device.isNikolaindustryRealtimeConnected();
+    }
+
+    /**
+     * the telemetry object of the last batch the server received
+     * @return false if no batch arrived
+     */
+    bool lastBatch(DynamicJsonDocument & doc) {
+        for(int i = 0; i < 10; i++) {
+            device.loop();
+            server.loop();
+        }
+        for(auto it = received.rbegin(); it != received.rend(); ++it) {
+            if(it->find("\"telemetry\"") != std::string::npos) {
+                return !deserializeJson(doc, it->data(), it->size());
+            }
+        }
+        return false;
+    }
+
+    WebSocketsServer server{ port };
+    nikolaindustryrealtime device;
+    std::vector<std::string> received;
+};
+
+TEST_F(TelemetryTest, KeepsScheduleWhenLoopIsLate) {
+    nikolaindustrytelemetry telemetry(device);
+    ASSERT_TRUE(telemetry.begin("dashboard", 60000));
+    std::vector<uint32_t> at;
+    ASSERT_TRUE(telemetry.addChannel("t", 100, [&]() {
+        at.push_back(millis());
+        return 0.0f;
+    }));
+
+    telemetry.loop();
+    // 30 ms late, the next sample is still due at +200, not at +230
+    host::advance(130);
+    telemetry.loop();
+    host::advance(70);
+    telemetry.loop();
+    host::advance(99);
+    telemetry.loop();
+    host::advance(1);
+    telemetry.loop();
+    std::vector<uint32_t> expected = { 1000, 1130, 1200, 1300 };
+    EXPECT_EQ(at, expected);
+
+    // blocked for 450 ms: +400 .. +700 are due, one sample now, +500 .. +700 are skipped
+    host::advance(450);
+    telemetry.loop();
+    nikolaindustryTelemetryStats stats;
+    telemetry.getStats(&stats);
+    EXPECT_EQ(stats.missed, 3u);
+    EXPECT_EQ(at.back(), 1750u);
+    host::advance(49);
+    telemetry.loop();
+    EXPECT_EQ(at.size(), 5u);
+    host::advance(1);
+    telemetry.loop();
+    EXPECT_EQ(at.back(), 1800u);
+    telemetry.getStats(&stats);
+    EXPECT_EQ(stats.samples, 6u);
+}
+
+TEST_F(TelemetryTest, ReportsWindowAggregates) {
+    ASSERT_TRUE(connect());
+    nikolaindustrytelemetry telemetry(device);
+    uint32_t start = millis();
+    ASSERT_TRUE(telemetry.begin("dashboard", 1000));
+    float values[] = { 2, 8, 5 };
+    int next       = 0;
+    ASSERT_TRUE(telemetry.addChannel("temp", 300, [&]() { return values[next++ % 3]; }));
+
+    for(int i = 0; i < 100; i++) {
+        telemetry.loop();
+        host::advance(10);
+    }
+    telemetry.loop();
+    DynamicJsonDocument doc(1024);
+    ASSERT_TRUE(lastBatch(doc));
+    JsonObject batch = doc["payload"]["telemetry"];
+    EXPECT_EQ(batch["t"].as<uint32_t>(), start);
+    EXPECT_EQ(batch["w"].as<uint32_t>(), 1000u);
+    JsonObject temp = batch["ch"]["temp"];
+    // samples at +0, +300, +600, +900
+    EXPECT_EQ(temp["n"].as<int>(), 4);
+    EXPECT_FLOAT_EQ(temp["min"].as<float>(), 2);
+    EXPECT_FLOAT_EQ(temp["max"].as<float>(), 8);
+    EXPECT_FLOAT_EQ(temp["mean"].as<float>(), 17.0f / 4);
+    EXPECT_FLOAT_EQ(temp["last"].as<float>(), 2);
+    EXPECT_FALSE(temp.containsKey("raw"));
+
+    nikolaindustryTelemetryStats stats;
+    telemetry.getStats(&stats);
+    EXPECT_EQ(stats.batches, 1u);
+    EXPECT_EQ(stats.dropped, 0u);
+}
+
+TEST_F(TelemetryTest, CountSaturatesWithMeanOfCountedSamples) {
+    ASSERT_TRUE(connect());
+    nikolaindustrytelemetry telemetry(device);
+    ASSERT_TRUE(telemetry.begin("dashboard", 70000));
+    uint32_t read = 0;
+    ASSERT_TRUE(telemetry.addChannel("n", 1, [&]() { return ++read <= 0xFFFF ? 1.0f : 100.0f; }));
+
+    for(int i = 0; i < 70000; i++) {
+        telemetry.loop();
+        host::advance(1);
+    }
+    telemetry.loop();
+    DynamicJsonDocument doc(1024);
+    ASSERT_TRUE(lastBatch(doc));
+    JsonObject n = doc["payload"]["telemetry"]["ch"]["n"];
+    EXPECT_EQ(n["n"].as<uint32_t>(), 0xFFFFu);
+    EXPECT_FLOAT_EQ(n["mean"].as<float>(), 1);
+    EXPECT_FLOAT_EQ(n["max"].as<float>(), 100);
+    EXPECT_FLOAT_EQ(n["last"].as<float>(), 100);
+}
+
+TEST_F(TelemetryTest, RawSeriesIsDeltaEncoded) {
+    ASSERT_TRUE(connect());
+    nikolaindustrytelemetry telemetry(device);
+    ASSERT_TRUE(telemetry.begin("dashboard", 350));
+    float values[] = { 21.5f, 21.5f, 21.6f, 21.4f };
+    int next       = 0;
+    ASSERT_TRUE(telemetry.addChannel("temp", 100, [&]() { return values[next++]; }, 0.1f));
+
+    // the window ends between the fourth and a fifth sample
+    for(int i = 0; i < 4; i++) {
+        telemetry.loop();
+        host::advance(i < 3 ? 100 : 50);
+    }
+    telemetry.loop();
+    DynamicJsonDocument doc(1024);
+    ASSERT_TRUE(lastBatch(doc));
+    JsonObject temp = doc["payload"]["telemetry"]["ch"]["temp"];
+    EXPECT_FLOAT_EQ(temp["scale"].as<float>(), 0.1f);
+    std::vector<int> raw;
+    for(JsonVariant v : temp["raw"].as<JsonArray>()) {
+        raw.push_back(v.as<int>());
+    }
+    std::vector<int> expected = { 215, 0, 1, -2 };
+    EXPECT_EQ(raw, expected);
+}
+
+TEST_F(TelemetryTest, RawSeriesKeepsNewestSamples) {
+    ASSERT_TRUE(connect());
+    nikolaindustrytelemetry telemetry(device);
+    const int count = NIKOLAINDUSTRY_TELEMETRY_SAMPLES + 6;
+    ASSERT_TRUE(telemetry.begin("dashboard", count * 10 - 5));
+    int read = 0;
+    ASSERT_TRUE(telemetry.addChannel("i", 10, [&]() { return (float)read++; }, 1));
+
+    for(int i = 0; i < count; i++) {
+        telemetry.loop();
+        host::advance(i < count - 1 ? 10 : 5);
+    }
+    telemetry.loop();
+    DynamicJsonDocument doc(4096);
+    ASSERT_TRUE(lastBatch(doc));
+    JsonObject i = doc["payload"]["telemetry"]["ch"]["i"];
+    EXPECT_EQ(i["n"].as<int>(), count);
+    JsonArray raw = i["raw"];
+    ASSERT_EQ(raw.size(), (size_t)NIKOLAINDUSTRY_TELEMETRY_SAMPLES);
+    // the oldest kept sample is absolute, the rest are differences
+    EXPECT_EQ(raw[0].as<int>(), 6);
+    EXPECT_EQ(raw[1].as<int>(), 1);
+    EXPECT_EQ(raw[NIKOLAINDUSTRY_TELEMETRY_SAMPLES - 1].as<int>(), 1);
+}
+
+TEST_F(TelemetryTest, CountsDroppedBatches) {
+    // not connected, the send lanes do not take the batches
+    nikolaindustrytelemetry telemetry(device);
+    ASSERT_TRUE(telemetry.begin("dashboard", 100));
+    ASSERT_TRUE(telemetry.addChannel("t", 50, []() { return 1.0f; }));
+
+    for(int i = 0; i < 30; i++) {
+        telemetry.loop();
+        host::advance(10);
+    }
+    nikolaindustryTelemetryStats stats;
+    telemetry.getStats(&stats);
+    EXPECT_EQ(stats.batches, 0u);
+    EXPECT_EQ(stats.dropped, 2u);
+    EXPECT_EQ(stats.samples, 6u);
+
+    // an empty window sends nothing
+    nikolaindustrytelemetry idle(device);
+    ASSERT_TRUE(idle.begin("dashboard", 100));
+    host::advance(100);
+    idle.loop();
+    idle.getStats(&stats);
+    EXPECT_EQ(stats.dropped, 0u);
+}
+
+}    // namespace
@@ -0,0 +1,93 @@
+#!/usr/bin/python3
+
+# decodes the output of WebSocketsTrace::dump()
+# usage: decode_trace.py [serial.log]   (reads stdin without file)
+# the event names are read from src/WebSocketsTrace.h so they are always in sync
+
+import argparse
+import os
+import re
+import sys
+
+tools_dir = os.path.dirname(os.path.abspath(__file__))
+base_dir = os.path.abspath(tools_dir + "/../")
+
+OPCODES = {0x0: "cont", 0x1: "text", 0x2: "bin", 0x8: "close", 0x9: "ping", 0xA: "pong"}
+FRAME_EVENTS = ("frameTx", "frameRx")
+
+
+def read_events(header):
+    with open(header, "r") as f:
+        text = f.read()
+    enum = re.search(r"typedef enum \{(.*?)\} WStraceEvent_t;", text, re.S).group(1)
+    events = []
+    for line in enum.splitlines():
+        m = re.match(r"\s*WStrace_(\w+)\s*,?\s*(?:///<\s*(.*))?", line)
+        if m:
+            events.append((m.group(1), (m.group(2) or "").strip()))
+    return events
+
+
+def format_args(name, doc, a, b):
+    if name in FRAME_EVENTS:
+        op = OPCODES.get(a & 0xFF, "op%d" % (a & 0xFF))
+        flags = ("fin " if a & 0x100 else "") + ("mask " if a & 0x200 else "")
+        return "%s %slen=%d" % (op, flags, b)
+    # use the argument names from the enum comment "a: xx  b: yy"
+    m = re.match(r"a:\s*(.*?)\s+b:\s*(.*)", doc)
+    if m:
+        return "%s=%d %s=%d" % (m.group(1).replace(" ", "_"), a, m.group(2).replace(" ", "_"), b)
+    return "a=%d b=%d" % (a, b)
+
+
+def decode(lines, events):
+    records = None
+    for line in lines:
+        line = line.strip()
+        # the dump may be mixed with other serial output
+        idx = line.find("WSTRACE")
+        if idx >= 0:
+            parts = line[idx:].split()
+            if parts[1] == "END":
+                print_records(records or [], events)
+                records = None
+            else:
+                print("--- %s records, %s dropped, dump at %.3f ms ---" % (parts[1], parts[2], int(parts[3]) / 1000.0))
+                records = []
+            continue
+        if records is None:
+            continue
+        parts = line.split()
+        if len(parts) == 5 and all(p.isdigit() for p in parts):
+            records.append([int(p) for p in parts])
+
+
+def print_records(records, events):
+    if not records:
+        return
+    t0 = records[0][0]
+    last = t0
+    for ts, num, event, a, b in records:
+        name, doc = events[event] if event < len(events) else ("event%d" % event, "")
+        # micros() wraps, unsigned math keeps the deltas right
+        rel = (ts - t0) & 0xFFFFFFFF
+        delta = (ts - last) & 0xFFFFFFFF
+        last = ts
+        print("%12.3f ms %+10.3f  [%u] %-14s %s" % (rel / 1000.0, delta / 1000.0, num, name, format_args(name, doc, a, b)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="decode a WebSocketsTrace dump")
+    parser.add_argument("log", nargs="?", help="captured serial output (default stdin)")
+    parser.add_argument("--header", default=base_dir + "/src/WebSocketsTrace.h", help="WebSocketsTrace.h with the event enum")
+    args = parser.parse_args()
+
+    events = read_events(args.header)
+    if args.log:
+        with open(args.log, "r", errors="replace") as f:
+            decode(f, events)
+    else:
+        decode(sys.stdin, events)
+
+
+main()
@@ -29,9 +29,9 @@ void setup() {
       if (pin == 2 && (state == "ON" || state == "OFF")) {
         digitalWrite(2, state == "ON" ? HIGH : LOW);
 
-        // ✅ Send response back to sender
+        // ✅ Send response back to sender (carries the message id if it came from call())
         if (senderId != "") {
-          realtime.sendTo(senderId, [&](JsonObject &respPayload) {
+          realtime.reply(msg, [&](JsonObject &respPayload) {
             respPayload["response"] = "GPIO_OK";
             respPayload["pin"] = pin;
             respPayload["state"] = state;
@@ -0,0 +1,124 @@
+#include "nikolaindustry-gateway.h"
+#include "nikolaindustry-ratelimit.h"
+
+nikolaindustrygateway::nikolaindustrygateway()
+{
+  memset(table, 0, sizeof(table));
+}
+
+// false if the id is already registered or NIKOLAINDUSTRY_GATEWAY_DEVICES are used
+bool nikolaindustrygateway::add(const char *deviceId, DeviceCallback onMessage)
+{
+  if (!deviceId || !*deviceId || used >= NIKOLAINDUSTRY_GATEWAY_DEVICES || find(deviceId) >= 0)
+  {
+    return false;
+  }
+
+  uint8_t index = 0;
+  while (devices[index].hash)
+  {
+    index++;
+  }
+  Device &device = devices[index];
+  device.hash = nikolaindustryratelimit::targetHash(deviceId);
+  device.id = deviceId;
+  device.onMessage = onMessage;
+
+  uint8_t slot = home(device.hash);
+  while (table[slot])
+  {
+    slot = (slot + 1) & (TABLE_SIZE - 1);
+  }
+  table[slot] = index + 1;
+  used++;
+  return true;
+}
+
+bool nikolaindustrygateway::remove(const char *deviceId)
+{
+  int found = find(deviceId);
+  if (found < 0)
+  {
+    return false;
+  }
+  uint8_t slot = found;
+
+  Device &device = devices[table[slot] - 1];
+  device.hash = 0;
+  device.id = String();
+  device.onMessage = nullptr;
+  used--;
+
+  // backward shift the following entries of the probe run, no tombstones needed
+  table[slot] = 0;
+  uint8_t hole = slot;
+  uint8_t next = slot;
+  while (true)
+  {
+    next = (next + 1) & (TABLE_SIZE - 1);
+    if (!table[next])
+    {
+      break;
+    }
+    uint8_t h = home(devices[table[next] - 1].hash);
+    if (((next - h) & (TABLE_SIZE - 1)) >= ((next - hole) & (TABLE_SIZE - 1)))
+    {
+      table[hole] = table[next];
+      table[next] = 0;
+      hole = next;
+    }
+  }
+  return true;
+}
+
+// runs the callback of deviceId, false if it is not registered
+bool nikolaindustrygateway::dispatch(const char *deviceId, JsonObject &msg)
+{
+  int slot = find(deviceId);
+  if (slot < 0)
+  {
+    return false;
+  }
+  Device &device = devices[table[slot] - 1];
+  if (device.onMessage)
+  {
+    device.onMessage(msg);
+  }
+  return true;
+}
+
+void nikolaindustrygateway::forEach(std::function<void(const char *deviceId)> callback) const
+{
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_GATEWAY_DEVICES; i++)
+  {
+    if (devices[i].hash)
+    {
+      callback(devices[i].id.c_str());
+    }
+  }
+}
+
+// table slot of deviceId or -1
+int nikolaindustrygateway::find(const char *deviceId) const
+{
+  if (!deviceId || !*deviceId)
+  {
+    return -1;
+  }
+  uint32_t hash = nikolaindustryratelimit::targetHash(deviceId);
+  uint8_t slot = home(hash);
+  for (uint8_t i = 0; i < TABLE_SIZE; i++)
+  {
+    if (!table[slot])
+    {
+      return -1;
+    }
+    const Device &device = devices[table[slot] - 1];
+    if (device.hash == hash && device.id == deviceId)
+    {
+      return slot;
+    }
+    slot = (slot + 1) & (TABLE_SIZE - 1);
+  }
+  return -1;
+}
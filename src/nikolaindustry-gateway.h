@@ -0,0 +1,59 @@
+#ifndef NIKOLAINDUSTRY_GATEWAY_H
+#define NIKOLAINDUSTRY_GATEWAY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <functional>
+
+// sub-devices one gateway can register
+#ifndef NIKOLAINDUSTRY_GATEWAY_DEVICES
+#define NIKOLAINDUSTRY_GATEWAY_DEVICES 32
+#endif
+
+// slots of the routing table, power of 2 and at least twice NIKOLAINDUSTRY_GATEWAY_DEVICES
+#ifndef NIKOLAINDUSTRY_GATEWAY_TABLE_SIZE
+#define NIKOLAINDUSTRY_GATEWAY_TABLE_SIZE 64
+#endif
+
+// routing header: "as" names the sub-device a message is sent for,
+// "to" the sub-device a received message is for
+#define NIKOLAINDUSTRY_GATEWAY_AS "as"
+#define NIKOLAINDUSTRY_GATEWAY_TO "to"
+
+typedef std::function<void(JsonObject &msg)> DeviceCallback;
+
+// sub-devices behind a gateway by id. the table holds indexes into devices, open addressed by
+// the FNV-1a hash of the id (linear probing, backward shift delete), so a lookup is one hash
+// and usually one compare
+class nikolaindustrygateway {
+public:
+  nikolaindustrygateway();
+
+  bool add(const char *deviceId, DeviceCallback onMessage);
+  bool remove(const char *deviceId);
+  bool contains(const char *deviceId) const { return find(deviceId) >= 0; }
+  bool dispatch(const char *deviceId, JsonObject &msg);
+  uint8_t count() const { return used; }
+  void forEach(std::function<void(const char *deviceId)> callback) const;
+
+private:
+  static const uint8_t TABLE_SIZE = NIKOLAINDUSTRY_GATEWAY_TABLE_SIZE;
+  static_assert((TABLE_SIZE & (TABLE_SIZE - 1)) == 0 && TABLE_SIZE >= NIKOLAINDUSTRY_GATEWAY_DEVICES * 2 && TABLE_SIZE <= 128,
+                "NIKOLAINDUSTRY_GATEWAY_TABLE_SIZE has to be a power of 2, >= 2 * NIKOLAINDUSTRY_GATEWAY_DEVICES and <= 128");
+
+  struct Device
+  {
+    uint32_t hash = 0; // 0 = free
+    String id;
+    DeviceCallback onMessage;
+  };
+
+  Device devices[NIKOLAINDUSTRY_GATEWAY_DEVICES];
+  uint8_t table[TABLE_SIZE]; // device index + 1, 0 = free
+  uint8_t used = 0;
+
+  static uint8_t home(uint32_t hash) { return hash & (TABLE_SIZE - 1); }
+  int find(const char *deviceId) const;
+};
+
+#endif
@@ -0,0 +1,264 @@
+#include "nikolaindustry-gpio.h"
+
+#ifdef ESP32
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#endif
+
+#define FNV64_OFFSET 0xcbf29ce484222325ULL
+#define FNV64_PRIME 0x100000001b3ULL
+
+void nikolaindustryArduinoGpio::write(uint64_t high, uint64_t low)
+{
+  for (uint8_t pin = 0; pin < 64; pin++)
+  {
+    uint64_t bit = 1ULL << pin;
+    if (high & bit)
+    {
+      digitalWrite(pin, HIGH);
+    }
+    else if (low & bit)
+    {
+      digitalWrite(pin, LOW);
+    }
+  }
+}
+
+#ifdef ESP32
+void nikolaindustryEsp32Gpio::write(uint64_t high, uint64_t low)
+{
+  REG_WRITE(GPIO_OUT_W1TS_REG, (uint32_t)high);
+  REG_WRITE(GPIO_OUT_W1TC_REG, (uint32_t)low);
+#ifdef GPIO_OUT1_W1TS_REG
+  if ((high | low) >> 32)
+  {
+    REG_WRITE(GPIO_OUT1_W1TS_REG, (uint32_t)(high >> 32));
+    REG_WRITE(GPIO_OUT1_W1TC_REG, (uint32_t)(low >> 32));
+  }
+#endif
+}
+#endif
+
+nikolaindustrygpio::nikolaindustrygpio(nikolaindustryGpioHal *_hal) : hal(_hal)
+{
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_GPIO_PLANS; i++)
+  {
+    cache[i].lastUse = 0;
+  }
+}
+
+bool nikolaindustrygpio::execute(JsonArray actions, nikolaindustryGpioResult *result)
+{
+  result->us = 0;
+  result->actions = 0;
+  result->cached = false;
+
+  uint64_t h = hash(actions);
+  Cached *entry = nullptr;
+  Cached *oldest = &cache[0];
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_GPIO_PLANS; i++)
+  {
+    if (cache[i].lastUse && cache[i].hash == h)
+    {
+      entry = &cache[i];
+      break;
+    }
+    if (cache[i].lastUse < oldest->lastUse)
+    {
+      oldest = &cache[i];
+    }
+  }
+
+  if (entry)
+  {
+    result->cached = true;
+  }
+  else
+  {
+    nikolaindustryGpioPlan plan;
+    if (!compile(actions, &plan))
+    {
+      return false;
+    }
+    entry = oldest;
+    entry->hash = h;
+    entry->plan = plan;
+  }
+  entry->lastUse = ++uses;
+
+  uint32_t start = micros();
+  run(entry->plan);
+  result->us = micros() - start;
+  result->actions = entry->plan.actions;
+  return true;
+}
+
+// levels first, so a pin that becomes an output starts at its new level
+void nikolaindustrygpio::run(const nikolaindustryGpioPlan &plan)
+{
+  if (plan.high | plan.low)
+  {
+    hal->write(plan.high, plan.low);
+  }
+  setModes(plan.output, OUTPUT, modeOutput);
+  setModes(plan.input, INPUT, modeInput);
+  setModes(plan.pullup, INPUT_PULLUP, modePullup);
+}
+
+void nikolaindustrygpio::forgetModes()
+{
+  modeOutput = 0;
+  modeInput = 0;
+  modePullup = 0;
+}
+
+void nikolaindustrygpio::setModes(uint64_t pins, uint8_t mode, uint64_t &known)
+{
+  pins &= ~known;
+  if (!pins)
+  {
+    return;
+  }
+  for (uint8_t pin = 0; pin < 64; pin++)
+  {
+    if (pins & (1ULL << pin))
+    {
+      hal->setMode(pin, mode);
+    }
+  }
+  modeOutput &= ~pins;
+  modeInput &= ~pins;
+  modePullup &= ~pins;
+  known |= pins;
+}
+
+bool nikolaindustrygpio::compile(JsonArray actions, nikolaindustryGpioPlan *plan)
+{
+  memset(plan, 0, sizeof(*plan));
+  for (JsonObject action : actions)
+  {
+    JsonObject params = action["params"];
+    int pin = parsePin(params["gpio"]);
+    if (pin < 0)
+    {
+      Serial.println("❌ GPIO action without a valid pin");
+      return false;
+    }
+    uint64_t bit = 1ULL << pin;
+
+    const char *pinmode = params["pinmode"] | "OUTPUT";
+    plan->output &= ~bit;
+    plan->input &= ~bit;
+    plan->pullup &= ~bit;
+    if (strcmp(pinmode, "OUTPUT") == 0)
+    {
+#ifdef ESP32
+      if (!GPIO_IS_VALID_OUTPUT_GPIO(pin))
+      {
+        Serial.printf("❌ GPIO %d can not be an output\n", pin);
+        return false;
+      }
+#endif
+      plan->output |= bit;
+    }
+    else if (strcmp(pinmode, "INPUT") == 0)
+    {
+      plan->input |= bit;
+    }
+    else if (strcmp(pinmode, "INPUT_PULLUP") == 0)
+    {
+      plan->pullup |= bit;
+    }
+    else
+    {
+      Serial.printf("❌ Unknown pinmode %s\n", pinmode);
+      return false;
+    }
+
+    const char *name = action["action"] | "";
+    if (strcmp(name, "ON") == 0 || strcmp(name, "OFF") == 0)
+    {
+      const char *status = params["status"] | "LOW";
+      bool high = strcmp(status, "HIGH") == 0;
+      plan->high = high ? plan->high | bit : plan->high & ~bit;
+      plan->low = high ? plan->low & ~bit : plan->low | bit;
+    }
+    if (plan->actions < 0xFF)
+    {
+      plan->actions++;
+    }
+  }
+  return true;
+}
+
+// "gpio" as a string ("12") or a number, -1 if it is not a pin
+int nikolaindustrygpio::parsePin(JsonVariant gpio)
+{
+  long pin = -1;
+  if (gpio.is<const char *>())
+  {
+    const char *text = gpio.as<const char *>();
+    char *end;
+    pin = strtol(text, &end, 10);
+    if (end == text || *end)
+    {
+      return -1;
+    }
+  }
+  else if (gpio.is<int>())
+  {
+    pin = gpio.as<int>();
+  }
+
+  if (pin < 0 || pin > 63)
+  {
+    return -1;
+  }
+#ifdef ESP32
+  if (!GPIO_IS_VALID_GPIO(pin))
+  {
+    return -1;
+  }
+#endif
+  return pin;
+}
+
+// FNV-1a over the fields compile() reads, in order
+uint64_t nikolaindustrygpio::hash(JsonArray actions)
+{
+  uint64_t h = FNV64_OFFSET;
+  auto mix = [&h](const char *text)
+  {
+    while (*text)
+    {
+      h = (h ^ (uint8_t)*text++) * FNV64_PRIME;
+    }
+    // separator, so "1" "23" and "12" "3" differ
+    h = (h ^ 0xFF) * FNV64_PRIME;
+  };
+
+  for (JsonObject action : actions)
+  {
+    JsonObject params = action["params"];
+    JsonVariant gpio = params["gpio"];
+    if (gpio.is<const char *>())
+    {
+      mix(gpio.as<const char *>());
+    }
+    else if (gpio.is<int>())
+    {
+      // numbers hash apart from strings
+      char number[16];
+      snprintf(number, sizeof(number), "#%ld", gpio.as<long>());
+      mix(number);
+    }
+    else
+    {
+      mix("?");
+    }
+    mix(action["action"] | "");
+    mix(params["pinmode"] | "OUTPUT");
+    mix(params["status"] | "LOW");
+  }
+  return h;
+}
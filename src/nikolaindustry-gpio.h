@@ -0,0 +1,95 @@
+#ifndef NIKOLAINDUSTRY_GPIO_H
+#define NIKOLAINDUSTRY_GPIO_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// compiled action lists kept for repeated commands
+#ifndef NIKOLAINDUSTRY_GPIO_PLANS
+#define NIKOLAINDUSTRY_GPIO_PLANS 8
+#endif
+
+#define NIKOLAINDUSTRY_GPIO_COMMAND "GPIO_MANAGEMENT"
+
+// one GPIO_MANAGEMENT action list, bit n stands for GPIO n. a later action for the same pin replaces an earlier one
+struct nikolaindustryGpioPlan
+{
+  uint64_t high;   // written HIGH
+  uint64_t low;    // written LOW
+  uint64_t output; // set to OUTPUT
+  uint64_t input;  // set to INPUT
+  uint64_t pullup; // set to INPUT_PULLUP
+  uint8_t actions;
+};
+
+struct nikolaindustryGpioResult
+{
+  uint32_t us;     // time to apply the plan
+  uint8_t actions;
+  bool cached;     // the plan was not compiled again
+};
+
+// pin access of the executor, replace it to run plans against a mock or an io expander
+class nikolaindustryGpioHal {
+public:
+  virtual ~nikolaindustryGpioHal() {}
+  virtual void setMode(uint8_t pin, uint8_t mode) = 0;
+  // drives the pins in high HIGH and the pins in low LOW, as close to the same time as the hardware allows
+  virtual void write(uint64_t high, uint64_t low) = 0;
+};
+
+// pinMode / digitalWrite, one pin after the other
+class nikolaindustryArduinoGpio : public nikolaindustryGpioHal {
+public:
+  void setMode(uint8_t pin, uint8_t mode) override { pinMode(pin, mode); }
+  void write(uint64_t high, uint64_t low) override;
+};
+
+#ifdef ESP32
+// writes the set / clear registers: in bank 0 (GPIO 0-31) the pins going HIGH change together (W1TS),
+// the pins going LOW together a few cycles later (W1TC). bank 1 (GPIO 32-39) is written after that, the same way
+class nikolaindustryEsp32Gpio : public nikolaindustryGpioHal {
+public:
+  void setMode(uint8_t pin, uint8_t mode) override { pinMode(pin, mode); }
+  void write(uint64_t high, uint64_t low) override;
+};
+#endif
+
+// runs GPIO_MANAGEMENT action lists:
+//   [{"action": "ON", "params": {"gpio": "12", "pinmode": "OUTPUT", "status": "HIGH"}}, ...]
+// the list is compiled to masks once and cached by its hash, so a repeated command costs one pass over
+// the JSON and no string compares. all levels are written at once, then the pins that change their mode
+// are configured. modes set by the sketch itself are not seen, forgetModes() after changing them
+class nikolaindustrygpio {
+public:
+  nikolaindustrygpio(nikolaindustryGpioHal *hal);
+
+  // false if an action is invalid, nothing is applied then
+  bool execute(JsonArray actions, nikolaindustryGpioResult *result);
+  void run(const nikolaindustryGpioPlan &plan);
+  void forgetModes();
+
+  static bool compile(JsonArray actions, nikolaindustryGpioPlan *plan);
+
+private:
+  struct Cached
+  {
+    uint64_t hash;
+    uint32_t lastUse; // 0 = free
+    nikolaindustryGpioPlan plan;
+  };
+
+  nikolaindustryGpioHal *hal;
+  Cached cache[NIKOLAINDUSTRY_GPIO_PLANS];
+  uint32_t uses = 0;
+  // pins known to be in a mode
+  uint64_t modeOutput = 0;
+  uint64_t modeInput = 0;
+  uint64_t modePullup = 0;
+
+  static uint64_t hash(JsonArray actions);
+  static int parsePin(JsonVariant gpio);
+  void setModes(uint64_t pins, uint8_t mode, uint64_t &known);
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef NIKOLAINDUSTRY_JSON_H
+#define NIKOLAINDUSTRY_JSON_H
+
+#include <ArduinoJson.h>
+#include <WebSockets.h>
+
+// documents of the library allocate through the WebSockets memory accounting,
+// so they show up as "json" in WebSocketsMemory::toJson() (plain malloc without WEBSOCKETS_MEMORY)
+struct nikolaindustryJsonAllocator
+{
+  void *allocate(size_t size) { return WEBSOCKETS_MALLOC(size, WSmem_json); }
+  void deallocate(void *ptr) { WEBSOCKETS_FREE(ptr); }
+  void *reallocate(void *ptr, size_t size) { return WEBSOCKETS_REALLOC(ptr, size, WSmem_json); }
+};
+
+typedef BasicJsonDocument<nikolaindustryJsonAllocator> nikolaindustryJsonDocument;
+
+#endif
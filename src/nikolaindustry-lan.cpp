@@ -0,0 +1,391 @@
+#include "nikolaindustry-lan.h"
+
+#define LAN_MAGIC "nikolaindustry "
+
+nikolaindustrylan::nikolaindustrylan() : server(NIKOLAINDUSTRY_LAN_PORT)
+{
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_LAN_LINKS; i++)
+  {
+    linkPeer[i] = -1;
+  }
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_LAN_PEERS; i++)
+  {
+    peers[i].inbound = -1;
+    peers[i].link = -1;
+  }
+}
+
+void nikolaindustrylan::begin(const String &_deviceId)
+{
+  deviceId = _deviceId;
+  if (running)
+  {
+    return;
+  }
+
+  server.begin();
+  server.onEvent([this](uint8_t num, WStype_t type, uint8_t *payload, size_t length)
+                 { handleServerEvent(num, type, payload, length); });
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_LAN_LINKS; i++)
+  {
+    links[i].onEvent([this, i](WStype_t type, uint8_t *payload, size_t length)
+                     { handleLinkEvent(i, type, payload, length); });
+  }
+  udp.begin(NIKOLAINDUSTRY_LAN_DISCOVERY_PORT);
+  running = true;
+  announce();
+}
+
+void nikolaindustrylan::loop()
+{
+  if (!running)
+  {
+    return;
+  }
+
+  server.loop();
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_LAN_LINKS; i++)
+  {
+    if (linkPeer[i] < 0)
+    {
+      continue;
+    }
+    links[i].loop();
+    // the peer is gone or not reachable, every attempt blocks up to the TCP timeout
+    if (linkPeer[i] >= 0 && links[i].getConnectFailures() >= 2)
+    {
+      peers[linkPeer[i]].hits = 0;
+      closeLink(i);
+    }
+  }
+  receiveAnnounces();
+
+  if (millis() - lastAnnounce >= NIKOLAINDUSTRY_LAN_ANNOUNCE_MS)
+  {
+    announce();
+    expire();
+  }
+}
+
+// false if there is no direct connection to targetId (yet), send it over the relay then
+bool nikolaindustrylan::send(const String &targetId, const String &message)
+{
+  if (!running)
+  {
+    return false;
+  }
+  int8_t index = findPeer(targetId.c_str());
+  if (index < 0)
+  {
+    return false;
+  }
+
+  Peer &peer = peers[index];
+  if (peer.hits < 0xFFFF)
+  {
+    peer.hits++;
+  }
+  if (peer.link >= 0 && links[peer.link].isConnected())
+  {
+    return links[peer.link].sendTXT((uint8_t *)message.c_str(), message.length());
+  }
+  if (peer.inbound >= 0)
+  {
+    return server.sendTXT(peer.inbound, (uint8_t *)message.c_str(), message.length());
+  }
+  if (peer.link < 0 && peer.port && peer.hits >= NIKOLAINDUSTRY_LAN_HOT)
+  {
+    openLink(index);
+  }
+  return false;
+}
+
+bool nikolaindustrylan::isDirect(const String &targetId)
+{
+  int8_t index = findPeer(targetId.c_str());
+  if (index < 0)
+  {
+    return false;
+  }
+  return peers[index].inbound >= 0 || (peers[index].link >= 0 && links[peers[index].link].isConnected());
+}
+
+uint8_t nikolaindustrylan::peerCount() const
+{
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_LAN_PEERS; i++)
+  {
+    if (peers[i].id.length())
+    {
+      count++;
+    }
+  }
+  return count;
+}
+
+void nikolaindustrylan::announce()
+{
+  lastAnnounce = millis();
+  udp.beginPacket(WiFi.broadcastIP(), NIKOLAINDUSTRY_LAN_DISCOVERY_PORT);
+  udp.printf(LAN_MAGIC "%u %s", NIKOLAINDUSTRY_LAN_PORT, deviceId.c_str());
+  udp.endPacket();
+}
+
+void nikolaindustrylan::receiveAnnounces()
+{
+  while (udp.parsePacket() > 0)
+  {
+    char packet[96];
+    int length = udp.read(packet, sizeof(packet) - 1);
+    if (length <= 0)
+    {
+      continue;
+    }
+    packet[length] = 0;
+    if (strncmp(packet, LAN_MAGIC, strlen(LAN_MAGIC)) != 0)
+    {
+      continue;
+    }
+
+    char *id;
+    unsigned long port = strtoul(packet + strlen(LAN_MAGIC), &id, 10);
+    if (*id != ' ' || port == 0 || port > 0xFFFF)
+    {
+      continue;
+    }
+    id++;
+    if (!*id || deviceId == id)
+    {
+      continue;
+    }
+
+    int8_t index = addPeer(id);
+    if (index < 0)
+    {
+      continue;
+    }
+    Peer &peer = peers[index];
+    IPAddress ip = udp.remoteIP();
+    if (peer.link >= 0 && (peer.ip != ip || peer.port != port))
+    {
+      // the peer got a new address
+      closeLink(peer.link);
+    }
+    peer.ip = ip;
+    peer.port = port;
+    peer.lastSeen = millis();
+  }
+}
+
+// runs every announce interval: cools down the hit counts and drops silent peers
+void nikolaindustrylan::expire()
+{
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_LAN_PEERS; i++)
+  {
+    Peer &peer = peers[i];
+    if (!peer.id.length())
+    {
+      continue;
+    }
+    peer.hits >>= 1;
+    bool connected = peer.inbound >= 0 || (peer.link >= 0 && links[peer.link].isConnected());
+    if (!connected && now - peer.lastSeen > 3 * NIKOLAINDUSTRY_LAN_ANNOUNCE_MS)
+    {
+      removePeer(i);
+    }
+  }
+}
+
+int8_t nikolaindustrylan::findPeer(const char *id)
+{
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_LAN_PEERS; i++)
+  {
+    if (peers[i].id.length() && peers[i].id == id)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// the peer with this id, a new entry if it is not known. when the table is full
+// the longest silent peer without a connection is replaced, -1 if there is none
+int8_t nikolaindustrylan::addPeer(const char *id)
+{
+  int8_t index = findPeer(id);
+  if (index >= 0)
+  {
+    return index;
+  }
+
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_LAN_PEERS; i++)
+  {
+    if (!peers[i].id.length())
+    {
+      index = i;
+      break;
+    }
+    if (peers[i].inbound < 0 && peers[i].link < 0 && (index < 0 || (int32_t)(peers[i].lastSeen - peers[index].lastSeen) < 0))
+    {
+      index = i;
+    }
+  }
+  if (index < 0)
+  {
+    return -1;
+  }
+
+  removePeer(index);
+  Peer &peer = peers[index];
+  peer.id = id;
+  peer.ip = IPAddress();
+  peer.port = 0;
+  peer.lastSeen = millis();
+  return index;
+}
+
+void nikolaindustrylan::removePeer(int8_t index)
+{
+  Peer &peer = peers[index];
+  if (peer.link >= 0)
+  {
+    closeLink(peer.link);
+  }
+  peer.id = String();
+  peer.hits = 0;
+  peer.inbound = -1;
+  peer.link = -1;
+}
+
+// takes a free link, or the one of the coldest peer if this one is hotter
+void nikolaindustrylan::openLink(int8_t index)
+{
+  int8_t slot = -1;
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_LAN_LINKS; i++)
+  {
+    if (linkPeer[i] < 0)
+    {
+      slot = i;
+      break;
+    }
+    if (slot < 0 || peers[linkPeer[i]].hits < peers[linkPeer[slot]].hits)
+    {
+      slot = i;
+    }
+  }
+  if (linkPeer[slot] >= 0)
+  {
+    if (peers[linkPeer[slot]].hits >= peers[index].hits)
+    {
+      return;
+    }
+    closeLink(slot);
+  }
+
+  Peer &peer = peers[index];
+  linkPeer[slot] = index;
+  peer.link = slot;
+  String url = "/?id=" + deviceId;
+  links[slot].begin(peer.ip, peer.port, url.c_str());
+  links[slot].setReconnectInterval(1000);
+}
+
+void nikolaindustrylan::closeLink(int8_t link)
+{
+  int8_t index = linkPeer[link];
+  linkPeer[link] = -1;
+  if (index >= 0)
+  {
+    peers[index].link = -1;
+  }
+  links[link].disconnect();
+}
+
+// peers connect with /?id=<deviceId> like they do to the relay
+void nikolaindustrylan::handleServerEvent(uint8_t num, WStype_t type, uint8_t *payload, size_t length)
+{
+  switch (type)
+  {
+  case WStype_CONNECTED:
+  {
+    const char *id = strstr((const char *)payload, "id=");
+    if (!id || !id[3])
+    {
+      server.disconnect(num);
+      break;
+    }
+    String peerId = String(id + 3);
+    int end = peerId.indexOf('&');
+    if (end >= 0)
+    {
+      peerId = peerId.substring(0, end);
+    }
+
+    int8_t index = addPeer(peerId.c_str());
+    if (index < 0)
+    {
+      server.disconnect(num);
+      break;
+    }
+    if (!peers[index].port)
+    {
+      peers[index].ip = server.remoteIP(num);
+    }
+    peers[index].inbound = num;
+    peers[index].lastSeen = millis();
+    Serial.printf("⚡ Direct link from %s\n", peerId.c_str());
+    break;
+  }
+  case WStype_DISCONNECTED:
+    for (uint8_t i = 0; i < NIKOLAINDUSTRY_LAN_PEERS; i++)
+    {
+      if (peers[i].inbound == num)
+      {
+        peers[i].inbound = -1;
+      }
+    }
+    break;
+  case WStype_TEXT:
+    for (uint8_t i = 0; i < NIKOLAINDUSTRY_LAN_PEERS; i++)
+    {
+      if (peers[i].inbound == num)
+      {
+        peers[i].lastSeen = millis();
+        if (onMessageCallback)
+        {
+          onMessageCallback(peers[i].id.c_str(), payload, length);
+        }
+        break;
+      }
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+void nikolaindustrylan::handleLinkEvent(uint8_t link, WStype_t type, uint8_t *payload, size_t length)
+{
+  int8_t index = linkPeer[link];
+  if (index < 0)
+  {
+    return;
+  }
+
+  switch (type)
+  {
+  case WStype_CONNECTED:
+    Serial.printf("⚡ Direct link to %s\n", peers[index].id.c_str());
+    break;
+  case WStype_TEXT:
+    peers[index].lastSeen = millis();
+    if (onMessageCallback)
+    {
+      onMessageCallback(peers[index].id.c_str(), payload, length);
+    }
+    break;
+  default:
+    break;
+  }
+}
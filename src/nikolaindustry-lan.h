@@ -0,0 +1,96 @@
+#ifndef NIKOLAINDUSTRY_LAN_H
+#define NIKOLAINDUSTRY_LAN_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <WebSocketsClient.h>
+#include <WebSocketsServer.h>
+#include <functional>
+
+// local WebSocket server every device listens on in LAN mode
+#ifndef NIKOLAINDUSTRY_LAN_PORT
+#define NIKOLAINDUSTRY_LAN_PORT 8181
+#endif
+
+// UDP broadcast port for the announces
+#ifndef NIKOLAINDUSTRY_LAN_DISCOVERY_PORT
+#define NIKOLAINDUSTRY_LAN_DISCOVERY_PORT 8182
+#endif
+
+// announce interval, peers not heard of for 3 intervals are dropped
+#ifndef NIKOLAINDUSTRY_LAN_ANNOUNCE_MS
+#define NIKOLAINDUSTRY_LAN_ANNOUNCE_MS 5000
+#endif
+
+#ifndef NIKOLAINDUSTRY_LAN_PEERS
+#define NIKOLAINDUSTRY_LAN_PEERS 8
+#endif
+
+// direct connections this device opens, each is a WebSocketsClient
+#ifndef NIKOLAINDUSTRY_LAN_LINKS
+#define NIKOLAINDUSTRY_LAN_LINKS 2
+#endif
+
+// messages to a peer (halved every announce interval) before a direct connection is opened
+#ifndef NIKOLAINDUSTRY_LAN_HOT
+#define NIKOLAINDUSTRY_LAN_HOT 3
+#endif
+
+// message from a peer, already in the form the relay delivers: {"from": ..., "payload": {...}}
+typedef std::function<void(const char *from, uint8_t *payload, size_t length)> LanMessageCallback;
+
+// direct device to device path on the local network.
+// devices broadcast "nikolaindustry <port> <deviceId>" and keep a table of the peers they hear.
+// a peer that gets NIKOLAINDUSTRY_LAN_HOT messages gets a direct connection to its server,
+// messages to it use that connection, or the one the peer opened to us, until it drops.
+// send() returns false when there is no direct connection, the caller uses the relay then.
+// peers are not authenticated, only use it on trusted networks.
+class nikolaindustrylan {
+public:
+  nikolaindustrylan();
+
+  void begin(const String &deviceId);
+  void loop();
+  bool send(const String &targetId, const String &message);
+  void onMessage(LanMessageCallback callback) { onMessageCallback = callback; }
+
+  bool isDirect(const String &targetId);
+  uint8_t peerCount() const;
+
+private:
+  struct Peer
+  {
+    String id; // empty = free
+    IPAddress ip;
+    uint16_t port;    // 0 = only known by its connection to us
+    uint32_t lastSeen;
+    uint16_t hits;    // messages sent, decaying
+    int8_t inbound;   // server client num or -1
+    int8_t link;      // links index or -1
+  };
+
+  WebSocketsServer server;
+  WebSocketsClient links[NIKOLAINDUSTRY_LAN_LINKS];
+  int8_t linkPeer[NIKOLAINDUSTRY_LAN_LINKS];
+  WiFiUDP udp;
+
+  Peer peers[NIKOLAINDUSTRY_LAN_PEERS];
+  String deviceId;
+  bool running = false;
+  uint32_t lastAnnounce = 0;
+  LanMessageCallback onMessageCallback;
+
+  void announce();
+  void receiveAnnounces();
+  void expire();
+  int8_t findPeer(const char *id);
+  int8_t addPeer(const char *id);
+  void removePeer(int8_t index);
+  void openLink(int8_t index);
+  void closeLink(int8_t link);
+  void handleServerEvent(uint8_t num, WStype_t type, uint8_t *payload, size_t length);
+  void handleLinkEvent(uint8_t link, WStype_t type, uint8_t *payload, size_t length);
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "nikolaindustry-lanes.h"
+
+nikolaindustrylanes::nikolaindustrylanes(WebSocketsClient &_webSocket) : webSocket(_webSocket) {}
+
+// false if the lane is full or the message could not be sent.
+// the message is moved into the lane when it has to wait, it is not copied
+bool nikolaindustrylanes::send(String &&message, uint8_t priority, uint32_t target)
+{
+  if (priority >= NIKOLAINDUSTRY_PRIORITY_COUNT)
+  {
+    priority = NIKOLAINDUSTRY_PRIORITY_BULK;
+  }
+
+  if (idle(priority) && (priority != NIKOLAINDUSTRY_PRIORITY_BULK || message.length() <= NIKOLAINDUSTRY_BULK_FRAGMENT) && admit(priority, target, message.length()))
+  {
+    return sendMessage(message);
+  }
+
+  if (count[priority] >= NIKOLAINDUSTRY_LANE_DEPTH)
+  {
+    if (limiter)
+    {
+      limiter->countDropped();
+    }
+    return false;
+  }
+  uint8_t tail = (head[priority] + count[priority]) % NIKOLAINDUSTRY_LANE_DEPTH;
+  lanes[priority][tail] = std::move(message);
+  targets[priority][tail] = target;
+  count[priority]++;
+  return true;
+}
+
+// binary frames are not queued, they go out at bulk priority when nothing else waits.
+// false if the lanes are busy or out of tokens, the caller tries again on its next loop
+bool nikolaindustrylanes::sendBinary(uint8_t *data, size_t length, uint32_t target)
+{
+  if (!idle(NIKOLAINDUSTRY_PRIORITY_BULK) || !admit(NIKOLAINDUSTRY_PRIORITY_BULK, target, length))
+  {
+    return false;
+  }
+  return webSocket.sendBIN(data, length);
+}
+
+void nikolaindustrylanes::loop()
+{
+  if (!bulkActive)
+  {
+    uint8_t burst = 0;
+    for (uint8_t priority = NIKOLAINDUSTRY_PRIORITY_CONTROL; priority < NIKOLAINDUSTRY_PRIORITY_BULK; priority++)
+    {
+      while (count[priority] && burst < NIKOLAINDUSTRY_LANE_BURST)
+      {
+        if (!admit(priority, targets[priority][head[priority]], lanes[priority][head[priority]].length()))
+        {
+          break;
+        }
+        // dequeue first, a failed send disconnects and clears the lanes
+        String message = std::move(lanes[priority][head[priority]]);
+        lanes[priority][head[priority]] = String();
+        head[priority] = (head[priority] + 1) % NIKOLAINDUSTRY_LANE_DEPTH;
+        count[priority]--;
+        burst++;
+        sendMessage(message);
+      }
+    }
+    if (burst >= NIKOLAINDUSTRY_LANE_BURST)
+    {
+      return;
+    }
+
+    uint8_t first = head[NIKOLAINDUSTRY_PRIORITY_BULK];
+    if (count[NIKOLAINDUSTRY_PRIORITY_BULK] && admit(NIKOLAINDUSTRY_PRIORITY_BULK, targets[NIKOLAINDUSTRY_PRIORITY_BULK][first], lanes[NIKOLAINDUSTRY_PRIORITY_BULK][first].length()))
+    {
+      bulk = std::move(lanes[NIKOLAINDUSTRY_PRIORITY_BULK][first]);
+      lanes[NIKOLAINDUSTRY_PRIORITY_BULK][first] = String();
+      head[NIKOLAINDUSTRY_PRIORITY_BULK] = (first + 1) % NIKOLAINDUSTRY_LANE_DEPTH;
+      count[NIKOLAINDUSTRY_PRIORITY_BULK]--;
+      bulkOffset = 0;
+      bulkActive = true;
+    }
+  }
+
+  if (bulkActive)
+  {
+    sendBulkFragment();
+  }
+}
+
+// drops everything queued, the connection is gone
+void nikolaindustrylanes::clear()
+{
+  for (uint8_t priority = 0; priority < NIKOLAINDUSTRY_PRIORITY_COUNT; priority++)
+  {
+    for (uint8_t i = 0; i < NIKOLAINDUSTRY_LANE_DEPTH; i++)
+    {
+      lanes[priority][i] = String();
+    }
+    head[priority] = 0;
+    count[priority] = 0;
+  }
+  bulk = String();
+  bulkOffset = 0;
+  bulkActive = false;
+}
+
+// nothing of this or a higher priority waits and no bulk message is half sent
+bool nikolaindustrylanes::idle(uint8_t priority) const
+{
+  if (bulkActive)
+  {
+    return false;
+  }
+  for (uint8_t p = NIKOLAINDUSTRY_PRIORITY_CONTROL; p <= priority; p++)
+  {
+    if (count[p])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// control messages (acks) are never held back by the limiter.
+// every refusal counts as a delay, in send(), sendBinary() and loop() alike
+bool nikolaindustrylanes::admit(uint8_t priority, uint32_t target, size_t length)
+{
+  if (!limiter || priority == NIKOLAINDUSTRY_PRIORITY_CONTROL)
+  {
+    return true;
+  }
+  if (limiter->admit(target, length))
+  {
+    return true;
+  }
+  limiter->countDelayed();
+  return false;
+}
+
+bool nikolaindustrylanes::sendMessage(const String &message)
+{
+  return webSocket.sendTXT(message.c_str(), message.length());
+}
+
+void nikolaindustrylanes::sendBulkFragment()
+{
+  size_t length = bulk.length() - bulkOffset;
+  if (length > NIKOLAINDUSTRY_BULK_FRAGMENT)
+  {
+    length = NIKOLAINDUSTRY_BULK_FRAGMENT;
+  }
+  bool fin = (bulkOffset + length) >= bulk.length();
+
+  WSopcode_t opcode = bulkOffset ? WSop_continuation : WSop_text;
+  if (!webSocket.sendFragment(opcode, (uint8_t *)bulk.c_str() + bulkOffset, length, fin) || fin)
+  {
+    // on a failed write the connection is closed, the rest of the message is dropped
+    bulk = String();
+    bulkActive = false;
+    return;
+  }
+  bulkOffset += length;
+}
@@ -0,0 +1,70 @@
+#ifndef NIKOLAINDUSTRY_LANES_H
+#define NIKOLAINDUSTRY_LANES_H
+
+#include <Arduino.h>
+#include <WebSocketsClient.h>
+#include "nikolaindustry-ratelimit.h"
+
+// queued messages per lane, send() fails when a lane is full
+#ifndef NIKOLAINDUSTRY_LANE_DEPTH
+#define NIKOLAINDUSTRY_LANE_DEPTH 8
+#endif
+
+// control and interactive messages sent per loop() at most, the rest waits for the next loop()
+#ifndef NIKOLAINDUSTRY_LANE_BURST
+#define NIKOLAINDUSTRY_LANE_BURST 4
+#endif
+
+// bulk messages are sent in fragments of this size, one fragment per loop()
+#ifndef NIKOLAINDUSTRY_BULK_FRAGMENT
+#define NIKOLAINDUSTRY_BULK_FRAGMENT 512
+#endif
+
+enum nikolaindustryPriority
+{
+  NIKOLAINDUSTRY_PRIORITY_CONTROL,     // acks, replies
+  NIKOLAINDUSTRY_PRIORITY_INTERACTIVE, // commands, calls
+  NIKOLAINDUSTRY_PRIORITY_BULK,        // telemetry, logs
+  NIKOLAINDUSTRY_PRIORITY_COUNT
+};
+
+// outbound priority lanes in front of WebSocketsClient
+// a message goes out right away when nothing of the same or higher priority waits,
+// otherwise loop() sends control, then interactive messages (NIKOLAINDUSTRY_LANE_BURST at most),
+// then one bulk fragment once both lanes are empty.
+// RFC 6455 allows only ping / pong between the fragments of a message, so a started bulk message
+// holds back data messages until its last fragment; webSocket.loop() runs between the fragments
+// and keeps answering pings and sending heartbeats.
+// with a rate limiter, interactive and bulk messages without tokens wait in their lane.
+class nikolaindustrylanes {
+public:
+  nikolaindustrylanes(WebSocketsClient &webSocket);
+
+  void setLimiter(nikolaindustryratelimit *limiter) { this->limiter = limiter; }
+
+  bool send(String &&message, uint8_t priority, uint32_t target = 0);
+  bool sendBinary(uint8_t *data, size_t length, uint32_t target = 0);
+  void loop();
+  void clear();
+  uint8_t queued(uint8_t priority) const { return count[priority]; }
+
+private:
+  WebSocketsClient &webSocket;
+  nikolaindustryratelimit *limiter = nullptr;
+
+  String lanes[NIKOLAINDUSTRY_PRIORITY_COUNT][NIKOLAINDUSTRY_LANE_DEPTH];
+  uint32_t targets[NIKOLAINDUSTRY_PRIORITY_COUNT][NIKOLAINDUSTRY_LANE_DEPTH]; // target hash for the limiter
+  uint8_t head[NIKOLAINDUSTRY_PRIORITY_COUNT] = {0};
+  uint8_t count[NIKOLAINDUSTRY_PRIORITY_COUNT] = {0};
+
+  String bulk; // message being fragmented
+  size_t bulkOffset = 0;
+  bool bulkActive = false;
+
+  bool idle(uint8_t priority) const;
+  bool admit(uint8_t priority, uint32_t target, size_t length);
+  bool sendMessage(const String &message);
+  void sendBulkFragment();
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "nikolaindustry-ratelimit.h"
+
+void nikolaindustryratelimit::setGlobal(uint16_t _msgsPerSec, uint32_t _bytesPerSec, uint16_t _burstMsgs, uint32_t _burstBytes)
+{
+  msgsPerSec = _msgsPerSec;
+  bytesPerSec = _bytesPerSec;
+  burstMsgs = _burstMsgs ? _burstMsgs : 1;
+  burstBytes = _burstBytes ? _burstBytes : 1;
+  globalMsgs = Bucket();
+  globalBytes = Bucket();
+}
+
+void nikolaindustryratelimit::setPerTarget(uint16_t _msgsPerSec, uint16_t _burstMsgs)
+{
+  targetMsgsPerSec = _msgsPerSec;
+  targetBurst = _burstMsgs ? _burstMsgs : 1;
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_RATELIMIT_TARGETS; i++)
+  {
+    targets[i] = Target();
+  }
+}
+
+// server hint, msgsPerSec and bytesPerSec replace the global rates for durationMs (0 = until the next hint),
+// all 0 ends the throttling
+void nikolaindustryratelimit::throttle(uint16_t _msgsPerSec, uint32_t _bytesPerSec, uint32_t durationMs)
+{
+  stats.hints++;
+  throttled = (_msgsPerSec || _bytesPerSec);
+  throttleMsgs = _msgsPerSec;
+  throttleBytes = _bytesPerSec;
+  throttleUntil = durationMs ? millis() + durationMs : 0;
+}
+
+// true if the message may be sent now, the tokens are taken then
+// a message larger than the byte burst passes with a full bucket, so it is never stuck
+bool nikolaindustryratelimit::admit(uint32_t target, size_t bytes)
+{
+  uint32_t now = millis();
+
+  if (throttled && throttleUntil && (int32_t)(now - throttleUntil) >= 0)
+  {
+    throttled = false;
+  }
+
+  uint32_t msgRate = msgsPerSec;
+  uint32_t byteRate = bytesPerSec;
+  uint32_t msgBurst = burstMsgs;
+  uint32_t byteBurst = burstBytes;
+  if (throttled)
+  {
+    // a hint only slows down, the lower of both rates wins and the burst is cut to one second
+    msgRate = lower(msgRate, throttleMsgs);
+    byteRate = lower(byteRate, throttleBytes);
+    msgBurst = lower(msgBurst, msgRate ? msgRate : 1);
+    byteBurst = lower(byteBurst, byteRate ? byteRate : 1);
+  }
+
+  uint32_t byteCost = bytes < byteBurst ? bytes : byteBurst;
+
+  refill(globalMsgs, msgRate, msgBurst, now);
+  refill(globalBytes, byteRate, byteBurst, now);
+  Target *t = targetMsgsPerSec ? lookup(target, now) : nullptr;
+  if (t)
+  {
+    refill(t->msgs, targetMsgsPerSec, targetBurst, now);
+  }
+
+  if (!available(globalMsgs, msgRate, 1) || !available(globalBytes, byteRate, byteCost) ||
+      (t && !available(t->msgs, targetMsgsPerSec, 1)))
+  {
+    return false;
+  }
+
+  consume(globalMsgs, msgRate, 1);
+  consume(globalBytes, byteRate, byteCost);
+  if (t)
+  {
+    consume(t->msgs, targetMsgsPerSec, 1);
+  }
+  stats.allowed++;
+  return true;
+}
+
+// FNV-1a, targets with the same hash share a bucket
+uint32_t nikolaindustryratelimit::targetHash(const char *target)
+{
+  uint32_t hash = 2166136261UL;
+  while (target && *target)
+  {
+    hash = (hash ^ (uint8_t)*target++) * 16777619UL;
+  }
+  return hash ? hash : 1;
+}
+
+nikolaindustryratelimit::Target *nikolaindustryratelimit::lookup(uint32_t target, uint32_t now)
+{
+  Target *oldest = &targets[0];
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_RATELIMIT_TARGETS; i++)
+  {
+    if (targets[i].target == target)
+    {
+      targets[i].used = now;
+      return &targets[i];
+    }
+    if (targets[i].target == 0 || (oldest->target && (int32_t)(targets[i].used - oldest->used) < 0))
+    {
+      oldest = &targets[i];
+    }
+  }
+
+  *oldest = Target();
+  oldest->target = target;
+  oldest->used = now;
+  return oldest;
+}
+
+void nikolaindustryratelimit::refill(Bucket &bucket, uint32_t rate, uint32_t burst, uint32_t now)
+{
+  if (!rate)
+  {
+    return;
+  }
+  uint64_t full = (uint64_t)burst * 1000;
+  if (!bucket.primed)
+  {
+    bucket.tokens = full;
+    bucket.primed = true;
+  }
+  else
+  {
+    bucket.tokens += (uint64_t)rate * (now - bucket.last);
+    if (bucket.tokens > full)
+    {
+      bucket.tokens = full;
+    }
+  }
+  bucket.last = now;
+}
+
+bool nikolaindustryratelimit::available(const Bucket &bucket, uint32_t rate, uint32_t cost)
+{
+  return !rate || bucket.tokens >= (uint64_t)cost * 1000;
+}
+
+void nikolaindustryratelimit::consume(Bucket &bucket, uint32_t rate, uint32_t cost)
+{
+  if (rate)
+  {
+    bucket.tokens -= (uint64_t)cost * 1000;
+  }
+}
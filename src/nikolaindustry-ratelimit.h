@@ -0,0 +1,77 @@
+#ifndef NIKOLAINDUSTRY_RATELIMIT_H
+#define NIKOLAINDUSTRY_RATELIMIT_H
+
+#include <Arduino.h>
+
+// targets with an own bucket, the least recently used one is replaced
+#ifndef NIKOLAINDUSTRY_RATELIMIT_TARGETS
+#define NIKOLAINDUSTRY_RATELIMIT_TARGETS 8
+#endif
+
+struct nikolaindustryRateStats
+{
+  uint32_t allowed;
+  uint32_t delayed; // admissions refused for lack of tokens, a waiting message counts on every try
+  uint32_t dropped; // send queue full
+  uint32_t hints;   // throttle messages from the server
+};
+
+// token buckets for the send path, a global one for messages and bytes per second
+// and one for messages per second per target. a rate of 0 means unlimited.
+// tokens are kept in 1/1000 so low rates refill smoothly.
+class nikolaindustryratelimit {
+public:
+  void setGlobal(uint16_t msgsPerSec, uint32_t bytesPerSec, uint16_t burstMsgs, uint32_t burstBytes);
+  void setPerTarget(uint16_t msgsPerSec, uint16_t burstMsgs);
+  void throttle(uint16_t msgsPerSec, uint32_t bytesPerSec, uint32_t durationMs);
+
+  bool admit(uint32_t target, size_t bytes);
+  void countDelayed() { stats.delayed++; }
+  void countDropped() { stats.dropped++; }
+  void getStats(nikolaindustryRateStats *out) const { *out = stats; }
+
+  static uint32_t targetHash(const char *target);
+
+private:
+  struct Bucket
+  {
+    uint64_t tokens = 0;
+    uint32_t last = 0;
+    bool primed = false; // starts full
+  };
+
+  struct Target
+  {
+    uint32_t target = 0; // hash of the target id, 0 = free
+    uint32_t used = 0;
+    Bucket msgs;
+  };
+
+  uint16_t msgsPerSec = 0;
+  uint32_t bytesPerSec = 0;
+  uint16_t burstMsgs = 0;
+  uint32_t burstBytes = 0;
+  uint16_t targetMsgsPerSec = 0;
+  uint16_t targetBurst = 0;
+
+  // server hint, replaces the global rates until throttleUntil
+  bool throttled = false;
+  uint16_t throttleMsgs = 0;
+  uint32_t throttleBytes = 0;
+  uint32_t throttleUntil = 0;
+
+  Bucket globalMsgs;
+  Bucket globalBytes;
+  Target targets[NIKOLAINDUSTRY_RATELIMIT_TARGETS];
+
+  nikolaindustryRateStats stats = {0, 0, 0, 0};
+
+  Target *lookup(uint32_t target, uint32_t now);
+  static void refill(Bucket &bucket, uint32_t rate, uint32_t burst, uint32_t now);
+  static bool available(const Bucket &bucket, uint32_t rate, uint32_t cost);
+  static void consume(Bucket &bucket, uint32_t rate, uint32_t cost);
+  // lower of two rates where 0 is unlimited
+  static uint32_t lower(uint32_t a, uint32_t b) { return !a ? b : (!b ? a : (a < b ? a : b)); }
+};
+
+#endif
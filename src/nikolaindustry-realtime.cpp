@@ -1,14 +1,28 @@
 #include "nikolaindustry-realtime.h"
 
-nikolaindustryrealtime::nikolaindustryrealtime() {}
+// socket, send lanes, LAN mode, transfers
+#define LOOP_STAGES 4
+
+nikolaindustryrealtime::nikolaindustryrealtime() : lanes(webSocket), transfer(lanes)
+{
+  lanes.setLimiter(&limiter);
+}
 
 void nikolaindustryrealtime::begin(const char *_deviceId)
 {
   deviceId = _deviceId;
+  if (endpointCount == 0)
+  {
+    addEndpoint("nikolaindustry-realtime.onrender.com");
+  }
 
   if (WiFi.status() == WL_CONNECTED)
   {
-    connect();
+    connect(pickEndpoint());
+    if (lan)
+    {
+      lan->begin(deviceId);
+    }
   }
   else
   {
@@ -16,28 +30,105 @@ void nikolaindustryrealtime::begin(const char *_deviceId)
   }
 }
 
-void nikolaindustryrealtime::connect()
+// call before begin(), e.g. setEndpoint("192.168.1.10", 81, false) for a local relay.
+// replaces all endpoints
+void nikolaindustryrealtime::setEndpoint(const char *host, uint16_t port, bool ssl, const char *path)
 {
-  webSocket.beginSSL("nikolaindustry-realtime.onrender.com", 443, ("/?id=" + deviceId).c_str());
+  endpointCount = 0;
+  addEndpoint(host, port, ssl, path);
+}
+
+// adds a relay for failover, call before begin(). false if NIKOLAINDUSTRY_MAX_ENDPOINTS are set
+bool nikolaindustryrealtime::addEndpoint(const char *host, uint16_t port, bool ssl, const char *path)
+{
+  if (endpointCount >= NIKOLAINDUSTRY_MAX_ENDPOINTS)
+  {
+    return false;
+  }
+  Endpoint &e = endpoints[endpointCount++];
+  e.host = host;
+  e.port = port;
+  e.ssl = ssl;
+  e.path = path;
+  e.latency = 0;
+  e.failures = 0;
+  e.retryAt = 0;
+  return true;
+}
+
+bool nikolaindustryrealtime::getEndpointStats(uint8_t index, nikolaindustryEndpointStats *stats)
+{
+  if (index >= endpointCount)
+  {
+    return false;
+  }
+  stats->latency = endpoints[index].latency;
+  stats->failures = endpoints[index].failures;
+  stats->active = (index == endpoint);
+  stats->down = endpointDown(index);
+  return true;
+}
+
+void nikolaindustryrealtime::connect(uint8_t index)
+{
+  endpoint = index;
+  seenFailures = 0;
+  Endpoint &e = endpoints[index];
+  String url = e.path + "?id=" + deviceId;
+#if defined(HAS_SSL)
+  if (e.ssl)
+  {
+    webSocket.beginSSL(e.host.c_str(), e.port, url.c_str());
+  }
+  else
+  {
+    webSocket.begin(e.host.c_str(), e.port, url.c_str());
+  }
+#else
+  // network classes without TLS (e.g. the host builds) connect plain
+  if (e.ssl)
+  {
+    Serial.printf("⚠️ No TLS on this network, %s:%u without SSL\n", e.host.c_str(), e.port);
+  }
+  webSocket.begin(e.host.c_str(), e.port, url.c_str());
+#endif
 
   webSocket.onEvent([this](WStype_t type, uint8_t *payload, size_t length)
                     {
-    DynamicJsonDocument doc(2048);
     switch (type) {
       case WStype_CONNECTED:
         Serial.println("🟢 WebSocket connected");
+        {
+          Endpoint &e = endpoints[endpoint];
+          uint32_t sample = webSocket.getHandshakeTime();
+          e.latency = max(e.latency ? (3 * e.latency + sample) / 4 : sample, (uint32_t)1);
+          e.failures = 0;
+          endpointSince = millis();
+        }
+        transfer.connected();
+        if (gateway.count()) sendRegister("register", nullptr);
         if (onConnectionStatusChange) onConnectionStatusChange(true);
         break;
       case WStype_DISCONNECTED:
         Serial.println("🔴 WebSocket disconnected");
+        reselect = true;
+        lanes.clear();
+        rpc.failAll();
+        transfer.disconnected();
+        handleFragment(type, nullptr, 0);
         if (onConnectionStatusChange) onConnectionStatusChange(false);
         break;
       case WStype_TEXT:
-        
-        if (!deserializeJson(doc, payload, length) && onMessageCallback) {
-          JsonObject obj = doc.as<JsonObject>();
-          onMessageCallback(obj);
-        }
+        handleText(payload, length);
+        break;
+      case WStype_BIN:
+        transfer.handleChunk(payload, length);
+        break;
+      case WStype_FRAGMENT_TEXT_START:
+      case WStype_FRAGMENT_BIN_START:
+      case WStype_FRAGMENT:
+      case WStype_FRAGMENT_FIN:
+        handleFragment(type, payload, length);
         break;
       default:
         break;
@@ -46,34 +137,697 @@ void nikolaindustryrealtime::connect()
   webSocket.setReconnectInterval(5000);
 }
 
+// the frame buffer is NUL terminated and owned by WebSockets until the event returns,
+// so with zero copy the strings of the document point into it and are valid only in the callback.
+// from is set for messages of LAN peers and replaces the "from" they sent
+void nikolaindustryrealtime::handleText(uint8_t *payload, size_t length, const char *from)
+{
+  nikolaindustryJsonDocument doc(NIKOLAINDUSTRY_JSON_CAPACITY);
+  DeserializationError error;
+  if (zeroCopy)
+  {
+    if (hasFilter)
+      error = deserializeJson(doc, (char *)payload, length, DeserializationOption::Filter(filter));
+    else
+      error = deserializeJson(doc, (char *)payload, length);
+  }
+  else
+  {
+    if (hasFilter)
+      error = deserializeJson(doc, (const char *)payload, length, DeserializationOption::Filter(filter));
+    else
+      error = deserializeJson(doc, (const char *)payload, length);
+  }
+
+  if (error)
+  {
+    // NoMemory: the message does not fit into NIKOLAINDUSTRY_JSON_CAPACITY
+    if (onParseError)
+      onParseError(error, length);
+    else
+      Serial.printf("❌ JSON %s (%u bytes)\n", error.c_str(), (unsigned)length);
+    return;
+  }
+
+  JsonObject obj = doc.as<JsonObject>();
+  if (from)
+  {
+    obj["from"] = from;
+  }
+  if (!handleThrottle(obj) && !handleResponse(obj) && !handleTransfer(obj) && !handleGateway(obj) && !handleGpio(obj) && onMessageCallback)
+    onMessageCallback(obj);
+}
+
+// fragments are collected and handled like one TEXT / BIN message, a disconnect drops them
+void nikolaindustryrealtime::handleFragment(WStype_t type, uint8_t *payload, size_t length)
+{
+  if (type == WStype_FRAGMENT_TEXT_START || type == WStype_FRAGMENT_BIN_START)
+  {
+    WEBSOCKETS_FREE(fragments);
+    fragments = nullptr;
+    fragmentsLength = 0;
+    fragmentsBinary = (type == WStype_FRAGMENT_BIN_START);
+  }
+  else if (!fragments)
+  {
+    // dropped (too large) or no message started
+    return;
+  }
+
+  if (type == WStype_DISCONNECTED)
+  {
+    WEBSOCKETS_FREE(fragments);
+    fragments = nullptr;
+    return;
+  }
+
+  if (fragmentsLength + length > NIKOLAINDUSTRY_FRAGMENT_MAX)
+  {
+    if (onParseError)
+      onParseError(DeserializationError::NoMemory, fragmentsLength + length);
+    else
+      Serial.printf("❌ Fragmented message too large (%u bytes)\n", (unsigned)(fragmentsLength + length));
+    WEBSOCKETS_FREE(fragments);
+    fragments = nullptr;
+    return;
+  }
+
+  // one byte more, text is parsed NUL terminated
+  uint8_t *buffer = (uint8_t *)WEBSOCKETS_REALLOC(fragments, fragmentsLength + length + 1, WSmem_app);
+  if (!buffer)
+  {
+    WEBSOCKETS_FREE(fragments);
+    fragments = nullptr;
+    return;
+  }
+  fragments = buffer;
+  memcpy(fragments + fragmentsLength, payload, length);
+  fragmentsLength += length;
+  fragments[fragmentsLength] = 0;
+
+  if (type == WStype_FRAGMENT_FIN)
+  {
+    if (fragmentsBinary)
+      transfer.handleChunk(fragments, fragmentsLength);
+    else
+      handleText(fragments, fragmentsLength);
+    WEBSOCKETS_FREE(fragments);
+    fragments = nullptr;
+  }
+}
+
+// only the fields set in filter are kept, e.g. {"payload": {"command": true, "pin": true}}
+// "from", "to", "throttle", the message ids and transfer control are always kept
+// for reply(), call(), throttling, sendFile() and sub-devices, the commands too with enableGpioCommands().
+// there is one filter for all messages, sub-devices of a gateway included, since they share the parse.
+// false (and no filter) if it could not be copied
+bool nikolaindustryrealtime::setMessageFilter(const JsonDocument &_filter)
+{
+  // the copy of the filter plus the keys added below
+  filter = nikolaindustryJsonDocument(_filter.memoryUsage() + JSON_OBJECT_SIZE(8) + JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(2));
+  filter.set(_filter);
+  filter["from"] = true;
+  filter["throttle"] = true;
+  filter[NIKOLAINDUSTRY_GATEWAY_TO] = true;
+  // handleGpio() reads command and actions of every entry, unless the filter keeps the whole payload already
+  if (gpio && !filter["payload"].is<bool>() && !filter["payload"]["commands"].is<bool>())
+  {
+    filter["payload"]["commands"][0]["command"] = true;
+    filter["payload"]["commands"][0]["actions"] = true;
+  }
+  if (filter["payload"].is<JsonObject>())
+  {
+    filter["payload"][NIKOLAINDUSTRY_RPC_ID] = true;
+    filter["payload"][NIKOLAINDUSTRY_RPC_REPLY] = true;
+    filter["payload"][NIKOLAINDUSTRY_TRANSFER_KEY] = true;
+  }
+  if (filter.overflowed())
+  {
+    Serial.printf("❌ Message filter does not fit (%u bytes), no filter set\n", (unsigned)filter.capacity());
+    clearMessageFilter();
+    return false;
+  }
+  hasFilter = true;
+  return true;
+}
+
+void nikolaindustryrealtime::clearMessageFilter()
+{
+  filter.clear();
+  hasFilter = false;
+}
+
+// parse the frame in place instead of copying the strings into the document
+void nikolaindustryrealtime::setZeroCopyParsing(bool enable)
+{
+  zeroCopy = enable;
+}
+
+// called instead of dropping a message that is no valid JSON or too large
+void nikolaindustryrealtime::setOnParseError(std::function<void(DeserializationError, size_t)> callback)
+{
+  onParseError = callback;
+}
+
 void nikolaindustryrealtime::loop()
 {
-  if (WiFi.status() == WL_CONNECTED)
+  loop(0);
+}
+
+// returns once budgetUs are used up (0 = no limit, one frame per loop like before).
+// the socket, the send lanes, LAN mode and transfers run in turn, a stage that did not get
+// its turn goes first in the next call. a single stage is not interrupted, a connect
+// attempt still blocks, getMaxStall() tells how long the longest call took
+void nikolaindustryrealtime::loop(uint32_t budgetUs)
+{
+  uint32_t start = micros();
+  uint8_t first = loopStage;
+  loopStage = 0;
+  for (uint8_t i = 0; i < LOOP_STAGES; i++)
   {
-    webSocket.loop();
+    uint8_t stage = (first + i) % LOOP_STAGES;
+    uint32_t used = micros() - start;
+    if (i && budgetUs && used >= budgetUs)
+    {
+      loopStage = stage;
+      break;
+    }
+    runLoopStage(stage, budgetUs ? budgetUs - used : 0);
+  }
+  rpc.expire(millis());
+
+  uint32_t stall = micros() - start;
+  if (stall > maxStall)
+  {
+    maxStall = stall;
   }
 }
 
-void nikolaindustryrealtime::sendJson(const JsonObject &json)
+void nikolaindustryrealtime::runLoopStage(uint8_t stage, uint32_t budgetUs)
 {
-  String output;
-  if (serializeJson(json, output))
+  bool online = WiFi.status() == WL_CONNECTED;
+  switch (stage)
   {
-    webSocket.sendTXT(output);
+  case 0:
+    if (online)
+    {
+      webSocket.loop(budgetUs);
+      selectEndpoint();
+    }
+    break;
+  case 1:
+    if (online)
+    {
+      lanes.loop();
+    }
+    break;
+  case 2:
+    if (online && lan)
+    {
+      lan->loop();
+    }
+    break;
+  case 3:
+    transfer.loop();
+    break;
   }
-  else
+}
+
+// longest loop() call in us, e.g. to check it against the task watchdog
+uint32_t nikolaindustryrealtime::getMaxStall(bool reset)
+{
+  uint32_t stall = maxStall;
+  if (reset)
+  {
+    maxStall = 0;
+  }
+  return stall;
+}
+
+// an endpoint that failed is skipped for 5 s, doubling with each failover up to NIKOLAINDUSTRY_REPROBE_INTERVAL
+bool nikolaindustryrealtime::endpointDown(uint8_t index)
+{
+  return endpoints[index].failures && (int32_t)(endpoints[index].retryAt - millis()) > 0;
+}
+
+// lower is better: endpoints never tried come first so each one gets measured, then the
+// measured ones by latency, endpoints that never connected but failed come last
+uint32_t nikolaindustryrealtime::endpointRank(uint8_t index)
+{
+  const Endpoint &e = endpoints[index];
+  if (e.latency)
+  {
+    return e.latency;
+  }
+  return e.failures ? 0xFFFFFFFF : 0;
+}
+
+// best ranked endpoint that is not down, measured limits the pick to endpoints that connected before.
+// the current one if no other qualifies
+uint8_t nikolaindustryrealtime::pickEndpoint(bool measured)
+{
+  uint8_t best = endpoint;
+  bool found = false;
+  for (uint8_t i = 0; i < endpointCount; i++)
+  {
+    if (endpointDown(i) || (measured && endpoints[i].latency == 0))
+    {
+      continue;
+    }
+    if (!found || endpointRank(i) < endpointRank(best))
+    {
+      best = i;
+      found = true;
+    }
+  }
+  return best;
+}
+
+// failover after NIKOLAINDUSTRY_FAILOVER_ATTEMPTS failed connects, a new pick after every disconnect
+// and a switch to the best measured endpoint every NIKOLAINDUSTRY_REPROBE_INTERVAL if it is at least
+// 25 % faster (not during a transfer). a working connection is never dropped for an unmeasured endpoint
+void nikolaindustryrealtime::selectEndpoint()
+{
+  if (endpointCount < 2)
+  {
+    return;
+  }
+  uint32_t now = millis();
+
+  if (webSocket.isConnected())
+  {
+    if (now - endpointSince >= NIKOLAINDUSTRY_REPROBE_INTERVAL && !transfer.sending() && !transfer.receiving())
+    {
+      endpointSince = now;
+      uint8_t best = pickEndpoint(true);
+      if (best != endpoint && endpoints[best].latency < endpoints[endpoint].latency * 3 / 4)
+      {
+        Serial.printf("🔀 Switching to %s:%u\n", endpoints[best].host.c_str(), endpoints[best].port);
+        webSocket.disconnect();
+        connect(best);
+      }
+    }
+    return;
+  }
+
+  uint8_t failures = webSocket.getConnectFailures();
+  if (failures != seenFailures)
+  {
+    seenFailures = failures;
+    if (failures && failures % NIKOLAINDUSTRY_FAILOVER_ATTEMPTS == 0)
+    {
+      Endpoint &e = endpoints[endpoint];
+      if (e.failures < 0xFFFF)
+      {
+        e.failures++;
+      }
+      e.retryAt = now + min((uint32_t)NIKOLAINDUSTRY_REPROBE_INTERVAL, (uint32_t)5000 << min(e.failures - 1, 6));
+      reselect = true;
+    }
+  }
+
+  if (reselect)
+  {
+    reselect = false;
+    uint8_t next = pickEndpoint();
+    if (next != endpoint)
+    {
+      Serial.printf("🔀 Failover to %s:%u\n", endpoints[next].host.c_str(), endpoints[next].port);
+      connect(next);
+    }
+  }
+}
+
+// control messages go out first, bulk messages are fragmented so heartbeats are not held back.
+// false if the message was dropped (queue full or not serializable)
+bool nikolaindustryrealtime::sendJson(const JsonObject &json, uint8_t priority)
+{
+  // messages of sub-devices go over the relay, LAN peers only know the gateway
+  const char *targetId = json["targetId"] | "";
+  if (!json.containsKey(NIKOLAINDUSTRY_GATEWAY_AS) && sendLan(targetId, json["payload"], priority))
+  {
+    return true;
+  }
+
+  String output;
+  if (!serializeJson(json, output))
   {
     Serial.println("❌ Failed to serialize JSON!");
+    return false;
+  }
+  if (!lanes.send(std::move(output), priority, nikolaindustryratelimit::targetHash(targetId)))
+  {
+    Serial.println("❌ Send queue full!");
+    return false;
+  }
+  return true;
+}
+
+void nikolaindustryrealtime::sendTo(const String &targetId, std::function<void(JsonObject &)> payloadBuilder, uint8_t priority)
+{
+  nikolaindustryJsonDocument doc(512);
+  doc["targetId"] = targetId;
+  JsonObject payload = doc.createNestedObject("payload");
+  payloadBuilder(payload);
+  sendJson(doc.as<JsonObject>(), priority);
+}
+
+// like sendTo, the payload gets a message id and onResponse runs once with the matching reply,
+// or with ok = false after timeoutMs or a disconnect. false if not connected or too many calls are pending
+bool nikolaindustryrealtime::call(const String &targetId, std::function<void(JsonObject &)> payloadBuilder, RpcCallback onResponse, uint32_t timeoutMs)
+{
+  if (!webSocket.isConnected())
+  {
+    return false;
+  }
+
+  uint32_t id = rpc.add(onResponse, timeoutMs, nikolaindustryratelimit::targetHash(targetId.c_str()));
+  if (!id)
+  {
+    return false;
+  }
+
+  nikolaindustryJsonDocument doc(512);
+  doc["targetId"] = targetId;
+  JsonObject payload = doc.createNestedObject("payload");
+  payloadBuilder(payload);
+  payload[NIKOLAINDUSTRY_RPC_ID] = id;
+
+  if (sendLan(targetId, payload, NIKOLAINDUSTRY_PRIORITY_INTERACTIVE))
+  {
+    return true;
+  }
+
+  String output;
+  if (!serializeJson(doc, output) || !lanes.send(std::move(output), NIKOLAINDUSTRY_PRIORITY_INTERACTIVE, nikolaindustryratelimit::targetHash(targetId.c_str())))
+  {
+    rpc.cancel(id);
+    return false;
+  }
+  return true;
+}
+
+// LAN mode: devices on the same network find each other by UDP broadcast and send
+// to peers they talk to often over a direct connection, the relay is used otherwise.
+// call before or after begin()
+void nikolaindustryrealtime::enableLan()
+{
+  if (lan)
+  {
+    return;
+  }
+  lan = new nikolaindustrylan();
+  lan->onMessage([this](const char *from, uint8_t *payload, size_t length)
+                 { handleText(payload, length, from); });
+  if (deviceId.length() && WiFi.status() == WL_CONNECTED)
+  {
+    lan->begin(deviceId);
+  }
+}
+
+// true if messages to targetId currently go over a direct LAN connection
+bool nikolaindustryrealtime::isDirect(const String &targetId)
+{
+  return lan && lan->isDirect(targetId);
+}
+
+// sends {"from": deviceId, "payload": ...} directly to a LAN peer, false if there is no direct connection.
+// a direct message takes the same tokens as one over the relay; when the limiter refuses it, or messages
+// of its priority still wait, it goes into the send lanes instead, which keeps the order and counts the delay
+bool nikolaindustryrealtime::sendLan(const String &targetId, JsonObject payload, uint8_t priority)
+{
+  if (!lan || targetId.length() == 0)
+  {
+    return false;
+  }
+
+  nikolaindustryJsonDocument doc(payload.memoryUsage() + JSON_OBJECT_SIZE(2));
+  doc["from"] = deviceId.c_str();
+  doc["payload"] = payload;
+  if (doc.overflowed())
+  {
+    return false;
+  }
+
+  String output;
+  if (!serializeJson(doc, output))
+  {
+    return false;
   }
+
+  if (priority != NIKOLAINDUSTRY_PRIORITY_CONTROL && lan->isDirect(targetId))
+  {
+    uint8_t lane = priority < NIKOLAINDUSTRY_PRIORITY_COUNT ? priority : NIKOLAINDUSTRY_PRIORITY_BULK;
+    if (lanes.queued(lane) || !limiter.admit(nikolaindustryratelimit::targetHash(targetId.c_str()), output.length()))
+    {
+      return false;
+    }
+  }
+  return lan->send(targetId, output);
 }
 
-void nikolaindustryrealtime::sendTo(const String &targetId, std::function<void(JsonObject &)> payloadBuilder)
+// answers a received message, the response carries the message id of a call()
+void nikolaindustryrealtime::reply(JsonObject &request, std::function<void(JsonObject &)> payloadBuilder)
 {
-  DynamicJsonDocument doc(512);
+  String from = request["from"] | "";
+  if (from == "")
+  {
+    return;
+  }
+
+  nikolaindustryJsonDocument doc(512);
+  doc["targetId"] = from;
+  JsonObject payload = doc.createNestedObject("payload");
+  payloadBuilder(payload);
+
+  // answer in the name of the sub-device it was sent to
+  const char *to = request[NIKOLAINDUSTRY_GATEWAY_TO] | "";
+  if (gateway.contains(to))
+  {
+    doc[NIKOLAINDUSTRY_GATEWAY_AS] = to;
+  }
+
+  JsonVariant id = request["payload"][NIKOLAINDUSTRY_RPC_ID];
+  if (!id.isNull())
+  {
+    payload[NIKOLAINDUSTRY_RPC_REPLY] = id;
+  }
+  sendJson(doc.as<JsonObject>(), NIKOLAINDUSTRY_PRIORITY_CONTROL);
+}
+
+// responses to call() are handled here and do not reach onMessageCallback. a "_re" that matches
+// no pending call of its sender (late, or a reply to someone else's request) goes on to onMessageCallback
+bool nikolaindustryrealtime::handleResponse(JsonObject &msg)
+{
+  JsonObject payload = msg["payload"];
+  if (payload.isNull() || !payload.containsKey(NIKOLAINDUSTRY_RPC_REPLY))
+  {
+    return false;
+  }
+  const char *from = msg["from"] | "";
+  return rpc.resolve(payload[NIKOLAINDUSTRY_RPC_REPLY].as<uint32_t>(), nikolaindustryratelimit::targetHash(from), payload);
+}
+
+// received data is written to sink, e.g. a nikolaindustryUpdateSink for firmware updates.
+// without a sink offered transfers are rejected
+void nikolaindustryrealtime::setTransferSink(nikolaindustryTransferSink *sink)
+{
+  transfer.setSink(sink);
+}
+
+// sends size bytes from source in chunks with crc, acks and resume after a reconnect.
+// false if a transfer is already running
+bool nikolaindustryrealtime::sendFile(const String &targetId, const char *name, nikolaindustryTransferSource *source, uint32_t size, TransferCallback onDone)
+{
+  return transfer.send(targetId, name, source, size, onDone);
+}
+
+// gateway mode: sub-devices (BLE, RS-485, ...) share this connection instead of each opening
+// its own. the relay is told their ids and delivers their messages with "to": deviceId,
+// messages sent with sendAs() carry "as": deviceId. false if the id is in use or the table is full
+bool nikolaindustryrealtime::addDevice(const char *_deviceId, DeviceCallback onMessage)
+{
+  if (!gateway.add(_deviceId, onMessage))
+  {
+    return false;
+  }
+  if (webSocket.isConnected())
+  {
+    sendRegister("register", _deviceId);
+  }
+  return true;
+}
+
+bool nikolaindustryrealtime::removeDevice(const char *_deviceId)
+{
+  if (!gateway.remove(_deviceId))
+  {
+    return false;
+  }
+  if (webSocket.isConnected())
+  {
+    sendRegister("unregister", _deviceId);
+  }
+  return true;
+}
+
+// like sendTo, the receiver sees the message from deviceId
+void nikolaindustryrealtime::sendAs(const String &_deviceId, const String &targetId, std::function<void(JsonObject &)> payloadBuilder, uint8_t priority)
+{
+  nikolaindustryJsonDocument doc(512);
   doc["targetId"] = targetId;
+  doc[NIKOLAINDUSTRY_GATEWAY_AS] = _deviceId;
   JsonObject payload = doc.createNestedObject("payload");
   payloadBuilder(payload);
-  sendJson(doc.as<JsonObject>());
+  sendJson(doc.as<JsonObject>(), priority);
+}
+
+// {"register": ["sensor-1", ...]} with one id, or all sub-devices after connecting
+void nikolaindustryrealtime::sendRegister(const char *key, const char *_deviceId)
+{
+  nikolaindustryJsonDocument doc(JSON_OBJECT_SIZE(1) + JSON_ARRAY_SIZE(NIKOLAINDUSTRY_GATEWAY_DEVICES));
+  JsonArray ids = doc.createNestedArray(key);
+  if (_deviceId)
+  {
+    ids.add(_deviceId);
+  }
+  else
+  {
+    gateway.forEach([&ids](const char *id)
+                    { ids.add(id); });
+  }
+
+  String output;
+  serializeJson(doc, output);
+  lanes.send(std::move(output), NIKOLAINDUSTRY_PRIORITY_CONTROL);
+}
+
+// GPIO_MANAGEMENT commands run by the library (see nikolaindustrygpio) and are answered with
+// {"response": "GPIO_OK", "us": ..., "actions": ..., "cached": ...}. hal defaults to the set / clear
+// registers on ESP32. call before begin()
+void nikolaindustryrealtime::enableGpioCommands(nikolaindustryGpioHal *hal)
+{
+  if (gpio)
+  {
+    return;
+  }
+  if (!hal)
+  {
+#ifdef ESP32
+    static nikolaindustryEsp32Gpio registers;
+#else
+    static nikolaindustryArduinoGpio registers;
+#endif
+    hal = &registers;
+  }
+  gpio = new nikolaindustrygpio(hal);
+
+  // a filter set before has to keep the commands now
+  if (hasFilter)
+  {
+    nikolaindustryJsonDocument previous = filter;
+    setMessageFilter(previous);
+  }
+}
+
+// a message with only GPIO_MANAGEMENT commands stops here, with other commands as well it also goes
+// to the message callback, which has to skip the GPIO ones then
+bool nikolaindustryrealtime::handleGpio(JsonObject &msg)
+{
+  if (!gpio)
+  {
+    return false;
+  }
+  JsonArray commands = msg["payload"]["commands"];
+  if (commands.isNull())
+  {
+    return false;
+  }
+
+  bool other = false;
+  for (JsonObject command : commands)
+  {
+    if (strcmp(command["command"] | "", NIKOLAINDUSTRY_GPIO_COMMAND) != 0)
+    {
+      other = true;
+      continue;
+    }
+    nikolaindustryGpioResult result;
+    bool ok = gpio->execute(command["actions"], &result);
+    reply(msg, [&](JsonObject &payload)
+          {
+      payload["response"] = ok ? "GPIO_OK" : "GPIO_ERROR";
+      payload["us"] = result.us;
+      payload["actions"] = result.actions;
+      payload["cached"] = result.cached; });
+  }
+  return !other;
+}
+
+// messages for a sub-device go to its callback, messages for an unknown one are dropped
+bool nikolaindustryrealtime::handleGateway(JsonObject &msg)
+{
+  const char *to = msg[NIKOLAINDUSTRY_GATEWAY_TO] | "";
+  if (!*to || deviceId == to)
+  {
+    return false;
+  }
+  if (!gateway.dispatch(to, msg))
+  {
+    Serial.printf("❌ Message for unknown device %s\n", to);
+  }
+  return true;
+}
+
+// offers, acks and errors of chunked transfers
+bool nikolaindustryrealtime::handleTransfer(JsonObject &msg)
+{
+  JsonObject control = msg["payload"][NIKOLAINDUSTRY_TRANSFER_KEY];
+  if (control.isNull())
+  {
+    return false;
+  }
+  transfer.handleControl(msg["from"] | "", control);
+  return true;
+}
+
+// {"throttle": {"msgs": 2, "bytes": 1024, "ms": 60000}} from the server slows the device down,
+// all 0 (or missing) ends it. interactive and bulk messages wait in their lane, replies are not limited
+// only the relay itself sends hints: messages of devices carry "from" (LAN messages get it set
+// by handleText), a "throttle" in them is left to onMessageCallback
+bool nikolaindustryrealtime::handleThrottle(JsonObject &msg)
+{
+  JsonObject hint = msg["throttle"];
+  if (hint.isNull() || msg.containsKey("from"))
+  {
+    return false;
+  }
+  uint32_t msgs = hint["msgs"] | (uint32_t)0;
+  if (msgs > 0xFFFF)
+  {
+    msgs = 0xFFFF;
+  }
+  uint32_t bytes = hint["bytes"] | (uint32_t)0;
+  limiter.throttle((uint16_t)msgs, bytes, hint["ms"] | (uint32_t)0);
+  Serial.printf("⏳ throttled to %u msgs/s %lu bytes/s\n", (unsigned)msgs, (unsigned long)bytes);
+  return true;
+}
+
+// global token bucket, rates of 0 are unlimited
+void nikolaindustryrealtime::setRateLimit(uint16_t msgsPerSec, uint32_t bytesPerSec, uint16_t burstMsgs, uint32_t burstBytes)
+{
+  limiter.setGlobal(msgsPerSec, bytesPerSec, burstMsgs, burstBytes);
+}
+
+// token bucket per target id, for the NIKOLAINDUSTRY_RATELIMIT_TARGETS most recently used targets
+void nikolaindustryrealtime::setTargetRateLimit(uint16_t msgsPerSec, uint16_t burstMsgs)
+{
+  limiter.setPerTarget(msgsPerSec, burstMsgs);
+}
+
+void nikolaindustryrealtime::getRateStats(nikolaindustryRateStats *stats)
+{
+  limiter.getStats(stats);
 }
 
 void nikolaindustryrealtime::setOnMessageCallback(std::function<void(JsonObject &)> callback)
@@ -90,3 +844,54 @@ bool nikolaindustryrealtime::isNikolaindustryRealtimeConnected()
 {
   return webSocket.isConnected();
 }
+
+// closes the connection, loop() connects again (e.g. to test reconnects)
+void nikolaindustryrealtime::disconnect()
+{
+  webSocket.disconnect();
+}
+
+// pings carry a sequence and timestamp, the pongs give rtt and loss (see getLinkQuality)
+void nikolaindustryrealtime::enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount, bool adaptive)
+{
+  webSocket.enableHeartbeat(pingInterval, pongTimeout, disconnectTimeoutCount);
+  webSocket.setAdaptiveHeartbeat(adaptive);
+}
+
+void nikolaindustryrealtime::getLinkQuality(WSlinkQuality_t *quality)
+{
+  webSocket.getLinkQuality(quality);
+}
+
+#ifdef WEBSOCKETS_METRICS
+void nikolaindustryrealtime::getMetrics(WSmetrics_t *metrics)
+{
+  webSocket.getMetrics(metrics);
+}
+
+String nikolaindustryrealtime::getMetricsJson()
+{
+  WSmetrics_t metrics;
+  webSocket.getMetrics(&metrics);
+
+  char buffer[WEBSOCKETS_METRICS_JSON_SIZE];
+  if (!WebSocketsMetrics::toJson(&metrics, buffer, sizeof(buffer)))
+  {
+    Serial.println("❌ Metrics JSON does not fit its buffer!");
+    return String();
+  }
+  return String(buffer);
+}
+#endif
+
+#ifdef WEBSOCKETS_MEMORY
+String nikolaindustryrealtime::getMemoryReport()
+{
+  char buffer[1024];
+  if (!WebSocketsMemory::toJson(buffer, sizeof(buffer)))
+  {
+    return String();
+  }
+  return String(buffer);
+}
+#endif
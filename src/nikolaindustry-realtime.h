@@ -5,27 +5,160 @@
 #include <WebSocketsClient.h>
 #include <ArduinoJson.h>
 #include <functional>
+#include "nikolaindustry-json.h"
+#include "nikolaindustry-rpc.h"
+#include "nikolaindustry-lanes.h"
+#include "nikolaindustry-ratelimit.h"
+#include "nikolaindustry-transfer.h"
+#include "nikolaindustry-lan.h"
+#include "nikolaindustry-gateway.h"
+#include "nikolaindustry-gpio.h"
+
+// document size for incoming messages, larger messages go to the parse error callback
+#ifndef NIKOLAINDUSTRY_JSON_CAPACITY
+#define NIKOLAINDUSTRY_JSON_CAPACITY 2048
+#endif
+
+// largest fragmented message that is reassembled, bigger ones are dropped
+#ifndef NIKOLAINDUSTRY_FRAGMENT_MAX
+#define NIKOLAINDUSTRY_FRAGMENT_MAX 4096
+#endif
+
+// relay servers, see addEndpoint()
+#ifndef NIKOLAINDUSTRY_MAX_ENDPOINTS
+#define NIKOLAINDUSTRY_MAX_ENDPOINTS 4
+#endif
+
+// failed connection attempts before switching to another endpoint
+#ifndef NIKOLAINDUSTRY_FAILOVER_ATTEMPTS
+#define NIKOLAINDUSTRY_FAILOVER_ATTEMPTS 1
+#endif
+
+// while connected to an endpoint that is not the best one, switch over after this long
+#ifndef NIKOLAINDUSTRY_REPROBE_INTERVAL
+#define NIKOLAINDUSTRY_REPROBE_INTERVAL 300000
+#endif
+
+struct nikolaindustryEndpointStats
+{
+  uint32_t latency;  // handshake time in ms (moving average), 0 if never connected
+  uint16_t failures; // failovers away from it since its last connection
+  bool active;
+  bool down; // skipped until its backoff ends
+};
 
 class nikolaindustryrealtime {
 public:
   nikolaindustryrealtime();
   void begin(const char *deviceId);
+  void setEndpoint(const char *host, uint16_t port = 443, bool ssl = true, const char *path = "/");
+  bool addEndpoint(const char *host, uint16_t port = 443, bool ssl = true, const char *path = "/");
+  bool getEndpointStats(uint8_t index, nikolaindustryEndpointStats *stats);
   void loop();
-  void sendJson(const JsonObject &json);
-  void sendTo(const String &targetId, std::function<void(JsonObject &)> payloadBuilder);
+  void loop(uint32_t budgetUs);
+  uint32_t getMaxStall(bool reset = false);
+  bool sendJson(const JsonObject &json, uint8_t priority = NIKOLAINDUSTRY_PRIORITY_INTERACTIVE);
+  void sendTo(const String &targetId, std::function<void(JsonObject &)> payloadBuilder, uint8_t priority = NIKOLAINDUSTRY_PRIORITY_INTERACTIVE);
+  bool call(const String &targetId, std::function<void(JsonObject &)> payloadBuilder, RpcCallback onResponse, uint32_t timeoutMs = 5000);
+  void reply(JsonObject &request, std::function<void(JsonObject &)> payloadBuilder);
+
+  void setTransferSink(nikolaindustryTransferSink *sink);
+  bool sendFile(const String &targetId, const char *name, nikolaindustryTransferSource *source, uint32_t size, TransferCallback onDone = nullptr);
 
   void setOnMessageCallback(std::function<void(JsonObject &)> callback);
   void setOnConnectionStatusChange(std::function<void(bool)> callback);
+  void setOnParseError(std::function<void(DeserializationError, size_t)> callback);
+  bool setMessageFilter(const JsonDocument &filter);
+  void clearMessageFilter();
+  void setZeroCopyParsing(bool enable);
   bool isNikolaindustryRealtimeConnected();
+  void disconnect();
+
+  bool addDevice(const char *deviceId, DeviceCallback onMessage);
+  bool removeDevice(const char *deviceId);
+  void sendAs(const String &deviceId, const String &targetId, std::function<void(JsonObject &)> payloadBuilder, uint8_t priority = NIKOLAINDUSTRY_PRIORITY_INTERACTIVE);
+
+  void enableLan();
+  bool isDirect(const String &targetId);
+
+  void enableGpioCommands(nikolaindustryGpioHal *hal = nullptr);
+
+  void enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount, bool adaptive = true);
+  void getLinkQuality(WSlinkQuality_t *quality);
+
+  void setRateLimit(uint16_t msgsPerSec, uint32_t bytesPerSec, uint16_t burstMsgs, uint32_t burstBytes);
+  void setTargetRateLimit(uint16_t msgsPerSec, uint16_t burstMsgs);
+  void getRateStats(nikolaindustryRateStats *stats);
+
+#ifdef WEBSOCKETS_METRICS
+  void getMetrics(WSmetrics_t *metrics);
+  String getMetricsJson();
+#endif
+
+#ifdef WEBSOCKETS_MEMORY
+  // heap held per subsystem and the heap at the last connect / disconnect, see WebSocketsMemory
+  String getMemoryReport();
+#endif
 
 private:
   WebSocketsClient webSocket;
+  nikolaindustrylanes lanes;
+  nikolaindustryratelimit limiter;
+  nikolaindustrytransfer transfer;
   String deviceId;
 
+  struct Endpoint
+  {
+    String host;
+    uint16_t port;
+    bool ssl;
+    String path;
+    uint32_t latency;  // ewma of the handshake time, 0 = not measured
+    uint16_t failures; // consecutive failovers
+    uint32_t retryAt;  // skipped before this while failures > 0
+  };
+  Endpoint endpoints[NIKOLAINDUSTRY_MAX_ENDPOINTS];
+  uint8_t endpointCount = 0;
+  uint8_t endpoint = 0;        // current one
+  uint32_t endpointSince = 0;  // connected since
+  uint8_t seenFailures = 0;    // connect failures of webSocket already handled
+  bool reselect = false;
+
+  uint8_t loopStage = 0; // stage the next loop() starts with
+  uint32_t maxStall = 0; // us, longest loop()
+
   std::function<void(JsonObject &)> onMessageCallback;
   std::function<void(bool)> onConnectionStatusChange;
+  std::function<void(DeserializationError, size_t)> onParseError;
+
+  nikolaindustryJsonDocument filter{0}; // sized by setMessageFilter()
+  bool hasFilter = false;
+  bool zeroCopy = false;
+
+  uint8_t *fragments = nullptr; // fragmented message being reassembled
+  size_t fragmentsLength = 0;
+  bool fragmentsBinary = false;
+
+  nikolaindustryrpc rpc;
+  nikolaindustrylan *lan = nullptr; // allocated by enableLan()
+  nikolaindustrygateway gateway;
+  nikolaindustrygpio *gpio = nullptr; // allocated by enableGpioCommands()
 
-  void connect();
+  void connect(uint8_t index);
+  void runLoopStage(uint8_t stage, uint32_t budgetUs);
+  void selectEndpoint();
+  uint8_t pickEndpoint(bool measured = false);
+  uint32_t endpointRank(uint8_t index);
+  bool endpointDown(uint8_t index);
+  void handleText(uint8_t *payload, size_t length, const char *from = nullptr);
+  bool sendLan(const String &targetId, JsonObject payload, uint8_t priority);
+  bool handleResponse(JsonObject &msg);
+  bool handleThrottle(JsonObject &msg);
+  bool handleTransfer(JsonObject &msg);
+  bool handleGateway(JsonObject &msg);
+  bool handleGpio(JsonObject &msg);
+  void sendRegister(const char *key, const char *deviceId);
+  void handleFragment(WStype_t type, uint8_t *payload, size_t length);
 };
 
 #endif
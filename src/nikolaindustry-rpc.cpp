@@ -0,0 +1,219 @@
+#include "nikolaindustry-rpc.h"
+
+nikolaindustryrpc::nikolaindustryrpc() {}
+
+// returns the message id for the request, 0 if NIKOLAINDUSTRY_RPC_MAX_PENDING calls are in flight.
+// target is the hash of the device the request goes to, only its response resolves the call
+uint32_t nikolaindustryrpc::add(RpcCallback callback, uint32_t timeoutMs, uint32_t target)
+{
+  if (count >= NIKOLAINDUSTRY_RPC_MAX_PENDING)
+  {
+    return 0;
+  }
+
+  // a late response to a call of the previous boot must not match a new call
+  if (nextId == 0)
+  {
+    nextId = (uint32_t)random(1, 0x7FFFFFFF);
+  }
+
+  do
+  {
+    nextId++;
+  } while (nextId == 0 || find(nextId) >= 0);
+
+  uint8_t slot = home(nextId);
+  while (table[slot].id)
+  {
+    slot = (slot + 1) & (TABLE_SIZE - 1);
+  }
+
+  table[slot].id = nextId;
+  table[slot].deadline = millis() + timeoutMs;
+  table[slot].target = target;
+  table[slot].callback = callback;
+
+  heap[count] = slot;
+  table[slot].heapPos = count;
+  count++;
+  heapUp(count - 1);
+
+  return nextId;
+}
+
+// drops a call without running its callback
+bool nikolaindustryrpc::cancel(uint32_t id)
+{
+  int slot = find(id);
+  if (slot < 0)
+  {
+    return false;
+  }
+  remove(slot);
+  return true;
+}
+
+// runs the callback of a pending call, false for unknown or already expired ids
+// and for a response from another device than the one the request went to
+bool nikolaindustryrpc::resolve(uint32_t id, uint32_t from, JsonObject &response)
+{
+  int slot = find(id);
+  if (slot < 0 || table[slot].target != from)
+  {
+    return false;
+  }
+  finish(slot, true, response);
+  return true;
+}
+
+void nikolaindustryrpc::expire(uint32_t now)
+{
+  failDue(false, now);
+}
+
+void nikolaindustryrpc::failAll()
+{
+  failDue(true, 0);
+}
+
+// the due calls are removed first and their callbacks run after the pass,
+// a call issued from one of them (even with timeout 0) waits for the next expire()
+void nikolaindustryrpc::failDue(bool all, uint32_t now)
+{
+  RpcCallback due[NIKOLAINDUSTRY_RPC_MAX_PENDING];
+  uint8_t dueCount = 0;
+  while (count && (all || !before(now, table[heap[0]].deadline)))
+  {
+    due[dueCount++] = remove(heap[0]);
+  }
+
+  StaticJsonDocument<16> doc;
+  JsonObject empty = doc.to<JsonObject>();
+  for (uint8_t i = 0; i < dueCount; i++)
+  {
+    if (due[i])
+    {
+      due[i](false, empty);
+    }
+  }
+}
+
+int nikolaindustryrpc::find(uint32_t id) const
+{
+  uint8_t slot = home(id);
+  for (uint8_t i = 0; i < TABLE_SIZE; i++)
+  {
+    if (table[slot].id == 0)
+    {
+      return -1;
+    }
+    if (table[slot].id == id)
+    {
+      return slot;
+    }
+    slot = (slot + 1) & (TABLE_SIZE - 1);
+  }
+  return -1;
+}
+
+// unlinks a slot from the heap and the table, returns its callback
+RpcCallback nikolaindustryrpc::remove(uint8_t slot)
+{
+  RpcCallback callback = std::move(table[slot].callback);
+
+  uint8_t pos = table[slot].heapPos;
+  count--;
+  if (pos != count)
+  {
+    heap[pos] = heap[count];
+    table[heap[pos]].heapPos = pos;
+    heapDown(pos);
+    heapUp(pos);
+  }
+
+  // backward shift the following entries of the probe run, no tombstones needed
+  table[slot].id = 0;
+  table[slot].callback = nullptr;
+  uint8_t hole = slot;
+  uint8_t next = slot;
+  while (true)
+  {
+    next = (next + 1) & (TABLE_SIZE - 1);
+    if (table[next].id == 0)
+    {
+      break;
+    }
+    uint8_t h = home(table[next].id);
+    if (((next - h) & (TABLE_SIZE - 1)) >= ((next - hole) & (TABLE_SIZE - 1)))
+    {
+      table[hole].id = table[next].id;
+      table[hole].deadline = table[next].deadline;
+      table[hole].target = table[next].target;
+      table[hole].heapPos = table[next].heapPos;
+      table[hole].callback = std::move(table[next].callback);
+      heap[table[hole].heapPos] = hole;
+      table[next].id = 0;
+      table[next].callback = nullptr;
+      hole = next;
+    }
+  }
+
+  return callback;
+}
+
+void nikolaindustryrpc::heapSwap(uint8_t a, uint8_t b)
+{
+  uint8_t slot = heap[a];
+  heap[a] = heap[b];
+  heap[b] = slot;
+  table[heap[a]].heapPos = a;
+  table[heap[b]].heapPos = b;
+}
+
+void nikolaindustryrpc::heapUp(uint8_t pos)
+{
+  while (pos > 0)
+  {
+    uint8_t parent = (pos - 1) / 2;
+    if (!before(table[heap[pos]].deadline, table[heap[parent]].deadline))
+    {
+      break;
+    }
+    heapSwap(pos, parent);
+    pos = parent;
+  }
+}
+
+void nikolaindustryrpc::heapDown(uint8_t pos)
+{
+  while (true)
+  {
+    uint8_t smallest = pos;
+    uint8_t left = pos * 2 + 1;
+    uint8_t right = left + 1;
+    if (left < count && before(table[heap[left]].deadline, table[heap[smallest]].deadline))
+    {
+      smallest = left;
+    }
+    if (right < count && before(table[heap[right]].deadline, table[heap[smallest]].deadline))
+    {
+      smallest = right;
+    }
+    if (smallest == pos)
+    {
+      break;
+    }
+    heapSwap(pos, smallest);
+    pos = smallest;
+  }
+}
+
+// the entry is removed before the callback runs, so the callback may issue new calls
+void nikolaindustryrpc::finish(uint8_t slot, bool ok, JsonObject &response)
+{
+  RpcCallback callback = remove(slot);
+  if (callback)
+  {
+    callback(ok, response);
+  }
+}
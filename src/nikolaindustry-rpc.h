@@ -0,0 +1,70 @@
+#ifndef NIKOLAINDUSTRY_RPC_H
+#define NIKOLAINDUSTRY_RPC_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <functional>
+
+// max calls in flight, call() fails when all are used
+#ifndef NIKOLAINDUSTRY_RPC_MAX_PENDING
+#define NIKOLAINDUSTRY_RPC_MAX_PENDING 8
+#endif
+
+// slots of the pending table, power of 2 and at least twice NIKOLAINDUSTRY_RPC_MAX_PENDING
+#ifndef NIKOLAINDUSTRY_RPC_TABLE_SIZE
+#define NIKOLAINDUSTRY_RPC_TABLE_SIZE 16
+#endif
+
+// message id fields inside "payload": "_id" on the request, "_re" on the response
+#define NIKOLAINDUSTRY_RPC_ID "_id"
+#define NIKOLAINDUSTRY_RPC_REPLY "_re"
+
+// ok is false on timeout or disconnect, response is empty then
+typedef std::function<void(bool ok, JsonObject &response)> RpcCallback;
+
+// pending calls, open addressed by message id (linear probing, backward shift delete)
+// plus a min-heap on the deadline, so matching a response and expiring are O(1) / O(log n)
+class nikolaindustryrpc {
+public:
+  nikolaindustryrpc();
+
+  uint32_t add(RpcCallback callback, uint32_t timeoutMs, uint32_t target);
+  bool cancel(uint32_t id);
+  bool resolve(uint32_t id, uint32_t from, JsonObject &response);
+  void expire(uint32_t now);
+  void failAll();
+  uint8_t pending() const { return count; }
+
+private:
+  static const uint8_t TABLE_SIZE = NIKOLAINDUSTRY_RPC_TABLE_SIZE;
+  static_assert((TABLE_SIZE & (TABLE_SIZE - 1)) == 0 && TABLE_SIZE >= NIKOLAINDUSTRY_RPC_MAX_PENDING * 2 && TABLE_SIZE <= 128,
+                "NIKOLAINDUSTRY_RPC_TABLE_SIZE has to be a power of 2, >= 2 * NIKOLAINDUSTRY_RPC_MAX_PENDING and <= 128");
+
+  struct Entry
+  {
+    uint32_t id = 0; // 0 = free
+    uint32_t deadline = 0;
+    uint32_t target = 0; // hash of the device the request went to, see nikolaindustryratelimit::targetHash
+    uint8_t heapPos = 0;
+    RpcCallback callback;
+  };
+
+  Entry table[TABLE_SIZE];
+  uint8_t heap[NIKOLAINDUSTRY_RPC_MAX_PENDING]; // table slots ordered by deadline
+  uint8_t count = 0;
+  uint32_t nextId = 0; // seeded randomly by the first add(), so ids of a previous boot are not reused
+
+  static uint8_t home(uint32_t id) { return (id * 2654435761UL) >> 24 & (TABLE_SIZE - 1); }
+  static bool before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+  int find(uint32_t id) const;
+  RpcCallback remove(uint8_t slot);
+
+  void heapSwap(uint8_t a, uint8_t b);
+  void heapUp(uint8_t pos);
+  void heapDown(uint8_t pos);
+  void finish(uint8_t slot, bool ok, JsonObject &response);
+  void failDue(bool all, uint32_t now);
+};
+
+#endif
@@ -0,0 +1,411 @@
+#include "nikolaindustry-state.h"
+
+nikolaindustrystate::nikolaindustrystate(nikolaindustryrealtime &_realtime) : realtime(_realtime) {}
+
+// changes are sent to targetId at most every intervalMs, a full snapshot every snapshotMs (0 = only on connect and request)
+void nikolaindustrystate::begin(const String &_targetId, uint32_t intervalMs, uint32_t snapshotMs)
+{
+  targetId = _targetId;
+  interval = intervalMs;
+  snapshotInterval = snapshotMs;
+  running = true;
+  snapshotDue = true;
+}
+
+void nikolaindustrystate::loop()
+{
+  if (!running)
+  {
+    return;
+  }
+
+  bool connected = realtime.isNikolaindustryRealtimeConnected();
+  if (connected && !online)
+  {
+    // the peer may have missed patches while we were offline
+    snapshotDue = true;
+  }
+  online = connected;
+  if (!online)
+  {
+    return;
+  }
+
+  uint32_t now = millis();
+  if (snapshotInterval && now - lastSnapshot >= snapshotInterval)
+  {
+    snapshotDue = true;
+  }
+  if (snapshotDue)
+  {
+    send(true);
+  }
+  else if (dirtyCount && now - lastSent >= interval)
+  {
+    send(false);
+  }
+}
+
+bool nikolaindustrystate::handleMessage(JsonObject &msg)
+{
+  JsonObject state = msg["payload"][NIKOLAINDUSTRY_STATE_KEY];
+  if (state.isNull())
+  {
+    return false;
+  }
+  const char *from = msg["from"] | "";
+  if (targetId.length() && targetId != from)
+  {
+    return false;
+  }
+
+  if (state["resync"] | false)
+  {
+    snapshotDue = true;
+    return true;
+  }
+
+  uint32_t v = state["v"] | 0;
+  bool full = state["full"] | false;
+  if (!full && (remoteVersion == 0 || (uint32_t)(state["base"] | 0) != remoteVersion))
+  {
+    // a patch was lost or we restarted, the changes since the last snapshot are unknown
+    sendResync();
+    return true;
+  }
+
+  remoteVersion = v;
+  for (JsonPair pair : state["set"].as<JsonObject>())
+  {
+    apply(pair.key().c_str(), pair.value());
+  }
+  return true;
+}
+
+bool nikolaindustrystate::set(const char *key, long value)
+{
+  Entry *entry = slot(key);
+  if (!entry)
+  {
+    return false;
+  }
+  if (entry->type != STATE_INT || entry->i != value)
+  {
+    entry->type = STATE_INT;
+    entry->i = value;
+    changed(*entry);
+  }
+  return true;
+}
+
+bool nikolaindustrystate::set(const char *key, float value)
+{
+  Entry *entry = slot(key);
+  if (!entry)
+  {
+    return false;
+  }
+  if (entry->type != STATE_FLOAT || entry->f != value)
+  {
+    entry->type = STATE_FLOAT;
+    entry->f = value;
+    changed(*entry);
+  }
+  return true;
+}
+
+bool nikolaindustrystate::set(const char *key, bool value)
+{
+  Entry *entry = slot(key);
+  if (!entry)
+  {
+    return false;
+  }
+  if (entry->type != STATE_BOOL || entry->b != value)
+  {
+    entry->type = STATE_BOOL;
+    entry->b = value;
+    changed(*entry);
+  }
+  return true;
+}
+
+bool nikolaindustrystate::set(const char *key, const char *value)
+{
+  Entry *entry = slot(key);
+  if (!entry)
+  {
+    return false;
+  }
+  if (entry->type != STATE_STRING || entry->s != value)
+  {
+    entry->type = STATE_STRING;
+    entry->s = value;
+    changed(*entry);
+  }
+  return true;
+}
+
+long nikolaindustrystate::getInt(const char *key, long def) const
+{
+  int8_t index = find(key);
+  if (index < 0)
+  {
+    return def;
+  }
+  const Entry &entry = entries[index];
+  switch (entry.type)
+  {
+  case STATE_INT:
+    return entry.i;
+  case STATE_FLOAT:
+    return (long)entry.f;
+  case STATE_BOOL:
+    return entry.b;
+  default:
+    return def;
+  }
+}
+
+float nikolaindustrystate::getFloat(const char *key, float def) const
+{
+  int8_t index = find(key);
+  if (index < 0)
+  {
+    return def;
+  }
+  const Entry &entry = entries[index];
+  switch (entry.type)
+  {
+  case STATE_INT:
+    return entry.i;
+  case STATE_FLOAT:
+    return entry.f;
+  case STATE_BOOL:
+    return entry.b;
+  default:
+    return def;
+  }
+}
+
+bool nikolaindustrystate::getBool(const char *key, bool def) const
+{
+  int8_t index = find(key);
+  if (index < 0)
+  {
+    return def;
+  }
+  const Entry &entry = entries[index];
+  switch (entry.type)
+  {
+  case STATE_INT:
+    return entry.i != 0;
+  case STATE_FLOAT:
+    return entry.f != 0;
+  case STATE_BOOL:
+    return entry.b;
+  default:
+    return def;
+  }
+}
+
+const char *nikolaindustrystate::getString(const char *key, const char *def) const
+{
+  int8_t index = find(key);
+  if (index < 0 || entries[index].type != STATE_STRING)
+  {
+    return def;
+  }
+  return entries[index].s.c_str();
+}
+
+int8_t nikolaindustrystate::find(const char *key) const
+{
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_STATE_KEYS; i++)
+  {
+    if (entries[i].key.length() && entries[i].key == key)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// the entry for key, a new one if the key is not known yet
+nikolaindustrystate::Entry *nikolaindustrystate::slot(const char *key)
+{
+  int8_t index = find(key);
+  if (index >= 0)
+  {
+    return &entries[index];
+  }
+  if (!key || !*key)
+  {
+    return nullptr;
+  }
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_STATE_KEYS; i++)
+  {
+    Entry &entry = entries[i];
+    if (!entry.key.length())
+    {
+      entry.key = key;
+      entry.type = STATE_NONE;
+      entry.i = 0;
+      entry.dirty = false;
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+void nikolaindustrystate::changed(Entry &entry)
+{
+  if (entry.type != STATE_STRING)
+  {
+    entry.s = String();
+  }
+  if (!entry.dirty)
+  {
+    entry.dirty = true;
+    dirtyCount++;
+  }
+}
+
+// full: all keys, otherwise only the dirty ones. a sent message clears the dirty flags either way,
+// one the send lanes do not take changes nothing, the next loop() tries again
+void nikolaindustrystate::send(bool full)
+{
+  uint8_t keys = 0;
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_STATE_KEYS; i++)
+  {
+    if (entries[i].key.length() && (full || entries[i].dirty))
+    {
+      keys++;
+    }
+  }
+
+  // keys and strings are linked, not copied, the document only lives until it is serialized
+  nikolaindustryJsonDocument doc(JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(1) + JSON_OBJECT_SIZE(3) + JSON_OBJECT_SIZE(keys));
+  doc["targetId"] = targetId.c_str();
+  JsonObject state = doc.createNestedObject("payload").createNestedObject(NIKOLAINDUSTRY_STATE_KEY);
+  uint32_t base = localVersion;
+  state["v"] = ++localVersion;
+  if (full)
+  {
+    state["full"] = true;
+  }
+  else
+  {
+    state["base"] = base;
+  }
+
+  JsonObject values = state.createNestedObject("set");
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_STATE_KEYS; i++)
+  {
+    Entry &entry = entries[i];
+    if (!entry.key.length() || !(full || entry.dirty))
+    {
+      continue;
+    }
+    JsonVariant value = values[entry.key.c_str()];
+    switch (entry.type)
+    {
+    case STATE_INT:
+      value.set(entry.i);
+      break;
+    case STATE_FLOAT:
+      value.set(entry.f);
+      break;
+    case STATE_BOOL:
+      value.set(entry.b);
+      break;
+    case STATE_STRING:
+      value.set(entry.s.c_str());
+      break;
+    default:
+      break;
+    }
+  }
+
+  // snapshots and patches share one lane, on different lanes a patch could overtake the snapshot
+  // it is based on and the peer would ask for a resync every time
+  if (!realtime.sendJson(doc.as<JsonObject>(), NIKOLAINDUSTRY_PRIORITY_INTERACTIVE))
+  {
+    // the peer never sees this version, the next patch has to be based on the last one sent
+    localVersion = base;
+    return;
+  }
+
+  for (uint8_t i = 0; i < NIKOLAINDUSTRY_STATE_KEYS; i++)
+  {
+    entries[i].dirty = false;
+  }
+  dirtyCount = 0;
+  uint32_t now = millis();
+  lastSent = now;
+  if (full)
+  {
+    lastSnapshot = now;
+    snapshotDue = false;
+  }
+}
+
+void nikolaindustrystate::sendResync()
+{
+  realtime.sendTo(targetId, [](JsonObject &payload)
+                  { payload.createNestedObject(NIKOLAINDUSTRY_STATE_KEY)["resync"] = true; },
+                  NIKOLAINDUSTRY_PRIORITY_CONTROL);
+}
+
+// a value from the peer, the key stays clean. it replaces a local change that was not sent yet
+void nikolaindustrystate::apply(const char *key, JsonVariant value)
+{
+  if (!(value.is<bool>() || value.is<long>() || value.is<float>() || value.is<const char *>()))
+  {
+    return;
+  }
+  Entry *entry = slot(key);
+  if (!entry)
+  {
+    return;
+  }
+
+  bool dirty = entry->dirty;
+  if (dirty)
+  {
+    entry->dirty = false;
+    dirtyCount--;
+  }
+
+  if (value.is<bool>())
+  {
+    set(key, value.as<bool>());
+  }
+  else if (value.is<long>())
+  {
+    set(key, value.as<long>());
+  }
+  else if (value.is<float>())
+  {
+    set(key, value.as<float>());
+  }
+  else
+  {
+    set(key, value.as<const char *>());
+  }
+
+  if (entry->dirty)
+  {
+    entry->dirty = false;
+    dirtyCount--;
+    if (onChangeCallback)
+    {
+      onChangeCallback(key);
+    }
+  }
+  else if (dirty)
+  {
+    entry->dirty = true;
+    dirtyCount++;
+  }
+}
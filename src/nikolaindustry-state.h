@@ -0,0 +1,99 @@
+#ifndef NIKOLAINDUSTRY_STATE_H
+#define NIKOLAINDUSTRY_STATE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <functional>
+#include "nikolaindustry-realtime.h"
+
+#ifndef NIKOLAINDUSTRY_STATE_KEYS
+#define NIKOLAINDUSTRY_STATE_KEYS 32
+#endif
+
+// messages are sent as "payload": {"state": {...}}
+#define NIKOLAINDUSTRY_STATE_KEY "state"
+
+// key changed by a patch from the peer
+typedef std::function<void(const char *key)> StateChangeCallback;
+
+// keyed state kept in sync with one peer, only changed keys are sent.
+//
+//   patch     {"v": 12, "base": 11, "set": {"gpio2": true, "temp": 21.5}}
+//   snapshot  {"v": 12, "full": true, "set": {<all keys>}}  on connect, every snapshot interval and on request
+//   resync    {"resync": true}  the receiver missed a version and asks for a snapshot
+//
+// a patch is only applied when its base is the last version received, so a lost message
+// is noticed at the next one. values from the peer do not mark keys dirty, they are not sent back.
+class nikolaindustrystate {
+public:
+  nikolaindustrystate(nikolaindustryrealtime &realtime);
+
+  void begin(const String &targetId, uint32_t intervalMs = 200, uint32_t snapshotMs = 60000);
+  void loop();
+  // call from the message callback, true if msg was a state message
+  bool handleMessage(JsonObject &msg);
+  void onChange(StateChangeCallback callback) { onChangeCallback = callback; }
+
+  // false if the key is new and all NIKOLAINDUSTRY_STATE_KEYS are used
+  bool set(const char *key, long value);
+  bool set(const char *key, int value) { return set(key, (long)value); }
+  bool set(const char *key, float value);
+  bool set(const char *key, bool value);
+  bool set(const char *key, const char *value);
+
+  bool has(const char *key) const { return find(key) >= 0; }
+  long getInt(const char *key, long def = 0) const;
+  float getFloat(const char *key, float def = 0) const;
+  bool getBool(const char *key, bool def = false) const;
+  const char *getString(const char *key, const char *def = "") const;
+
+  uint32_t version() const { return localVersion; }
+
+private:
+  enum Type
+  {
+    STATE_NONE, // new entry, differs from every value
+    STATE_INT,
+    STATE_FLOAT,
+    STATE_BOOL,
+    STATE_STRING
+  };
+
+  struct Entry
+  {
+    String key; // empty = free
+    Type type;
+    union
+    {
+      long i;
+      float f;
+      bool b;
+    };
+    String s;
+    bool dirty;
+  };
+
+  nikolaindustryrealtime &realtime;
+  String targetId;
+  uint32_t interval = 0;
+  uint32_t snapshotInterval = 0;
+  bool running = false;
+  bool online = false;
+  bool snapshotDue = false;
+  uint32_t lastSent = 0;
+  uint32_t lastSnapshot = 0;
+  uint32_t localVersion = 0;
+  uint32_t remoteVersion = 0; // 0 = waiting for a snapshot
+  uint8_t dirtyCount = 0;
+  Entry entries[NIKOLAINDUSTRY_STATE_KEYS];
+  StateChangeCallback onChangeCallback;
+
+  int8_t find(const char *key) const;
+  Entry *slot(const char *key);
+  void changed(Entry &entry);
+  void send(bool full);
+  void sendResync();
+  void apply(const char *key, JsonVariant value);
+};
+
+#endif
@@ -0,0 +1,190 @@
+#include "nikolaindustry-telemetry.h"
+
+nikolaindustrytelemetry::nikolaindustrytelemetry(nikolaindustryrealtime &_realtime) : realtime(_realtime) {}
+
+nikolaindustrytelemetry::~nikolaindustrytelemetry()
+{
+  for (uint8_t i = 0; i < channelCount; i++)
+  {
+    WEBSOCKETS_FREE(channels[i].ring);
+  }
+}
+
+// batches go to targetId every windowMs, at bulk priority. false for a window of 0
+bool nikolaindustrytelemetry::begin(const String &_targetId, uint32_t windowMs)
+{
+  if (windowMs == 0)
+  {
+    return false;
+  }
+  targetId = _targetId;
+  window = windowMs;
+  windowStart = millis();
+  running = true;
+  return true;
+}
+
+// reader is called every intervalMs. rawScale > 0 also sends the samples of the window,
+// as multiples of rawScale (e.g. 0.1 for one decimal). false if all channels are used
+bool nikolaindustrytelemetry::addChannel(const char *name, uint32_t intervalMs, TelemetryReader reader, float rawScale)
+{
+  if (channelCount >= NIKOLAINDUSTRY_TELEMETRY_CHANNELS || intervalMs == 0 || !reader)
+  {
+    return false;
+  }
+
+  int32_t *ring = nullptr;
+  if (rawScale > 0)
+  {
+    ring = (int32_t *)WEBSOCKETS_MALLOC(NIKOLAINDUSTRY_TELEMETRY_SAMPLES * sizeof(int32_t), WSmem_app);
+    if (!ring)
+    {
+      return false;
+    }
+    rawChannels++;
+  }
+
+  Channel &channel = channels[channelCount];
+  channel.name = name;
+  channel.interval = intervalMs;
+  // spread the first samples of the channels over their interval so they do not all fall into one loop()
+  channel.next = millis() + (intervalMs / NIKOLAINDUSTRY_TELEMETRY_CHANNELS) * channelCount;
+  channel.reader = reader;
+  channel.rawScale = rawScale;
+  channel.ring = ring;
+  channel.ringCount = 0;
+  channel.ringHead = 0;
+  channel.count = 0;
+  channelCount++;
+  return true;
+}
+
+// at most one sample per channel per call
+void nikolaindustrytelemetry::loop()
+{
+  if (!running)
+  {
+    return;
+  }
+
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < channelCount; i++)
+  {
+    Channel &channel = channels[i];
+    int32_t late = now - channel.next;
+    if (late < 0)
+    {
+      continue;
+    }
+    if ((uint32_t)late >= channel.interval)
+    {
+      // loop() was blocked, skip the samples that are due already instead of reading them in a burst
+      uint32_t skipped = late / channel.interval;
+      stats.missed += skipped;
+      channel.next += skipped * channel.interval;
+    }
+    channel.next += channel.interval;
+    sample(channel);
+  }
+
+  if (now - windowStart >= window)
+  {
+    publish();
+    windowStart += window * ((now - windowStart) / window);
+  }
+}
+
+void nikolaindustrytelemetry::sample(Channel &channel)
+{
+  float value = channel.reader();
+  stats.samples++;
+
+  if (channel.count == 0)
+  {
+    channel.min = value;
+    channel.max = value;
+    channel.sum = 0;
+  }
+  channel.min = min(channel.min, value);
+  channel.max = max(channel.max, value);
+  channel.last = value;
+  // count and sum stop together so the mean stays the mean of the counted samples
+  if (channel.count < 0xFFFF)
+  {
+    channel.sum += value;
+    channel.count++;
+  }
+
+  if (channel.ring)
+  {
+    uint16_t slot = (channel.ringHead + channel.ringCount) % NIKOLAINDUSTRY_TELEMETRY_SAMPLES;
+    channel.ring[slot] = (int32_t)lroundf(value / channel.rawScale);
+    if (channel.ringCount < NIKOLAINDUSTRY_TELEMETRY_SAMPLES)
+    {
+      channel.ringCount++;
+    }
+    else
+    {
+      channel.ringHead = (channel.ringHead + 1) % NIKOLAINDUSTRY_TELEMETRY_SAMPLES;
+    }
+  }
+}
+
+// one message with the aggregates of all channels that have samples, then the window starts over
+void nikolaindustrytelemetry::publish()
+{
+  nikolaindustryJsonDocument doc(JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(1) + JSON_OBJECT_SIZE(3) + JSON_OBJECT_SIZE(NIKOLAINDUSTRY_TELEMETRY_CHANNELS) +
+                          channelCount * JSON_OBJECT_SIZE(7) + rawChannels * JSON_ARRAY_SIZE(NIKOLAINDUSTRY_TELEMETRY_SAMPLES));
+  doc["targetId"] = targetId.c_str();
+  JsonObject telemetry = doc.createNestedObject("payload").createNestedObject("telemetry");
+  telemetry["t"] = windowStart;
+  telemetry["w"] = window;
+  JsonObject values = telemetry.createNestedObject("ch");
+
+  bool any = false;
+  for (uint8_t i = 0; i < channelCount; i++)
+  {
+    Channel &channel = channels[i];
+    if (!channel.count)
+    {
+      continue;
+    }
+    any = true;
+
+    JsonObject value = values.createNestedObject(channel.name.c_str());
+    value["n"] = channel.count;
+    value["min"] = channel.min;
+    value["max"] = channel.max;
+    value["mean"] = (float)(channel.sum / channel.count);
+    value["last"] = channel.last;
+
+    if (channel.ring && channel.ringCount)
+    {
+      value["scale"] = channel.rawScale;
+      JsonArray raw = value.createNestedArray("raw");
+      int32_t previous = 0;
+      for (uint16_t s = 0; s < channel.ringCount; s++)
+      {
+        int32_t v = channel.ring[(channel.ringHead + s) % NIKOLAINDUSTRY_TELEMETRY_SAMPLES];
+        raw.add(v - previous);
+        previous = v;
+      }
+    }
+
+    channel.count = 0;
+    channel.ringCount = 0;
+    channel.ringHead = 0;
+  }
+
+  if (any)
+  {
+    if (realtime.sendJson(doc.as<JsonObject>(), NIKOLAINDUSTRY_PRIORITY_BULK))
+    {
+      stats.batches++;
+    }
+    else
+    {
+      stats.dropped++;
+    }
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef NIKOLAINDUSTRY_TELEMETRY_H
+#define NIKOLAINDUSTRY_TELEMETRY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <functional>
+#include "nikolaindustry-realtime.h"
+
+#ifndef NIKOLAINDUSTRY_TELEMETRY_CHANNELS
+#define NIKOLAINDUSTRY_TELEMETRY_CHANNELS 8
+#endif
+
+// raw samples kept per channel and window, older ones are overwritten
+#ifndef NIKOLAINDUSTRY_TELEMETRY_SAMPLES
+#define NIKOLAINDUSTRY_TELEMETRY_SAMPLES 64
+#endif
+
+typedef std::function<float()> TelemetryReader;
+
+struct nikolaindustryTelemetryStats
+{
+  uint32_t samples;
+  uint32_t missed;  // samples skipped because loop() came too late
+  uint32_t batches; // messages queued
+  uint32_t dropped; // messages the send queue did not take
+};
+
+// fixed rate sampling with one message per window instead of one per reading.
+// every channel is read at its own interval, the schedule does not drift when loop() is late
+// (samples more than one interval late are skipped). per window each channel reports
+// {"n": count, "min", "max", "mean", "last"} and optionally the raw series,
+// quantized by rawScale and delta encoded: [first, second - first, ...].
+//
+//   {"telemetry": {"t": <window start, ms>, "w": <window ms>,
+//                  "ch": {"temp": {"n": 10, "min": 21.5, "max": 22, "mean": 21.7, "last": 22,
+//                                  "scale": 0.1, "raw": [215, 0, 1, ...]}}}}
+class nikolaindustrytelemetry {
+public:
+  nikolaindustrytelemetry(nikolaindustryrealtime &realtime);
+  ~nikolaindustrytelemetry();
+
+  bool begin(const String &targetId, uint32_t windowMs);
+  bool addChannel(const char *name, uint32_t intervalMs, TelemetryReader reader, float rawScale = 0);
+  void loop();
+  void getStats(nikolaindustryTelemetryStats *stats) const { *stats = this->stats; }
+
+private:
+  struct Channel
+  {
+    String name;
+    uint32_t interval;
+    uint32_t next; // due time of the next sample
+    TelemetryReader reader;
+    float rawScale;     // 0 = no raw series
+    int32_t *ring;      // NIKOLAINDUSTRY_TELEMETRY_SAMPLES quantized samples
+    uint16_t ringCount; // samples in the ring
+    uint16_t ringHead;  // oldest sample
+    uint16_t count;
+    float min;
+    float max;
+    double sum;
+    float last;
+  };
+
+  nikolaindustryrealtime &realtime;
+  String targetId;
+  uint32_t window = 0;
+  uint32_t windowStart = 0;
+  bool running = false;
+  Channel channels[NIKOLAINDUSTRY_TELEMETRY_CHANNELS];
+  uint8_t channelCount = 0;
+  uint8_t rawChannels = 0;
+  nikolaindustryTelemetryStats stats = {0, 0, 0, 0};
+
+  void sample(Channel &channel);
+  void publish();
+};
+
+#endif
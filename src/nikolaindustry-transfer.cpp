@@ -0,0 +1,509 @@
+#include "nikolaindustry-transfer.h"
+
+// crc32 (polynomial 0xEDB88320) a nibble at a time, 64 bytes of table instead of 1 kB
+static const uint32_t crcTable[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+
+static void put32(uint8_t *p, uint32_t value)
+{
+  p[0] = value;
+  p[1] = value >> 8;
+  p[2] = value >> 16;
+  p[3] = value >> 24;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+nikolaindustrytransfer::nikolaindustrytransfer(nikolaindustrylanes &_lanes) : lanes(_lanes) {}
+
+uint32_t nikolaindustrytransfer::crc32(uint32_t crc, const uint8_t *data, size_t length)
+{
+  crc = ~crc;
+  while (length--)
+  {
+    crc ^= *data++;
+    crc = (crc >> 4) ^ crcTable[crc & 15];
+    crc = (crc >> 4) ^ crcTable[crc & 15];
+  }
+  return ~crc;
+}
+
+// starts sending size bytes of source to targetId, onDone runs once with the result.
+// the source is read once here for the crc, so keep it short for large files on slow flash.
+// false if a transfer is already running or the source can not be read
+bool nikolaindustrytransfer::send(const String &targetId, const char *name, nikolaindustryTransferSource *source, uint32_t size, TransferCallback onDone)
+{
+  if (out.state != OUT_IDLE || !source || targetId.length() == 0 || targetId.length() > 255)
+  {
+    return false;
+  }
+
+  uint8_t *frame = (uint8_t *)WEBSOCKETS_MALLOC(1 + targetId.length() + NIKOLAINDUSTRY_TRANSFER_HEADER + NIKOLAINDUSTRY_TRANSFER_CHUNK, WSmem_app);
+  if (!frame)
+  {
+    return false;
+  }
+
+  uint32_t crc = 0;
+  for (uint32_t offset = 0; offset < size;)
+  {
+    size_t length = min((uint32_t)NIKOLAINDUSTRY_TRANSFER_CHUNK, size - offset);
+    if (source->read(offset, frame, length) != length)
+    {
+      WEBSOCKETS_FREE(frame);
+      return false;
+    }
+    crc = crc32(crc, frame, length);
+    offset += length;
+    yield();
+  }
+
+  out = Outgoing();
+  out.id = (uint32_t)random(1, 0x7FFFFFFF);
+  out.peer = targetId;
+  out.name = name;
+  out.source = source;
+  out.size = size;
+  out.crc = crc;
+  out.frame = frame;
+  out.onDone = onDone;
+  out.state = OUT_OFFERED;
+  out.lastAck = millis();
+  if (online)
+  {
+    sendOffer();
+  }
+  return true;
+}
+
+// payload.transfer of a received message
+void nikolaindustrytransfer::handleControl(const char *from, JsonObject &msg)
+{
+  uint32_t id = msg["id"] | (uint32_t)0;
+  if (!id)
+  {
+    return;
+  }
+
+  if (msg.containsKey("size"))
+  {
+    handleOffer(from, msg);
+  }
+  else if (out.state != OUT_IDLE && id == out.id && out.peer == from)
+  {
+    handleAck(msg);
+  }
+  else if (in.active && id == in.id && in.peer == from && msg.containsKey("error"))
+  {
+    Serial.printf("❌ Transfer aborted by sender: %s\n", (const char *)(msg["error"] | ""));
+    finishIncoming(false, nullptr);
+  }
+}
+
+void nikolaindustrytransfer::handleOffer(const char *from, JsonObject &msg)
+{
+  // uint32_t defaults, an int default turns values >= 2^31 (half of all crcs) into 0
+  uint32_t id = msg["id"] | (uint32_t)0;
+  uint32_t crc = msg["crc"] | (uint32_t)0;
+  if (!in.active && id == completed.id && crc == completed.crc && nikolaindustryratelimit::targetHash(from) == completed.peer)
+  {
+    // our done got lost, the sender offers the finished transfer again
+    sendControl(from, [id](JsonObject &t) {
+      t["id"] = id;
+      t["done"] = true;
+    });
+    return;
+  }
+
+  if (in.active && id == in.id && in.peer == from)
+  {
+    // the sender reconnected, continue where we are
+    in.last = millis();
+    in.resendAsked = false;
+    sendAck(true);
+    return;
+  }
+
+  String peer = from;
+  if (in.active)
+  {
+    if (in.peer != peer)
+    {
+      sendControl(peer, [id](JsonObject &t) {
+        t["id"] = id;
+        t["error"] = "busy";
+      });
+      return;
+    }
+    // the sender started over
+    finishIncoming(false, nullptr);
+  }
+
+  uint32_t size = msg["size"] | (uint32_t)0;
+  if (!sink || !sink->begin(msg["name"] | "", size))
+  {
+    sendControl(peer, [id](JsonObject &t) {
+      t["id"] = id;
+      t["error"] = "rejected";
+    });
+    return;
+  }
+
+  in = Incoming();
+  in.active = true;
+  in.id = id;
+  in.peer = peer;
+  in.size = size;
+  in.crc = crc;
+  in.last = millis();
+  sendAck(true);
+  if (size == 0)
+  {
+    finishIncoming(in.crc == 0, "crc");
+  }
+}
+
+void nikolaindustrytransfer::handleAck(JsonObject &msg)
+{
+  if (msg.containsKey("error"))
+  {
+    Serial.printf("❌ Transfer %s failed: %s\n", out.name.c_str(), (const char *)(msg["error"] | ""));
+    finishOutgoing(false);
+    return;
+  }
+  if (msg["done"] | false)
+  {
+    finishOutgoing(true);
+    return;
+  }
+
+  uint32_t ack = msg["ack"] | (uint32_t)0;
+  if (ack > out.size)
+  {
+    return;
+  }
+
+  uint32_t now = millis();
+  if (msg["resend"] | false)
+  {
+    out.state = OUT_SENDING;
+    out.acked = ack;
+    out.next = ack;
+    out.lastAck = now;
+    out.lastSent = now;
+  }
+  else if (out.state == OUT_SENDING && ack > out.acked)
+  {
+    out.acked = ack;
+    if (out.next < ack)
+    {
+      out.next = ack;
+    }
+    out.lastAck = now;
+  }
+}
+
+// a binary frame: [id length][from id][transfer id][offset][crc32][data]
+void nikolaindustrytransfer::handleChunk(const uint8_t *frame, size_t length)
+{
+  if (length < 1 || length < 1 + (size_t)frame[0] + NIKOLAINDUSTRY_TRANSFER_HEADER)
+  {
+    return;
+  }
+  uint8_t idLength = frame[0];
+  const uint8_t *header = frame + 1 + idLength;
+  const uint8_t *data = header + NIKOLAINDUSTRY_TRANSFER_HEADER;
+  size_t dataLength = length - 1 - idLength - NIKOLAINDUSTRY_TRANSFER_HEADER;
+  uint32_t id = get32(header);
+  uint32_t offset = get32(header + 4);
+
+  if (!in.active || id != in.id || in.peer.length() != idLength || memcmp(in.peer.c_str(), frame + 1, idLength) != 0)
+  {
+    return;
+  }
+  in.last = millis();
+
+  if (offset < in.offset)
+  {
+    // sent again after a go back, already written
+    return;
+  }
+  if (offset > in.offset || dataLength > NIKOLAINDUSTRY_TRANSFER_CHUNK || dataLength > in.size - in.offset || crc32(0, data, dataLength) != get32(header + 8))
+  {
+    // gap or damaged chunk, ask once for everything from our offset
+    if (!in.resendAsked)
+    {
+      in.resendAsked = true;
+      sendAck(true);
+    }
+    return;
+  }
+
+  if (!sink->write(data, dataLength))
+  {
+    finishIncoming(false, "sink");
+    return;
+  }
+  in.offset += dataLength;
+  in.running = crc32(in.running, data, dataLength);
+  in.resendAsked = false;
+
+  if (in.offset == in.size)
+  {
+    finishIncoming(in.running == in.crc, "crc");
+    return;
+  }
+  if (++in.unacked >= max(1, NIKOLAINDUSTRY_TRANSFER_WINDOW / 2))
+  {
+    sendAck(false);
+  }
+}
+
+// one chunk per call, at most NIKOLAINDUSTRY_TRANSFER_WINDOW chunks past the last ack
+void nikolaindustrytransfer::loop()
+{
+  if (!online)
+  {
+    return;
+  }
+
+  uint32_t now = millis();
+  if (in.active && now - in.last > NIKOLAINDUSTRY_TRANSFER_IDLE_TIMEOUT)
+  {
+    finishIncoming(false, "timeout");
+  }
+
+  if (out.state == OUT_IDLE)
+  {
+    return;
+  }
+  if (now - out.lastAck > NIKOLAINDUSTRY_TRANSFER_IDLE_TIMEOUT)
+  {
+    uint32_t id = out.id;
+    sendControl(out.peer, [id](JsonObject &t) {
+      t["id"] = id;
+      t["error"] = "timeout";
+    });
+    finishOutgoing(false);
+    return;
+  }
+  if (out.state == OUT_OFFERED)
+  {
+    if (now - out.lastSent >= NIKOLAINDUSTRY_TRANSFER_ACK_TIMEOUT)
+    {
+      sendOffer();
+    }
+    return;
+  }
+
+  if (out.next > out.acked && now - out.lastAck >= NIKOLAINDUSTRY_TRANSFER_ACK_TIMEOUT && now - out.lastSent >= NIKOLAINDUSTRY_TRANSFER_ACK_TIMEOUT)
+  {
+    // acks stopped coming, offer again: the receiver answers with its offset,
+    // or with done if it finished and only the done got lost
+    out.state = OUT_OFFERED;
+    out.next = out.acked;
+    sendOffer();
+    return;
+  }
+  if (out.next < out.size && out.next - out.acked < (uint32_t)NIKOLAINDUSTRY_TRANSFER_WINDOW * NIKOLAINDUSTRY_TRANSFER_CHUNK)
+  {
+    sendChunk();
+  }
+}
+
+// an outgoing transfer is offered again, the receiver answers with its offset
+void nikolaindustrytransfer::connected()
+{
+  online = true;
+  uint32_t now = millis();
+  if (in.active)
+  {
+    in.last = now;
+  }
+  if (out.state != OUT_IDLE)
+  {
+    out.state = OUT_OFFERED;
+    out.lastAck = now;
+    sendOffer();
+  }
+}
+
+// both sides keep their state to resume after the reconnect
+void nikolaindustrytransfer::disconnected()
+{
+  online = false;
+  if (out.state == OUT_SENDING)
+  {
+    out.state = OUT_OFFERED;
+    out.next = out.acked;
+  }
+}
+
+void nikolaindustrytransfer::sendOffer()
+{
+  sendControl(out.peer, [this](JsonObject &t) {
+    t["id"] = out.id;
+    t["name"] = out.name;
+    t["size"] = out.size;
+    t["crc"] = out.crc;
+  });
+  out.lastSent = millis();
+}
+
+void nikolaindustrytransfer::sendChunk()
+{
+  uint8_t idLength = out.peer.length();
+  uint8_t *header = out.frame + 1 + idLength;
+  size_t length = min((uint32_t)NIKOLAINDUSTRY_TRANSFER_CHUNK, out.size - out.next);
+
+  // the frame stays valid while the lane is busy, read the source only once per offset
+  if (!out.framed || out.framedOffset != out.next)
+  {
+    if (out.source->read(out.next, header + NIKOLAINDUSTRY_TRANSFER_HEADER, length) != length)
+    {
+      uint32_t id = out.id;
+      sendControl(out.peer, [id](JsonObject &t) {
+        t["id"] = id;
+        t["error"] = "source";
+      });
+      finishOutgoing(false);
+      return;
+    }
+    out.frame[0] = idLength;
+    memcpy(out.frame + 1, out.peer.c_str(), idLength);
+    put32(header, out.id);
+    put32(header + 4, out.next);
+    put32(header + 8, crc32(0, header + NIKOLAINDUSTRY_TRANSFER_HEADER, length));
+    out.framed = true;
+    out.framedOffset = out.next;
+  }
+
+  if (lanes.sendBinary(out.frame, 1 + idLength + NIKOLAINDUSTRY_TRANSFER_HEADER + length, nikolaindustryratelimit::targetHash(out.peer.c_str())))
+  {
+    out.next += length;
+  }
+}
+
+void nikolaindustrytransfer::sendAck(bool resend)
+{
+  sendControl(in.peer, [this, resend](JsonObject &t) {
+    t["id"] = in.id;
+    t["ack"] = in.offset;
+    if (resend)
+    {
+      t["resend"] = true;
+    }
+  });
+  in.unacked = 0;
+}
+
+void nikolaindustrytransfer::sendControl(const String &peer, std::function<void(JsonObject &)> builder)
+{
+  nikolaindustryJsonDocument doc(256);
+  doc["targetId"] = peer;
+  JsonObject transfer = doc.createNestedObject("payload").createNestedObject(NIKOLAINDUSTRY_TRANSFER_KEY);
+  builder(transfer);
+
+  String output;
+  serializeJson(doc, output);
+  // a lost control message is recovered by the ack and offer timeouts
+  lanes.send(std::move(output), NIKOLAINDUSTRY_PRIORITY_CONTROL, nikolaindustryratelimit::targetHash(peer.c_str()));
+}
+
+// error is sent to the sender when not ok, nullptr when the sender ended the transfer
+void nikolaindustrytransfer::finishIncoming(bool ok, const char *error)
+{
+  bool done = sink->end(ok);
+  if (ok && !done)
+  {
+    error = "sink";
+  }
+
+  uint32_t id = in.id;
+  if (ok && done)
+  {
+    completed.id = id;
+    completed.crc = in.crc;
+    completed.peer = nikolaindustryratelimit::targetHash(in.peer.c_str());
+    sendControl(in.peer, [id](JsonObject &t) {
+      t["id"] = id;
+      t["done"] = true;
+    });
+  }
+  else if (error)
+  {
+    sendControl(in.peer, [id, error](JsonObject &t) {
+      t["id"] = id;
+      t["error"] = error;
+    });
+  }
+  in = Incoming();
+}
+
+void nikolaindustrytransfer::finishOutgoing(bool ok)
+{
+  TransferCallback onDone = out.onDone;
+  WEBSOCKETS_FREE(out.frame);
+  out = Outgoing();
+  if (onDone)
+  {
+    onDone(ok);
+  }
+}
+
+#ifdef ESP32
+bool nikolaindustryUpdateSink::begin(const char *name, uint32_t size)
+{
+  return Update.begin(size);
+}
+
+bool nikolaindustryUpdateSink::write(const uint8_t *data, size_t length)
+{
+  return Update.write((uint8_t *)data, length) == length;
+}
+
+bool nikolaindustryUpdateSink::end(bool ok)
+{
+  if (!ok)
+  {
+    Update.abort();
+    return false;
+  }
+  return Update.end();
+}
+
+bool nikolaindustryFileSink::begin(const char *name, uint32_t size)
+{
+  file = fs.open(path, FILE_WRITE);
+  return (bool)file;
+}
+
+bool nikolaindustryFileSink::write(const uint8_t *data, size_t length)
+{
+  return file.write(data, length) == length;
+}
+
+// an incomplete file is removed
+bool nikolaindustryFileSink::end(bool ok)
+{
+  file.close();
+  if (!ok)
+  {
+    fs.remove(path);
+  }
+  return ok;
+}
+
+size_t nikolaindustryFileSource::read(uint32_t offset, uint8_t *data, size_t length)
+{
+  if (!file.seek(offset))
+  {
+    return 0;
+  }
+  return file.read(data, length);
+}
+#endif
@@ -0,0 +1,193 @@
+#ifndef NIKOLAINDUSTRY_TRANSFER_H
+#define NIKOLAINDUSTRY_TRANSFER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <functional>
+#include "nikolaindustry-json.h"
+#include "nikolaindustry-lanes.h"
+
+#ifdef ESP32
+#include <FS.h>
+#include <Update.h>
+#endif
+
+// data bytes per binary frame
+#ifndef NIKOLAINDUSTRY_TRANSFER_CHUNK
+#define NIKOLAINDUSTRY_TRANSFER_CHUNK 1024
+#endif
+
+// chunks the sender may have unacknowledged, the receiver acks every half window
+#ifndef NIKOLAINDUSTRY_TRANSFER_WINDOW
+#define NIKOLAINDUSTRY_TRANSFER_WINDOW 4
+#endif
+
+// no ack for this long: the sender goes back to the last acked offset
+#ifndef NIKOLAINDUSTRY_TRANSFER_ACK_TIMEOUT
+#define NIKOLAINDUSTRY_TRANSFER_ACK_TIMEOUT 3000
+#endif
+
+// no progress for this long: the transfer is given up, long enough to resume after a reconnect
+#ifndef NIKOLAINDUSTRY_TRANSFER_IDLE_TIMEOUT
+#define NIKOLAINDUSTRY_TRANSFER_IDLE_TIMEOUT 120000
+#endif
+
+// control messages are sent as "payload": {"transfer": {...}}
+#define NIKOLAINDUSTRY_TRANSFER_KEY "transfer"
+
+// transfer id, offset and crc32 of the chunk, little endian
+#define NIKOLAINDUSTRY_TRANSFER_HEADER 12
+
+// where received data goes, e.g. Update on the device or a file
+class nikolaindustryTransferSink {
+public:
+  virtual ~nikolaindustryTransferSink() {}
+  // a new transfer, false rejects it
+  virtual bool begin(const char *name, uint32_t size) = 0;
+  // data in order, false aborts the transfer
+  virtual bool write(const uint8_t *data, size_t length) = 0;
+  // ok: all data received and the crc matched, otherwise the transfer was aborted.
+  // false if the data could not be finished (e.g. an invalid image)
+  virtual bool end(bool ok) = 0;
+};
+
+// where sent data comes from, read() may be called for the same offset again after a drop
+class nikolaindustryTransferSource {
+public:
+  virtual ~nikolaindustryTransferSource() {}
+  virtual size_t read(uint32_t offset, uint8_t *data, size_t length) = 0;
+};
+
+#ifdef ESP32
+// writes a firmware image to the OTA partition, restart after end() returned true
+class nikolaindustryUpdateSink : public nikolaindustryTransferSink {
+public:
+  bool begin(const char *name, uint32_t size) override;
+  bool write(const uint8_t *data, size_t length) override;
+  bool end(bool ok) override;
+};
+
+class nikolaindustryFileSink : public nikolaindustryTransferSink {
+public:
+  nikolaindustryFileSink(fs::FS &fs, const char *path) : fs(fs), path(path) {}
+  bool begin(const char *name, uint32_t size) override;
+  bool write(const uint8_t *data, size_t length) override;
+  bool end(bool ok) override;
+
+private:
+  fs::FS &fs;
+  String path;
+  fs::File file;
+};
+
+class nikolaindustryFileSource : public nikolaindustryTransferSource {
+public:
+  nikolaindustryFileSource(fs::File &file) : file(file) {}
+  size_t read(uint32_t offset, uint8_t *data, size_t length) override;
+
+private:
+  fs::File &file;
+};
+#endif
+
+typedef std::function<void(bool ok)> TransferCallback;
+
+// chunked transfer over the relay, one incoming and one outgoing transfer at a time.
+//
+// control messages (JSON, control lane):
+//   offer  sender -> receiver  {"id": 7, "name": "fw.bin", "size": 123456, "crc": 3735928559}
+//   ack    receiver -> sender  {"id": 7, "ack": 4096} all bytes before ack are written,
+//                              "resend": true makes the sender continue from ack (start, resume, bad chunk)
+//   done   receiver -> sender  {"id": 7, "done": true}, sent again if the last finished transfer is offered again
+//   error  either direction    {"id": 7, "error": "crc"} ends the transfer
+// chunks (binary frames, bulk lane):
+//   [id length][target id, from id when received][transfer id][offset][crc32 of data][data]
+//   the relay replaces the target id with the sender id.
+// after a reconnect or when acks stop the sender offers the same transfer again and the receiver
+// answers with its offset.
+class nikolaindustrytransfer {
+public:
+  nikolaindustrytransfer(nikolaindustrylanes &lanes);
+
+  void setSink(nikolaindustryTransferSink *sink) { this->sink = sink; }
+  bool send(const String &targetId, const char *name, nikolaindustryTransferSource *source, uint32_t size, TransferCallback onDone);
+
+  void handleControl(const char *from, JsonObject &msg);
+  void handleChunk(const uint8_t *frame, size_t length);
+  void loop();
+  void connected();
+  void disconnected();
+
+  bool receiving() const { return in.active; }
+  bool sending() const { return out.state != OUT_IDLE; }
+
+  // zlib compatible, crc32(0, data, length)
+  static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t length);
+
+private:
+  enum OutState
+  {
+    OUT_IDLE,
+    OUT_OFFERED, // waiting for the first ack
+    OUT_SENDING
+  };
+
+  struct Incoming
+  {
+    bool active = false;
+    uint32_t id = 0;
+    String peer;
+    uint32_t size = 0;
+    uint32_t crc = 0;    // expected crc of all data
+    uint32_t offset = 0; // bytes written
+    uint32_t running = 0;
+    uint8_t unacked = 0; // chunks since the last ack
+    bool resendAsked = false;
+    uint32_t last = 0;
+  };
+
+  struct Outgoing
+  {
+    OutState state = OUT_IDLE;
+    uint32_t id = 0;
+    String peer;
+    String name;
+    nikolaindustryTransferSource *source = nullptr;
+    uint32_t size = 0;
+    uint32_t crc = 0;
+    uint32_t acked = 0;
+    uint32_t next = 0;
+    uint32_t lastAck = 0;  // last progress
+    uint32_t lastSent = 0; // last offer or go back
+    uint8_t *frame = nullptr; // chunk being sent
+    bool framed = false;
+    uint32_t framedOffset = 0;
+    TransferCallback onDone;
+  };
+
+  // the last transfer received completely, a repeated offer of it is answered with done
+  struct Completed
+  {
+    uint32_t id = 0;
+    uint32_t crc = 0;
+    uint32_t peer = 0; // nikolaindustryratelimit::targetHash of the sender
+  };
+
+  nikolaindustrylanes &lanes;
+  nikolaindustryTransferSink *sink = nullptr;
+  bool online = false;
+  Incoming in;
+  Outgoing out;
+  Completed completed;
+
+  void handleOffer(const char *from, JsonObject &msg);
+  void handleAck(JsonObject &msg);
+  void sendOffer();
+  void sendChunk();
+  void sendAck(bool resend);
+  void sendControl(const String &peer, std::function<void(JsonObject &)> builder);
+  void finishIncoming(bool ok, const char *error);
+  void finishOutgoing(bool ok);
+};
+
+#endif